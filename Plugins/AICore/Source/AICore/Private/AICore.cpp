@@ -2,6 +2,8 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 #include "AICoreLog.h"
+#include "AICoreScheduler.h"
+#include "AICoreSearchLog.h"
 
 DEFINE_LOG_CATEGORY(LogAICore);
 
@@ -14,6 +16,8 @@ public:
     }
     virtual void ShutdownModule() override
     {
+        AICore::FSearchScheduler::Shutdown();
+        AICore::ShutdownSearchLog();
         UE_LOG(LogAICore, Log, TEXT("AICore module shutdown."));
     }
 };
@@ -0,0 +1,64 @@
+#include "AICoreArena.h"
+#include "AICoreSearch.h"
+#include "Misc/ScopeLock.h"
+
+#include <atomic>
+
+namespace AICore
+{
+    static std::atomic<int64> GSearchArenaMisses{ 0 };
+
+    void NoteSearchArenaMiss()
+    {
+        GSearchArenaMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int64 GetSearchArenaMisses()
+    {
+        return GSearchArenaMisses.load(std::memory_order_relaxed);
+    }
+
+    // what copying a root into a clone may have to grow
+    static size_t StateCapacity(const GameState& S)
+    {
+        return S.units.capacity() + S.stack.capacity() + S.symStack.capacity()
+            + S.Z.sideToAct.capacity() + S.Z.unitPos.capacity() + S.Z.teamAP.capacity()
+            + S.Z.unitHP.capacity() + S.Z.unitAlive.capacity() + S.Z.unitCD.capacity();
+    }
+
+    FStatePool& FStatePool::Get()
+    {
+        static FStatePool Pool;
+        return Pool;
+    }
+
+    FStatePool::FHandle::~FHandle()
+    {
+        if (State) FStatePool::Get().Release(MoveTemp(State));
+    }
+
+    FStatePool::FHandle FStatePool::Acquire(const GameState& Root)
+    {
+        TUniquePtr<GameState> Clone;
+        {
+            FScopeLock L(&Lock);
+            if (!Free.empty())
+            {
+                Clone = MoveTemp(Free.back());
+                Free.pop_back();
+            }
+        }
+        if (!Clone) Clone = MakeUnique<GameState>();
+
+        const size_t before = StateCapacity(*Clone);
+        *Clone = Root;
+        if (StateCapacity(*Clone) != before) NoteSearchArenaMiss();
+        return FHandle(MoveTemp(Clone));
+    }
+
+    void FStatePool::Release(TUniquePtr<GameState>&& State)
+    {
+        FScopeLock L(&Lock);
+        Free.push_back(MoveTemp(State));
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "state.h"
+#include <memory>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Search-scoped memory
+//
+// TScratch<T>: a std::vector<T> leased from the calling thread's arena, a stack of buffers
+// handed out and returned in LIFO order (scoped leases, one set per recursion level). Buffers
+// keep their capacity, so once a thread has searched a position of some size, later searches
+// take nothing from the heap for scratch vectors.
+// FStatePool: GameState clones that keep their buffers; Acquire copies a root into a free
+// clone in place (reset-to-snapshot) instead of constructing a new state.
+// Both count the leases they could not serve from kept capacity (a new buffer or clone, or one
+// that had to grow) in GetSearchArenaMisses().
+//////////////////////////////////////////////////////////////////////////
+
+namespace AICore
+{
+    void NoteSearchArenaMiss();
+
+    template<typename T>
+    class TScratch
+    {
+    public:
+        TScratch() : Stack(GetStack()), V(Stack.Push()), Capacity(V.capacity()) { V.clear(); }
+        ~TScratch()
+        {
+            if (V.capacity() != Capacity) NoteSearchArenaMiss();
+            Stack.Pop();
+        }
+        TScratch(const TScratch&) = delete;
+        TScratch& operator=(const TScratch&) = delete;
+
+        std::vector<T>& operator*() { return V; }
+        std::vector<T>* operator->() { return &V; }
+
+    private:
+        struct FStack
+        {
+            std::vector<std::unique_ptr<std::vector<T>>> Buffers;
+            size_t Top = 0;
+
+            std::vector<T>& Push()
+            {
+                if (Top == Buffers.size())
+                {
+                    Buffers.push_back(std::make_unique<std::vector<T>>());
+                    NoteSearchArenaMiss();
+                }
+                return *Buffers[Top++];
+            }
+            void Pop() { --Top; }
+        };
+
+        static FStack& GetStack() { thread_local FStack S; return S; }
+
+        FStack& Stack;
+        std::vector<T>& V;
+        size_t Capacity;
+    };
+
+    class FStatePool
+    {
+    public:
+        static FStatePool& Get();   // process-wide, any thread
+
+        // A pooled clone; goes back to the pool (buffers kept) when the handle is destroyed
+        class FHandle
+        {
+        public:
+            FHandle(FHandle&& Other) : State(MoveTemp(Other.State)) {}
+            ~FHandle();
+            FHandle(const FHandle&) = delete;
+            FHandle& operator=(const FHandle&) = delete;
+
+            GameState& operator*() const { return *State; }
+            GameState* operator->() const { return State.Get(); }
+
+        private:
+            friend class FStatePool;
+            explicit FHandle(TUniquePtr<GameState>&& InState) : State(MoveTemp(InState)) {}
+            TUniquePtr<GameState> State;
+        };
+
+        // a clone reset to Root
+        FHandle Acquire(const GameState& Root);
+
+    private:
+        void Release(TUniquePtr<GameState>&& State);
+
+        FCriticalSection Lock;
+        std::vector<TUniquePtr<GameState>> Free;
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "state.h"
+#include <atomic>
+#include <vector>
+
+// Static-eval hash shared by every search thread.
+// Lockless: each slot stores (key ^ data, data) with relaxed atomics; a torn write fails the
+// key check and reads as a miss. Callers fold the eval weights/backend into the key.
+struct FEvalCache
+{
+    static constexpr int32 kLog2Slots = 16;     // 64K slots, 1 MB
+    static constexpr uint64 kMask = (1ULL << kLog2Slots) - 1;
+
+    FORCEINLINE bool Probe(uint64 Key, int32& OutScore) const
+    {
+        const Slot& E = Slots[Key & kMask];
+        const uint64 data = E.Data.load(std::memory_order_relaxed);
+        if ((E.Check.load(std::memory_order_relaxed) ^ data) != Key) return false;
+        OutScore = (int32)(uint32)data;
+        return true;
+    }
+
+    FORCEINLINE void Store(uint64 Key, int32 Score)
+    {
+        Slot& E = Slots[Key & kMask];
+        const uint64 data = (uint64)(uint32)Score;
+        E.Check.store(Key ^ data, std::memory_order_relaxed);
+        E.Data.store(data, std::memory_order_relaxed);
+    }
+
+    void Clear()
+    {
+        for (Slot& E : Slots) { E.Check.store(0, std::memory_order_relaxed); E.Data.store(~0ULL, std::memory_order_relaxed); }
+    }
+
+    FEvalCache() { Clear(); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64> Check{ 0 };
+        std::atomic<uint64> Data{ ~0ULL };      // empty: only Key == ~0 would match
+    };
+    Slot Slots[1ULL << kLog2Slots];
+};
+
+// Per-position attack coverage and nearest-unit distances, built once per position and shared by
+// the eval, quiescence filters and move ordering (AICore::ThreatMapFor).
+//  Cover[t][tile]   = alive team-t units whose attack range (Manhattan) covers tile
+//  NearDist[t][tile] = Manhattan distance from tile to the nearest alive team-t unit (kFar: none)
+struct FThreatMap
+{
+    static constexpr int32 kFar = 1 << 20;
+
+    uint64 Key = 0;
+    int32  Width = 0;
+    int32  Height = 0;
+    int32  NumUnits = -1;
+    bool   bTwoTeams = true;    // false: a unit is outside teams 0/1, callers use the direct scans
+    std::vector<uint8> Cover[2];
+    std::vector<int32> NearDist[2];
+
+    FORCEINLINE bool Matches(const GameState& S) const
+    {
+        return Key == S.key && Width == S.width && Height == S.height && NumUnits == (int32)S.units.size();
+    }
+
+    void Build(const GameState& S)
+    {
+        Key = S.key; Width = S.width; Height = S.height; NumUnits = (int32)S.units.size();
+        bTwoTeams = true;
+        const int32 N = Width * Height;
+        for (int32 t = 0; t < 2; ++t)
+        {
+            Cover[t].assign(N, 0);
+            NearDist[t].assign(N, kFar);
+        }
+
+        for (const Unit& u : S.units)
+        {
+            if (!u.alive || u.tile < 0 || u.tile >= N) continue;
+            if (u.team < 0 || u.team > 1) { bTwoTeams = false; continue; }
+            NearDist[u.team][u.tile] = 0;
+
+            const int32 ux = u.tile % Width, uy = u.tile / Width, r = u.attackRange;
+            for (int32 y = FMath::Max(0, uy - r); y <= FMath::Min(Height - 1, uy + r); ++y)
+            {
+                const int32 rx = r - FMath::Abs(y - uy);
+                for (int32 x = FMath::Max(0, ux - rx); x <= FMath::Min(Width - 1, ux + rx); ++x)
+                {
+                    uint8& c = Cover[u.team][y * Width + x];
+                    if (c < 255) ++c;
+                }
+            }
+        }
+
+        // two-pass L1 distance transform
+        for (int32 t = 0; t < 2; ++t)
+        {
+            int32* D = NearDist[t].data();
+            for (int32 y = 0; y < Height; ++y)
+                for (int32 x = 0; x < Width; ++x)
+                {
+                    int32& d = D[y * Width + x];
+                    if (x > 0) d = FMath::Min(d, D[y * Width + x - 1] + 1);
+                    if (y > 0) d = FMath::Min(d, D[(y - 1) * Width + x] + 1);
+                }
+            for (int32 y = Height - 1; y >= 0; --y)
+                for (int32 x = Width - 1; x >= 0; --x)
+                {
+                    int32& d = D[y * Width + x];
+                    if (x < Width - 1)  d = FMath::Min(d, D[y * Width + x + 1] + 1);
+                    if (y < Height - 1) d = FMath::Min(d, D[(y + 1) * Width + x] + 1);
+                }
+        }
+    }
+};
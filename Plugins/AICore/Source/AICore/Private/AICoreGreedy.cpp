@@ -9,16 +9,11 @@
 #include <vector>
 #include <limits>
 
-static int Manhattan(int a, int b, int W) {
-    int ax = a % W, ay = a / W, bx = b % W, by = b / W;
-    return FMath::Abs(ax - bx) + FMath::Abs(ay - by);
-}
-
 static int NearestEnemyDistFrom(const GameState& S, int tile, int myTeam) {
     int best = INT_MAX;
     for (const auto& e : S.units) {
         if (!e.alive || e.team == myTeam || e.tile < 0) continue;
-        best = FMath::Min(best, Manhattan(tile, e.tile, S.width));
+        best = FMath::Min(best, S.manhattan(tile, e.tile));
     }
     return (best == INT_MAX) ? 0 : best;
 }
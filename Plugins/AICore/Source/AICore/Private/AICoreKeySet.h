@@ -0,0 +1,97 @@
+#pragma once
+#include "CoreMinimal.h"
+#include <vector>
+
+// Small fixed-capacity open-addressing set for per-node child-key dedup.
+// Lives on the stack of a search frame; only the slots in use are cleared.
+struct FChildKeySet
+{
+    static constexpr int32 kMaxSlots = 512;
+
+    // sizes the table for ~Expected keys (load factor <= 1/2)
+    void Reset(int32 Expected)
+    {
+        int32 cap = 16;
+        while (cap < Expected * 2 && cap < kMaxSlots) cap <<= 1;
+        Mask = cap - 1;
+        Count = 0;
+        FMemory::Memzero(Slots, sizeof(uint64) * cap);
+    }
+
+    // grows the table (keeping its keys) when ~Expected keys would not fit; staged move generation
+    // learns the child count one stage at a time
+    void Reserve(int32 Expected)
+    {
+        if (Expected * 2 <= Mask + 1 || Mask + 1 >= kMaxSlots) return;
+        uint64 Old[kMaxSlots];
+        const int32 OldCap = Mask + 1;
+        FMemory::Memcpy(Old, Slots, sizeof(uint64) * OldCap);
+        Reset(Expected);
+        for (int32 i = 0; i < OldCap; ++i) if (Old[i] != 0) Insert(Old[i]);
+    }
+
+    // true if Key was not present (and is now). A full table never reports duplicates.
+    FORCEINLINE bool Insert(uint64 Key)
+    {
+        if (Key == 0) Key = 0x9E3779B97F4A7C15ULL;      // 0 marks an empty slot
+        if (Count * 4 >= (Mask + 1) * 3) return true;
+
+        int32 i = (int32)((Key ^ (Key >> 32)) & (uint64)Mask);
+        while (Slots[i] != 0) {
+            if (Slots[i] == Key) return false;
+            i = (i + 1) & Mask;
+        }
+        Slots[i] = Key;
+        ++Count;
+        return true;
+    }
+
+private:
+    uint64 Slots[kMaxSlots];
+    int32  Mask = 0;
+    int32  Count = 0;
+};
+
+// Growable open-addressing key set over caller-owned slots (a TScratch<uint64> lease), for
+// dedup sets too large for FChildKeySet. Clear() keeps the table size it grew to.
+struct FKeySetView
+{
+    explicit FKeySetView(std::vector<uint64>& InSlots) : Slots(InSlots) {}
+
+    void Clear(int32 Expected)
+    {
+        size_t cap = 16;
+        while (cap < (size_t)Expected * 2 || cap * 2 <= Slots.capacity()) cap <<= 1;    // a grown table stays grown
+        Slots.assign(cap, 0);
+        Count = 0;
+    }
+
+    // true if Key was not present (and is now)
+    bool Insert(uint64 Key)
+    {
+        if (Key == 0) Key = 0x9E3779B97F4A7C15ULL;      // 0 marks an empty slot
+        if ((Count + 1) * 2 > (int32)Slots.size()) Grow();
+
+        const uint64 mask = (uint64)Slots.size() - 1;
+        uint64 i = (Key ^ (Key >> 32)) & mask;
+        while (Slots[i] != 0) {
+            if (Slots[i] == Key) return false;
+            i = (i + 1) & mask;
+        }
+        Slots[i] = Key;
+        ++Count;
+        return true;
+    }
+
+private:
+    void Grow()
+    {
+        std::vector<uint64> old(Slots);
+        Slots.assign(old.size() * 2, 0);
+        Count = 0;
+        for (uint64 k : old) if (k != 0) Insert(k);
+    }
+
+    std::vector<uint64>& Slots;
+    int32 Count = 0;
+};
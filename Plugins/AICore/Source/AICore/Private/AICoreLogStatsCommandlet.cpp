@@ -0,0 +1,258 @@
+#include "AICoreLogStatsCommandlet.h"
+#include "AICoreLog.h"
+#include "AICoreSearch.h"
+#include "AICoreSearchLog.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    using AICore::FSearchLogRecord;
+
+    // Log-spaced histogram: percentiles within about 1%, size bounded by the value range
+    struct FLogHistogram
+    {
+        static constexpr double kMin = 1e-3;        // values at or below share bucket 0
+        static constexpr double kGrowth = 1.02;     // bucket b >= 1: [kMin * g^(b-1), kMin * g^b)
+
+        TArray<int64> Counts;
+        int64  Num = 0;
+        double Sum = 0.0;
+        double Max = 0.0;
+
+        void Add(double V)
+        {
+            const int32 B = (V <= kMin) ? 0 : 1 + (int32)(FMath::Loge(V / kMin) / FMath::Loge(kGrowth));
+            if (B >= Counts.Num()) Counts.SetNumZeroed(B + 1);
+            ++Counts[B];
+            ++Num;
+            Sum += V;
+            Max = FMath::Max(Max, V);
+        }
+
+        double Percentile(double P) const
+        {
+            if (Num == 0) return 0.0;
+            const int64 Rank = FMath::Max<int64>(1, (int64)FMath::CeilToDouble(P * (double)Num));
+            int64 Seen = 0;
+            for (int32 B = 0; B < Counts.Num(); ++B)
+            {
+                Seen += Counts[B];
+                if (Seen >= Rank) return (B == 0) ? kMin : FMath::Min(Max, kMin * FMath::Pow(kGrowth, B - 0.5));
+            }
+            return Max;
+        }
+
+        double Mean() const { return (Num > 0) ? Sum / (double)Num : 0.0; }
+    };
+
+    struct FGroupStats
+    {
+        int64  Searches = 0;
+        int64  WithBudget = 0;      // searches with a wall-clock budget
+        int64  OverHard = 0;
+        int64  Nodes = 0;
+        double Ms = 0.0;
+        FLogHistogram Latency;      // search time
+        FLogHistogram Queue;        // scheduler wait
+        FLogHistogram Total;        // wait + search
+        FLogHistogram NPS;
+        FLogHistogram DepthMs[FSearchLogRecord::kMaxDepths];
+        TArray<int64> DepthReached; // searches by completed depth
+
+        void Add(const FSearchLogRecord& R, bool bOverHard)
+        {
+            ++Searches;
+            WithBudget += (R.HardMs > 0) ? 1 : 0;
+            OverHard += bOverHard ? 1 : 0;
+            Nodes += R.Nodes;
+            Ms += R.Ms;
+            Latency.Add(R.Ms);
+            Queue.Add(R.QueueMs);
+            Total.Add(R.Ms + R.QueueMs);
+            if (R.Ms > 0.0) NPS.Add((double)R.Nodes / (R.Ms / 1000.0));
+
+            const int32 Reached = FMath::Min((int32)R.DepthReached, FSearchLogRecord::kMaxDepths);
+            for (int32 d = 0; d < Reached; ++d) DepthMs[d].Add(R.DepthMs[d]);
+            if (R.DepthReached >= DepthReached.Num()) DepthReached.SetNumZeroed(R.DepthReached + 1);
+            ++DepthReached[R.DepthReached];
+        }
+
+        int32 DepthPercentile(double P) const
+        {
+            const int64 Rank = FMath::Max<int64>(1, (int64)FMath::CeilToDouble(P * (double)Searches));
+            int64 Seen = 0;
+            for (int32 d = 0; d < DepthReached.Num(); ++d)
+            {
+                Seen += DepthReached[d];
+                if (Seen >= Rank) return d;
+            }
+            return 0;
+        }
+    };
+
+    // Every search lands in one group of each kind; keys sort by kind, then value
+    enum class EGroupBy : uint32 { All, Engine, Difficulty, Units, Board };
+
+    constexpr uint32 kEngineBasic = 3;      // BasicRules search log (no UTBG engine)
+
+    uint64 GroupKey(EGroupBy By, uint32 Value) { return ((uint64)By << 32) | Value; }
+
+    const TCHAR* GroupKind(uint64 Key)
+    {
+        static const TCHAR* Names[] = { TEXT("all"), TEXT("engine"), TEXT("difficulty"), TEXT("units"), TEXT("board") };
+        return Names[Key >> 32];
+    }
+
+    FString GroupValue(uint64 Key)
+    {
+        static const TCHAR* Engines[] = { TEXT("alphabeta"), TEXT("mcts"), TEXT("turn"), TEXT("basic") };
+        static const TCHAR* Difficulties[] = { TEXT("custom"), TEXT("easy"), TEXT("normal"), TEXT("hard") };
+        const uint32 V = (uint32)Key;
+        switch ((EGroupBy)(Key >> 32)) {
+        case EGroupBy::Engine:     return V < UE_ARRAY_COUNT(Engines) ? Engines[V] : TEXT("unknown");
+        case EGroupBy::Difficulty: return V < UE_ARRAY_COUNT(Difficulties) ? Difficulties[V] : TEXT("unknown");
+        case EGroupBy::Units:      return FString::Printf(TEXT("%u"), V);
+        case EGroupBy::Board:      return FString::Printf(TEXT("%ux%u"), V >> 8, V & 0xFF);
+        default:                   return FString();
+        }
+    }
+
+    void WriteLine(FArchive& Ar, const FString& Line)
+    {
+        FTCHARToUTF8 Utf8(*(Line + TEXT("\n")));
+        Ar.Serialize((void*)Utf8.Get(), Utf8.Length());
+    }
+
+    // Search log extension of a file name ("jsonl" / "aclog"), rotation suffix (name.1 ..) ignored
+    FString SearchLogExtension(const FString& Name)
+    {
+        const FString Suffix = FPaths::GetExtension(Name);
+        const FString Base = (!Suffix.IsEmpty() && Suffix.IsNumeric()) ? FPaths::GetBaseFilename(Name) : Name;
+        return FPaths::GetExtension(Base).ToLower();
+    }
+}
+
+UAICoreLogStatsCommandlet::UAICoreLogStatsCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UAICoreLogStatsCommandlet::Main(const FString& Params)
+{
+    FString Input = TEXT("AICore"), Output = TEXT("AICore/logstats");
+    FParse::Value(*Params, TEXT("Input="), Input);
+    FParse::Value(*Params, TEXT("Output="), Output);
+    Input = AICore::SearchLogPath(Input);
+    Output = AICore::SearchLogPath(Output);
+
+    // a directory: every search log in it, rotated ones (name.1 ..) included
+    TArray<FString> Files;
+    if (IFileManager::Get().DirectoryExists(*Input))
+    {
+        TArray<FString> Names;
+        IFileManager::Get().FindFiles(Names, *FPaths::Combine(Input, TEXT("*")), /*Files*/true, /*Directories*/false);
+        Names.Sort();
+        for (const FString& Name : Names)
+        {
+            const FString Ext = SearchLogExtension(Name);
+            if (Ext != TEXT("jsonl") && Ext != TEXT("aclog")) continue;
+            // AICore.LogToJSONL output (name.aclog.jsonl) next to its .aclog holds the same records
+            const FString Source = FPaths::GetBaseFilename(Name);
+            if (Ext == TEXT("jsonl") && SearchLogExtension(Source) == TEXT("aclog") && Names.Contains(Source)) continue;
+            Files.Add(FPaths::Combine(Input, Name));
+        }
+    }
+    else
+    {
+        Files.Add(Input);
+    }
+    if (Files.Num() == 0)
+    {
+        UE_LOG(LogAICore, Error, TEXT("[LogStats] no search logs in %s"), *Input);
+        return 1;
+    }
+
+    const FString OutliersPath = Output + TEXT("_outliers.csv");
+    TUniquePtr<FArchive> Outliers(IFileManager::Get().CreateFileWriter(*OutliersPath));
+    if (!Outliers)
+    {
+        UE_LOG(LogAICore, Error, TEXT("[LogStats] cannot write %s"), *OutliersPath);
+        return 1;
+    }
+    WriteLine(*Outliers, TEXT("ts,file,engine,difficulty,units,board,soft_ms,hard_ms,ms,queue_ms,nodes,depth_reached,score,key,pv"));
+
+    TMap<uint64, FGroupStats> Groups;
+    int64 NumSearches = 0, NumOver = 0, NumSkipped = 0;
+    int32 NumFiles = 0;
+    for (const FString& File : Files)
+    {
+        const FString FileName = FPaths::GetCleanFilename(File);
+        const bool bRead = AICore::ReadSearchLog(File, [&](const FSearchLogRecord& R)
+        {
+            const bool bOverHard = R.HardMs > 0 && R.Ms > (double)R.HardMs;
+            const uint32 Engine = (R.Kind == (uint8)AICore::ESearchLogKind::UTBG) ? R.Engine : kEngineBasic;
+            const uint32 Difficulty = (uint32)(R.Difficulty + 1);
+
+            Groups.FindOrAdd(GroupKey(EGroupBy::All, 0)).Add(R, bOverHard);
+            Groups.FindOrAdd(GroupKey(EGroupBy::Engine, Engine)).Add(R, bOverHard);
+            Groups.FindOrAdd(GroupKey(EGroupBy::Difficulty, Difficulty)).Add(R, bOverHard);
+            Groups.FindOrAdd(GroupKey(EGroupBy::Units, R.NumUnits)).Add(R, bOverHard);
+            Groups.FindOrAdd(GroupKey(EGroupBy::Board, ((uint32)R.BoardW << 8) | R.BoardH)).Add(R, bOverHard);
+            ++NumSearches;
+
+            if (!bOverHard) return;
+            ++NumOver;
+            WriteLine(*Outliers, FString::Printf(TEXT("%llu,%s,%s,%s,%d,%dx%d,%d,%d,%.3f,%.3f,%lld,%d,%d,0x%016llX,%s"),
+                (unsigned long long)R.TsMs, *FileName,
+                *GroupValue(GroupKey(EGroupBy::Engine, Engine)),
+                *GroupValue(GroupKey(EGroupBy::Difficulty, Difficulty)),
+                (int32)R.NumUnits, (int32)R.BoardW, (int32)R.BoardH, R.SoftMs, R.HardMs, R.Ms, R.QueueMs,
+                (long long)R.Nodes, (int32)R.DepthReached, R.Score, (unsigned long long)R.RootKey,
+                *AICore::SearchLogPVToString(R)));
+        }, &NumSkipped);
+
+        if (bRead) ++NumFiles;
+        else UE_LOG(LogAICore, Warning, TEXT("[LogStats] cannot read %s"), *File);
+    }
+    Outliers.Reset();
+
+    Groups.KeySort(TLess<uint64>());
+
+    FString Stats = TEXT("group,value,searches,over_hard,over_hard_pct,ms_p50,ms_p95,ms_p99,ms_max,ms_mean,queue_p95,total_p99,nps_p50,nps_mean,depth_p50\n");
+    FString Depth = TEXT("group,value,depth,searches,ms_p50,ms_p95,ms_p99\n");
+    for (const TPair<uint64, FGroupStats>& It : Groups)
+    {
+        const FString Name = FString::Printf(TEXT("%s,%s"), GroupKind(It.Key), *GroupValue(It.Key));
+        const FGroupStats& G = It.Value;
+        Stats += FString::Printf(TEXT("%s,%lld,%lld,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.0f,%.0f,%d\n"),
+            *Name, (long long)G.Searches, (long long)G.OverHard,
+            (G.WithBudget > 0) ? 100.0 * (double)G.OverHard / (double)G.WithBudget : 0.0,
+            G.Latency.Percentile(0.50), G.Latency.Percentile(0.95), G.Latency.Percentile(0.99), G.Latency.Max, G.Latency.Mean(),
+            G.Queue.Percentile(0.95), G.Total.Percentile(0.99),
+            G.NPS.Percentile(0.50), (G.Ms > 0.0) ? (double)G.Nodes / (G.Ms / 1000.0) : 0.0,
+            G.DepthPercentile(0.50));
+
+        for (int32 d = 0; d < FSearchLogRecord::kMaxDepths && G.DepthMs[d].Num > 0; ++d)
+        {
+            const FLogHistogram& H = G.DepthMs[d];
+            Depth += FString::Printf(TEXT("%s,%d,%lld,%.3f,%.3f,%.3f\n"),
+                *Name, d + 1, (long long)H.Num, H.Percentile(0.50), H.Percentile(0.95), H.Percentile(0.99));
+        }
+    }
+
+    const FString StatsPath = Output + TEXT(".csv");
+    const FString DepthPath = Output + TEXT("_depth.csv");
+    FFileHelper::SaveStringToFile(Stats, *StatsPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    FFileHelper::SaveStringToFile(Depth, *DepthPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+    UE_LOG(LogAICore, Display, TEXT("[LogStats] %lld searches from %d files (%lld unreadable records), %lld over the hard budget"),
+        (long long)NumSearches, NumFiles, (long long)NumSkipped, (long long)NumOver);
+    UE_LOG(LogAICore, Display, TEXT("[LogStats] -> %s, %s, %s"), *StatsPath, *DepthPath, *OutliersPath);
+    return NumFiles > 0 ? 0 : 1;
+}
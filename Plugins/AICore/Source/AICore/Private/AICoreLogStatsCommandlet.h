@@ -0,0 +1,31 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AICoreLogStatsCommandlet.generated.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Search log analytics
+//
+//   UnrealEditor-Cmd <project> -run=AICoreLogStats [-Input=<file|dir>] [-Output=<prefix>]
+//
+// Streams search logs (JSONL or .aclog, rotated files included; Input defaults
+// to Saved/AICore) and writes, relative to Saved/ (default AICore/logstats):
+//   <prefix>.csv           searches, latency p50/p95/p99/max, queue wait, NPS and
+//                          depth reached, for all searches and by engine,
+//                          difficulty, unit count and board size
+//   <prefix>_depth.csv     time to each completed depth (AlphaBeta)
+//   <prefix>_outliers.csv  every search that ran past its hard budget
+// Percentiles come from log-spaced histograms (about 1% error), so memory does
+// not grow with the size of the logs.
+//////////////////////////////////////////////////////////////////////////
+
+UCLASS()
+class UAICoreLogStatsCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UAICoreLogStatsCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,435 @@
+#include "CoreMinimal.h"
+#include "AICoreLog.h"
+#include "AICoreSearchInternal.h"
+#include "AICoreArena.h"
+#include "AICoreStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "rules_utbg.h"
+#include "rng.h"
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////
+// MCTS (PUCT) on UTBGRules
+//
+//  - node pool: one bump-allocated array per search; children are contiguous
+//  - tree parallelism: every worker descends the shared tree, virtual loss
+//    spreads workers over different branches
+//  - priors/rollouts: softmax / epsilon-greedy over ScoreActionForOrdering
+//  - values live in [-1,1] from the perspective of the side that played the
+//    node's move, so same-side consecutive actions (team AP) need no negation
+//////////////////////////////////////////////////////////////////////////
+
+static TAutoConsoleVariable<int32> CVarAICore_MCTSThreads(TEXT("AICore.MCTSThreads"), 0, TEXT("MCTS worker threads (0=auto)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_MCTSMaxNodes(TEXT("AICore.MCTSMaxNodes"), 200000, TEXT("MCTS node pool size per search"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_MCTSCPuct(TEXT("AICore.MCTSCPuct"), 150, TEXT("MCTS exploration constant x100"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_MCTSVirtualLoss(TEXT("AICore.MCTSVirtualLoss"), 3, TEXT("MCTS virtual loss per in-flight visit"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_MCTSRolloutPlies(TEXT("AICore.MCTSRolloutPlies"), 8, TEXT("MCTS rollout length in actions (0=eval only)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_MCTSPolicyTemp(TEXT("AICore.MCTSPolicyTemp"), 200, TEXT("MCTS prior softmax temperature (ordering score units)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_MCTSEvalScale(TEXT("AICore.MCTSEvalScale"), 600, TEXT("MCTS eval -> value scale: v = tanh(eval / scale)"), ECVF_Default);
+
+namespace
+{
+    constexpr int64 kValueFixed = 10000;     // ValueSum fixed-point scale
+
+    struct FMCTSNode
+    {
+        Action Move;                          // action from the parent
+        int32  FirstChild = -1;
+        int32  NumChildren = 0;
+        float  Prior = 0.f;
+        uint8  Mover = 0;                     // side that played Move
+        std::atomic<uint8> State{ 0 };        // 0=leaf, 1=expanding, 2=expanded, 3=pool full
+        std::atomic<int32> Visits{ 0 };
+        std::atomic<int32> VirtualLoss{ 0 };
+        std::atomic<int64> ValueSum{ 0 };     // Mover perspective, kValueFixed
+
+        void Init(const Action& A, uint8 InMover, float InPrior) {
+            Move = A; FirstChild = -1; NumChildren = 0; Prior = InPrior; Mover = InMover;
+            State.store(0, std::memory_order_relaxed);
+            Visits.store(0, std::memory_order_relaxed);
+            VirtualLoss.store(0, std::memory_order_relaxed);
+            ValueSum.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    // Fixed-capacity bump allocator; children of a node are one contiguous block.
+    struct FMCTSNodePool
+    {
+        std::unique_ptr<FMCTSNode[]> Nodes;
+        int32 Capacity = 0;
+        std::atomic<int32> Used{ 0 };
+
+        explicit FMCTSNodePool(int32 InCapacity)
+            : Nodes(new FMCTSNode[FMath::Max(1, InCapacity)]), Capacity(FMath::Max(1, InCapacity)) {}
+
+        int32 Alloc(int32 Count) {
+            const int32 first = Used.fetch_add(Count, std::memory_order_relaxed);
+            if (first + Count > Capacity) { Used.fetch_sub(Count, std::memory_order_relaxed); return -1; }
+            return first;
+        }
+        FMCTSNode& operator[](int32 i) { return Nodes[i]; }
+    };
+
+    struct FMCTSConfig
+    {
+        double CPuct = 1.5;
+        int32  VirtualLoss = 3;
+        int32  RolloutPlies = 8;
+        double PolicyTemp = 200.0;
+        double EvalScale = 600.0;
+        AICore::EvalWeights  E{};
+        AICore::OrderWeights O{};
+    };
+
+    // Built on the thread that runs it: the clone comes from the state pool and the vectors
+    // are leases from that thread's arena, so repeated searches reuse their buffers.
+    struct FMCTSWorker
+    {
+        AICore::FStatePool::FHandle Clone;
+        AICore::TScratch<int32> PathBuf;
+        AICore::TScratch<UTBGDelta> DeltasBuf;
+        AICore::TScratch<Action> ScratchBuf;
+        AICore::TScratch<int> ScoresBuf;
+
+        GameState& S;                         // worker-local copy of the root
+        XorShift64Star Rng;
+        std::vector<int32>& Path;
+        std::vector<UTBGDelta>& Deltas;
+        std::vector<Action>& Scratch;
+        std::vector<int>& Scores;
+
+        FMCTSWorker(const GameState& Root, uint64 Seed)
+            : Clone(AICore::FStatePool::Get().Acquire(Root)), S(*Clone), Rng(Seed)
+            , Path(*PathBuf), Deltas(*DeltasBuf), Scratch(*ScratchBuf), Scores(*ScoresBuf) {}
+    };
+
+    static FORCEINLINE bool TeamHasUnits(const GameState& S, int team)
+    {
+        for (const auto& u : S.units) if (u.alive && u.team == team) return true;
+        return false;
+    }
+
+    // a side wiped out or, in king modes, its kings dead (UTBGRules::outcome), as alpha-beta and the turn planner
+    static FORCEINLINE bool IsTerminal(const GameState& S)
+    {
+        return !TeamHasUnits(S, 0) || !TeamHasUnits(S, 1) || UTBGRules::outcome(S) != UTBGRules::kOngoing;
+    }
+
+    // value in [-1,1] for S.sideToAct
+    static FORCEINLINE double EvalToValue(const GameState& S, const FMCTSConfig& C)
+    {
+        const int outcome = UTBGRules::outcome(S);
+        if (outcome == UTBGRules::kDraw)    return 0.0;
+        if (outcome != UTBGRules::kOngoing) return (outcome == S.sideToAct) ? +1.0 : -1.0;
+        if (!TeamHasUnits(S, S.sideToAct))     return -1.0;
+        if (!TeamHasUnits(S, S.sideToAct ^ 1)) return +1.0;
+        return std::tanh((double)AICore::Eval(S, C.E) / C.EvalScale);
+    }
+
+    class FMCTSSearch
+    {
+    public:
+        FMCTSSearch(const UTBGRules& InR, const FMCTSConfig& InC, int32 PoolSize)
+            : R(InR), C(InC), Pool(PoolSize) {}
+
+        int32 CreateRoot(GameState& S)
+        {
+            const int32 root = Pool.Alloc(1);
+            Pool[root].Init(Action{}, (uint8)(S.sideToAct ^ 1), 1.f);
+            AICore::TScratch<Action> scratch; AICore::TScratch<int> scores;
+            Expand(S, root, *scratch, *scores);
+            return root;
+        }
+
+        void Playout(FMCTSWorker& W, int32 Root)
+        {
+            W.Path.clear(); W.Deltas.clear();
+            W.Path.push_back(Root);
+            int32 node = Root;
+
+            // 1) selection (virtual loss on the way down)
+            while (Pool[node].State.load(std::memory_order_acquire) == 2 && Pool[node].NumChildren > 0)
+            {
+                node = SelectChild(node);
+                Descend(W, node);
+            }
+
+            // 2) expansion (one thread per node; others fall through to a rollout)
+            FMCTSNode& leaf = Pool[node];
+            uint8 expected = 0;
+            if ((node == Root || leaf.Visits.load(std::memory_order_relaxed) > 0) &&
+                leaf.State.compare_exchange_strong(expected, 1, std::memory_order_acq_rel))
+            {
+                if (Expand(W.S, node, W.Scratch, W.Scores) && leaf.NumChildren > 0)
+                {
+                    node = SelectChild(node);
+                    Descend(W, node);
+                }
+            }
+
+            // 3) evaluation from the leaf side's perspective
+            const int leafSide = W.S.sideToAct;
+            const double v = Rollout(W);
+
+            // 4) backprop
+            const int64 vFixed = (int64)(v * (double)kValueFixed);
+            for (int32 i = (int32)W.Path.size() - 1; i >= 0; --i)
+            {
+                FMCTSNode& n = Pool[W.Path[i]];
+                n.ValueSum.fetch_add(n.Mover == leafSide ? vFixed : -vFixed, std::memory_order_relaxed);
+                n.Visits.fetch_add(1, std::memory_order_relaxed);
+                if (i > 0) n.VirtualLoss.fetch_sub(C.VirtualLoss, std::memory_order_relaxed);
+            }
+
+            for (int32 i = (int32)W.Deltas.size() - 1; i >= 0; --i)
+                R.unmake(W.S, W.Deltas[i]);
+        }
+
+        // PV: most visited children
+        void ExtractPV(int32 Root, std::vector<Action>& OutPV, int32 MaxLen) const
+        {
+            OutPV.clear();
+            int32 node = Root;
+            while ((int32)OutPV.size() < MaxLen)
+            {
+                const int32 best = MostVisitedChild(node);
+                if (best < 0) break;
+                OutPV.push_back(Pool.Nodes[best].Move);
+                node = best;
+            }
+        }
+
+        int32 MostVisitedChild(int32 Node) const
+        {
+            const FMCTSNode& n = Pool.Nodes[Node];
+            if (n.State.load(std::memory_order_acquire) != 2) return -1;
+            int32 best = -1, bestVisits = 0;
+            for (int32 i = 0; i < n.NumChildren; ++i)
+            {
+                const int32 c = n.FirstChild + i;
+                const int32 v = Pool.Nodes[c].Visits.load(std::memory_order_relaxed);
+                if (v > bestVisits || (v == bestVisits && best >= 0 && v > 0 &&
+                    Pool.Nodes[c].ValueSum.load(std::memory_order_relaxed) > Pool.Nodes[best].ValueSum.load(std::memory_order_relaxed)))
+                {
+                    best = c; bestVisits = v;
+                }
+            }
+            return best;
+        }
+
+        double MeanValue(int32 Node) const
+        {
+            const FMCTSNode& n = Pool.Nodes[Node];
+            const int32 v = n.Visits.load(std::memory_order_relaxed);
+            return v > 0 ? (double)n.ValueSum.load(std::memory_order_relaxed) / ((double)kValueFixed * v) : 0.0;
+        }
+
+        int32 NodesUsed() const { return FMath::Min(Pool.Used.load(std::memory_order_relaxed), Pool.Capacity); }
+
+    private:
+        const UTBGRules& R;
+        FMCTSConfig C;
+        FMCTSNodePool Pool;
+
+        void Descend(FMCTSWorker& W, int32 Child)
+        {
+            Pool[Child].VirtualLoss.fetch_add(C.VirtualLoss, std::memory_order_relaxed);
+            W.Deltas.emplace_back();
+            R.make(W.S, Pool[Child].Move, W.Deltas.back());
+            W.Path.push_back(Child);
+        }
+
+        int32 SelectChild(int32 Node)
+        {
+            FMCTSNode& n = Pool[Node];
+            const double sqrtN = std::sqrt((double)FMath::Max(1, n.Visits.load(std::memory_order_relaxed) + n.VirtualLoss.load(std::memory_order_relaxed)));
+
+            int32 best = n.FirstChild;
+            double bestScore = -std::numeric_limits<double>::infinity();
+            for (int32 i = 0; i < n.NumChildren; ++i)
+            {
+                const int32 c = n.FirstChild + i;
+                const FMCTSNode& ch = Pool[c];
+                const int32 visits = ch.Visits.load(std::memory_order_relaxed);
+                const int32 vl = ch.VirtualLoss.load(std::memory_order_relaxed);
+                const int32 nEff = visits + vl;
+
+                // virtual loss counts as lost visits
+                const double q = (nEff > 0)
+                    ? ((double)ch.ValueSum.load(std::memory_order_relaxed) / (double)kValueFixed - (double)vl) / (double)nEff
+                    : 0.0;
+                const double u = C.CPuct * (double)ch.Prior * sqrtN / (1.0 + (double)nEff);
+                if (q + u > bestScore) { bestScore = q + u; best = c; }
+            }
+            return best;
+        }
+
+        bool Expand(GameState& S, int32 Node, std::vector<Action>& Scratch, std::vector<int>& Scores)
+        {
+            FMCTSNode& n = Pool[Node];
+
+            if (IsTerminal(S)) { n.State.store(2, std::memory_order_release); return true; }
+
+            R.generateLegal(S, Scratch);
+            const int32 count = (int32)Scratch.size();
+            if (count == 0) { n.State.store(2, std::memory_order_release); return true; }
+
+            const int32 first = Pool.Alloc(count);
+            if (first < 0) { n.State.store(3, std::memory_order_release); return false; } // pool full: stays a leaf
+
+            Scores.resize(count);
+            int top = std::numeric_limits<int>::min();
+            for (int32 i = 0; i < count; ++i) {
+                Scores[i] = AICore::ScoreActionForOrdering(S, Scratch[i], C.O, /*attackDamage*/5);
+                top = FMath::Max(top, Scores[i]);
+            }
+            double sum = 0.0;
+            for (int32 i = 0; i < count; ++i) sum += std::exp((double)(Scores[i] - top) / C.PolicyTemp);
+
+            for (int32 i = 0; i < count; ++i) {
+                const float prior = (float)(std::exp((double)(Scores[i] - top) / C.PolicyTemp) / sum);
+                Pool[first + i].Init(Scratch[i], (uint8)S.sideToAct, prior);
+            }
+
+            n.FirstChild = first;
+            n.NumChildren = count;
+            n.State.store(2, std::memory_order_release);
+            return true;
+        }
+
+        // epsilon-greedy over the ordering score; value for the side to act at entry
+        double Rollout(FMCTSWorker& W)
+        {
+            GameState& S = W.S;
+            const int side = S.sideToAct;
+            const size_t base = W.Deltas.size();
+
+            for (int32 ply = 0; ply < C.RolloutPlies; ++ply)
+            {
+                if (IsTerminal(S)) break;
+                R.generateLegal(S, W.Scratch);
+                if (W.Scratch.empty()) break;
+
+                int32 pick = 0;
+                if ((W.Rng.next() & 7) == 0) {
+                    pick = (int32)(W.Rng.next() % (uint64)W.Scratch.size());
+                }
+                else {
+                    int bestSc = std::numeric_limits<int>::min();
+                    for (int32 i = 0; i < (int32)W.Scratch.size(); ++i) {
+                        const int sc = AICore::ScoreActionForOrdering(S, W.Scratch[i], C.O, /*attackDamage*/5);
+                        if (sc > bestSc) { bestSc = sc; pick = i; }
+                    }
+                }
+                W.Deltas.emplace_back();
+                R.make(S, W.Scratch[pick], W.Deltas.back());
+            }
+
+            const double v = EvalToValue(S, C);
+            const bool bSameSide = (S.sideToAct == side);
+
+            while (W.Deltas.size() > base) {
+                R.unmake(S, W.Deltas.back());
+                W.Deltas.pop_back();
+            }
+            return bSameSide ? v : -v;
+        }
+    };
+}
+
+namespace AICore
+{
+    void SearchUTBG_MCTS(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out)
+    {
+        UTBGRules R; R.TurnAP = Req.TurnAP;
+
+        FMCTSConfig C;
+        C.CPuct = FMath::Max(1, CVarAICore_MCTSCPuct.GetValueOnAnyThread()) / 100.0;
+        C.VirtualLoss = FMath::Max(0, CVarAICore_MCTSVirtualLoss.GetValueOnAnyThread());
+        C.RolloutPlies = FMath::Max(0, CVarAICore_MCTSRolloutPlies.GetValueOnAnyThread());
+        C.PolicyTemp = (double)FMath::Max(1, CVarAICore_MCTSPolicyTemp.GetValueOnAnyThread());
+        C.EvalScale = (double)FMath::Max(1, CVarAICore_MCTSEvalScale.GetValueOnAnyThread());
+        C.E = EvalWeightsFromCVars();
+        C.O = OrderWeightsFromCVars();
+
+        int32 Threads = Req.Threads > 0 ? Req.Threads : CVarAICore_MCTSThreads.GetValueOnAnyThread();
+        if (Threads <= 0) Threads = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1, 1, 16);
+
+        FTimeManager TM; TM.Start(FTimeBudget{ Req.SoftMs, Req.HardMs });
+
+        FMCTSSearch Search(R, C, CVarAICore_MCTSMaxNodes.GetValueOnAnyThread());
+        const int32 Root = Search.CreateRoot(S);
+
+        std::atomic<int64> Playouts{ 0 };
+        ParallelFor(Threads, [&](int32 WorkerIndex)
+        {
+            FMCTSWorker W(S, 0x9E3779B97F4A7C15ULL * (uint64)(WorkerIndex + 1) ^ S.key);
+            int64 local = 0;
+            while (!TM.SoftExpired())
+            {
+                Search.Playout(W, Root);
+                ++local;
+            }
+            Playouts.fetch_add(local, std::memory_order_relaxed);
+        });
+
+        Out.Engine = ESearchEngine::MCTS;
+        Search.ExtractPV(Root, Out.PV, /*MaxLen*/ FMath::Max(1, Req.MaxDepth));
+
+        const int32 best = Search.MostVisitedChild(Root);
+        const double q = (best >= 0) ? FMath::Clamp(Search.MeanValue(best), -0.999, 0.999) : 0.0;
+        Out.Score = (int32)(std::atanh(q) * C.EvalScale);   // back to eval units
+        Out.Nodes = Search.NodesUsed();
+        Out.Playouts = Playouts.load();
+        INC_DWORD_STAT_BY(STAT_AICore_Nodes, (uint32)Out.Nodes);
+        Out.Ms = TM.ElapsedMs();
+
+        UE_LOG(LogAICore, Verbose, TEXT("[MCTS] threads=%d playouts=%lld nodes=%lld %.0f playouts/s"),
+            Threads, (long long)Out.Playouts, (long long)Out.Nodes, Out.PlayoutsPerSec());
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console
+//////////////////////////////////////////////////////////////////////////
+
+// One attack left: kill the enemy king (the game is won) or the unit about to kill ours. Searched
+// past the end of the game, the king kill looks like a draw once our king dies in reply.
+static void RunAICoreMCTSCheck(const TArray<FString>& /*Args*/, UWorld* /*World*/)
+{
+    GameState S;
+    S.width = 5; S.height = 5; S.sideToAct = 0;
+    S.units = { Unit{0,0,0,3,2,true,5}, Unit{1,1,1,4,2,true,5}, Unit{2,0,12,10,2,true,5}, Unit{3,1,13,5,2,true,5} };
+    S.units[0].king = true;
+    S.units[3].king = true;
+    S.teamAP[0] = 1; S.teamAP[1] = 5; S.maxAP = 5;
+    S.initZobrist(0xC0FFEEULL, (int)S.units.size());
+
+    AICore::FUTBGSearchRequest Req;
+    Req.SoftMs = 200; Req.HardMs = 250; Req.MaxDepth = 3; Req.TurnAP = 5; Req.Threads = 1;
+    AICore::FUTBGSearchResult Res;
+    AICore::SearchUTBG_MCTS(S, Req, Res);
+
+    const bool bKill = !Res.PV.empty() && Res.PV[0].type == ActionType::Attack && Res.PV[0].targetId == 3;
+    if (!bKill)
+    {
+        UE_LOG(LogAICore, Error, TEXT("[MCTSCheck] FAIL: first type=%d actor=%d target=%d score=%d (expected Attack(2->3))"),
+            Res.PV.empty() ? -1 : (int32)Res.PV[0].type, Res.PV.empty() ? -1 : Res.PV[0].actorId, Res.PV.empty() ? -1 : Res.PV[0].targetId, Res.Score);
+        return;
+    }
+    UE_LOG(LogAICore, Log, TEXT("[MCTSCheck] OK score=%d playouts=%lld"), Res.Score, (long long)Res.Playouts);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreMCTSCheck(
+    TEXT("AICore.MCTSCheck"),
+    TEXT("Usage: AICore.MCTSCheck  // a game-winning king kill must be the MCTS engine's first move"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreMCTSCheck)
+);
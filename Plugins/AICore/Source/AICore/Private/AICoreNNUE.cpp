@@ -0,0 +1,208 @@
+#include "CoreMinimal.h"
+#include "AICoreLog.h"
+#include "AICoreNNUE.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+
+#include <algorithm>
+#include <atomic>
+
+//////////////////////////////////////////////////////////////////////////
+// NNUE weights file (little-endian)
+//
+//   char  magic[4] = "UNN1"
+//   int32 boardSize, hidden, l1, hpBuckets, outScale
+//   int16 featureWeights[2 * hpBuckets * boardSize][hidden]
+//   int16 featureBias[hidden]
+//   int8  l1Weights[l1][2 * hidden]
+//   int32 l1Bias[l1]
+//   int8  outWeights[l1]
+//   int32 outBias
+//////////////////////////////////////////////////////////////////////////
+
+static TAutoConsoleVariable<FString> CVarAICore_NNUEPath(TEXT("AICore.NNUEPath"), TEXT("AICore/utbg.nnue"), TEXT("NNUE weights file (relative path under Content/)"), ECVF_Default);
+
+// Published net: immutable once loaded, swapped under the lock. Searches hold their own
+// reference (GameState::nnueNet), so a reload never frees weights still being read.
+static FCriticalSection                      GAICoreNNUELock;
+static std::shared_ptr<const NNUENetwork>    GAICoreNNUE;
+static bool                                  GAICoreNNUETriedDefault = false;   // game thread
+static std::atomic<uint32>                   GAICoreNNUEVersion{ 0 };
+
+//////////////////////////////////////////////////////////////////////////
+// Inference kernels
+//////////////////////////////////////////////////////////////////////////
+
+// int16 accumulator -> uint8 [0,127]
+static FORCEINLINE void ClippedReLU16(const int16_t* In, uint8_t* Out)
+{
+#if AICORE_NNUE_AVX2
+    const __m256i zero = _mm256_setzero_si256();
+    for (int i = 0; i < kNNUEHidden; i += 32) {
+        const __m256i a = _mm256_load_si256((const __m256i*)(In + i));
+        const __m256i b = _mm256_load_si256((const __m256i*)(In + i + 16));
+        __m256i p = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+        p = _mm256_permute4x64_epi64(p, 0xD8); // packs works per 128-bit lane
+        _mm256_storeu_si256((__m256i*)(Out + i), p);
+    }
+#else
+    for (int i = 0; i < kNNUEHidden; ++i)
+        Out[i] = (uint8_t)std::clamp<int>(In[i], 0, 127);
+#endif
+}
+
+// dot(uint8[N], int8[N]), N % 32 == 0
+static FORCEINLINE int32_t DotU8I8(const uint8_t* X, const int8_t* W, int N)
+{
+#if AICORE_NNUE_AVX2
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < N; i += 32) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(X + i));
+        const __m256i w = _mm256_loadu_si256((const __m256i*)(W + i));
+        // 127*127*2 < INT16_MAX -> maddubs never saturates
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < N; ++i) sum += (int32_t)X[i] * (int32_t)W[i];
+    return sum;
+#endif
+}
+
+int32_t NNUEEvaluate(const NNUEAccumulator& Acc, int SideToAct)
+{
+    const NNUENetwork& N = *Acc.Net;
+
+    // side to act first, opponent second
+    alignas(32) uint8_t X[2 * kNNUEHidden];
+    ClippedReLU16(Acc.v[SideToAct & 1], X);
+    ClippedReLU16(Acc.v[(SideToAct & 1) ^ 1], X + kNNUEHidden);
+
+    int32_t out = N.outBias;
+    for (int o = 0; o < kNNUEL1; ++o) {
+        const int32_t h = (DotU8I8(X, N.l1Weights[o], 2 * kNNUEHidden) + N.l1Bias[o]) >> kNNUEL1Shift;
+        out += std::clamp<int32_t>(h, 0, 127) * (int32_t)N.outWeights[o];
+    }
+    return out / (N.outScale > 0 ? N.outScale : 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Loader
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    struct FByteReader
+    {
+        const uint8* Data = nullptr;
+        int64 Size = 0;
+        int64 Pos = 0;
+
+        bool Read(void* Dst, int64 Bytes) {
+            if (Pos + Bytes > Size) return false;
+            FMemory::Memcpy(Dst, Data + Pos, Bytes);
+            Pos += Bytes;
+            return true;
+        }
+        template<typename T> bool Read(T& V) { return Read(&V, sizeof(T)); }
+    };
+}
+
+namespace AICore
+{
+    bool LoadNNUENetwork(const FString& Path, FString* OutError)
+    {
+        auto Fail = [&](const TCHAR* Msg) {
+            if (OutError) *OutError = FString::Printf(TEXT("%s (%s)"), Msg, *Path);
+            return false;
+        };
+
+        const FString File = FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectContentDir(), Path) : Path;
+
+        TArray<uint8> Bytes;
+        if (!FFileHelper::LoadFileToArray(Bytes, *File)) return Fail(TEXT("cannot read file"));
+
+        FByteReader R{ Bytes.GetData(), (int64)Bytes.Num(), 0 };
+
+        char Magic[4] = {};
+        int32 BoardSize = 0, Hidden = 0, L1 = 0, HPBuckets = 0, OutScale = 0;
+        if (!R.Read(Magic, 4) || FMemory::Memcmp(Magic, "UNN1", 4) != 0) return Fail(TEXT("bad magic"));
+        if (!R.Read(BoardSize) || !R.Read(Hidden) || !R.Read(L1) || !R.Read(HPBuckets) || !R.Read(OutScale))
+            return Fail(TEXT("truncated header"));
+        if (Hidden != kNNUEHidden || L1 != kNNUEL1 || HPBuckets != kNNUEHPBuckets)
+            return Fail(TEXT("architecture mismatch"));
+        if (BoardSize <= 0 || BoardSize > 4096) return Fail(TEXT("bad board size"));
+
+        auto N = std::make_shared<NNUENetwork>();
+        N->boardSize = BoardSize;
+        N->numFeatures = 2 * kNNUEHPBuckets * BoardSize;
+        N->outScale = OutScale > 0 ? OutScale : 1;
+        N->featureWeights.resize((size_t)N->numFeatures * kNNUEHidden);
+
+        const bool bOk =
+            R.Read(N->featureWeights.data(), (int64)N->featureWeights.size() * sizeof(int16_t)) &&
+            R.Read(N->featureBias, sizeof(N->featureBias)) &&
+            R.Read(N->l1Weights, sizeof(N->l1Weights)) &&
+            R.Read(N->l1Bias, sizeof(N->l1Bias)) &&
+            R.Read(N->outWeights, sizeof(N->outWeights)) &&
+            R.Read(N->outBias);
+        if (!bOk) return Fail(TEXT("truncated weights"));
+
+        {
+            FScopeLock Lock(&GAICoreNNUELock);
+            N->version = ++GAICoreNNUEVersion;
+            GAICoreNNUE = std::move(N);
+        }
+        return true;
+    }
+
+    std::shared_ptr<const NNUENetwork> GetNNUENetwork()
+    {
+        if (IsInGameThread() && !GAICoreNNUETriedDefault) {
+            GAICoreNNUETriedDefault = true;
+            bool bLoaded;
+            {
+                FScopeLock Lock(&GAICoreNNUELock);
+                bLoaded = (bool)GAICoreNNUE;
+            }
+            FString Err;
+            if (!bLoaded && !LoadNNUENetwork(CVarAICore_NNUEPath.GetValueOnAnyThread(), &Err))
+                UE_LOG(LogAICore, Warning, TEXT("[NNUE] %s -> classic eval"), *Err);
+        }
+        FScopeLock Lock(&GAICoreNNUELock);
+        return GAICoreNNUE;
+    }
+
+    uint32 GetNNUENetworkVersion() { return GAICoreNNUEVersion.load(); }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console
+//////////////////////////////////////////////////////////////////////////
+
+// AICore.NNUELoad [path]
+static void RunAICoreNNUELoad(const TArray<FString>& Args, UWorld*)
+{
+    const FString Path = (Args.Num() >= 1) ? Args[0] : CVarAICore_NNUEPath.GetValueOnAnyThread();
+    FString Err;
+    if (!AICore::LoadNNUENetwork(Path, &Err)) {
+        UE_LOG(LogAICore, Error, TEXT("[NNUE] load failed: %s"), *Err);
+        return;
+    }
+    const std::shared_ptr<const NNUENetwork> Net = AICore::GetNNUENetwork();
+    UE_LOG(LogAICore, Log, TEXT("[NNUE] loaded %s board=%d features=%d hidden=%d l1=%d simd=%s"),
+        *Path, Net->boardSize, Net->numFeatures, kNNUEHidden, kNNUEL1,
+        AICORE_NNUE_AVX2 ? TEXT("avx2") : TEXT("scalar"));
+}
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreNNUELoad(
+    TEXT("AICore.NNUELoad"),
+    TEXT("Usage: AICore.NNUELoad [path] // default: AICore.NNUEPath"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreNNUELoad)
+);
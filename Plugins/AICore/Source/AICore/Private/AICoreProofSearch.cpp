@@ -0,0 +1,218 @@
+#include "CoreMinimal.h"
+#include "AICoreSearchInternal.h"
+#include "rules_utbg.h"
+
+#include <vector>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// Depth-first proof-number search (df-pn) for forced king kills
+//
+// AND/OR tree over single actions: OR nodes have the attacker to act,
+// AND nodes the defender. A node is proved once the defender's kings are
+// all dead (UTBGRules::outcome), disproved when the attacker's kings fall,
+// the match is drawn, or the attacker's last allowed turn has ended.
+// Proof/disproof numbers live in a small two-way table keyed by position
+// and turn clock; a store always lands, evicting an open entry if it can.
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    constexpr uint32 kPNInf = 100000000;
+
+    struct FPNEntry
+    {
+        uint64 Key = 0;
+        uint32 PN = 1;
+        uint32 DN = 1;
+    };
+
+    class FKingProof
+    {
+    public:
+        FKingProof(GameState& InS, const UTBGRules& InR, int32 Turns, int64 InMaxNodes)
+            : S(InS), R(InR), Attacker(InS.sideToAct), LastTurn(InS.turn + 2 * Turns - 1), MaxNodes(InMaxNodes)
+        {
+            Table.resize(kTableSize);
+        }
+
+        bool Prove(std::vector<Action>& OutLine)
+        {
+            OutLine.clear();
+            if (Solved() >= 0) return false;     // decided already, or no turn left
+
+            MID(kPNInf, kPNInf, 0);
+            uint32 pn, dn;
+            Lookup(Key(), pn, dn);
+            return pn == 0 && ExtractLine(OutLine);
+        }
+
+        int64 GetNodes() const { return Nodes; }
+
+    private:
+        static constexpr int32 kTableSize = 1 << 16;     // entries, in buckets of two
+
+        GameState& S;
+        const UTBGRules& R;
+        const int Attacker;
+        const int LastTurn;         // S.turn once the attacker's last allowed turn has ended
+        const int64 MaxNodes;
+        int64 Nodes = 0;
+        std::vector<FPNEntry> Table;
+        std::vector<std::vector<Action>> MovesAt;   // per recursion level, so buffers are reused
+        std::vector<std::vector<uint64>> KeysAt;
+
+        // the turn clock bounds the attacker's remaining turns and drives cooldowns
+        uint64 Key() const { return S.key ^ ((uint64)(uint32)S.turn * 0x9E3779B97F4A7C15ULL); }
+
+        // 1: proved, 0: disproved, -1: open
+        int Solved() const
+        {
+            const int o = UTBGRules::outcome(S);
+            if (o == Attacker) return 1;
+            if (o != UTBGRules::kOngoing) return 0;
+            return (S.turn >= LastTurn) ? 0 : -1;
+        }
+
+        FORCEINLINE FPNEntry* Bucket(uint64 K) { return &Table[(K << 1) & (kTableSize - 1)]; }
+        FORCEINLINE const FPNEntry* Bucket(uint64 K) const { return &Table[(K << 1) & (kTableSize - 1)]; }
+
+        void Lookup(uint64 K, uint32& PN, uint32& DN) const
+        {
+            const FPNEntry* B = Bucket(K);
+            for (int i = 0; i < 2; ++i)
+                if (B[i].Key == K) { PN = B[i].PN; DN = B[i].DN; return; }
+            PN = 1; DN = 1;
+        }
+
+        // Never refuses: a lost store would hand the parent the same numbers forever. Solved entries
+        // (needed to extract the line) are evicted only when both are solved.
+        void Store(uint64 K, uint32 PN, uint32 DN)
+        {
+            FPNEntry* B = Bucket(K);
+            FPNEntry* E = (B[0].Key == K) ? &B[0] : (B[1].Key == K) ? &B[1]
+                : (B[0].PN != 0 && B[0].DN != 0) ? &B[0] : &B[1];
+            E->Key = K; E->PN = PN; E->DN = DN;
+        }
+
+        void StoreSolved(uint64 K, bool bProved)
+        {
+            if (bProved) Store(K, 0, kPNInf);
+            else         Store(K, kPNInf, 0);
+        }
+
+        static FORCEINLINE uint32 AddCapped(uint32 A, uint32 B) { return (uint32)FMath::Min<uint64>((uint64)A + B, kPNInf); }
+
+        void MID(uint32 ThPN, uint32 ThDN, int32 Level)
+        {
+            const uint64 key = Key();
+            const int solved = Solved();
+            if (solved >= 0) { StoreSolved(key, solved == 1); return; }
+
+            // per-level buffers: re-fetched after each recursion, deeper levels may grow the arrays
+            if ((int32)MovesAt.size() <= Level) { MovesAt.resize(Level + 1); KeysAt.resize(Level + 1); }
+            R.generateLegal(S, MovesAt[Level]);
+            const int32 numMoves = (int32)MovesAt[Level].size();
+            if (numMoves == 0) { StoreSolved(key, false); return; }
+
+            // child keys once per visit; children that end the match are solved on the spot
+            KeysAt[Level].resize(numMoves);
+            for (int32 i = 0; i < numMoves; ++i)
+            {
+                UTBGDelta d;
+                R.make(S, MovesAt[Level][i], d);
+                ++Nodes;
+                KeysAt[Level][i] = Key();
+                const int childSolved = Solved();
+                if (childSolved >= 0) StoreSolved(KeysAt[Level][i], childSolved == 1);
+                R.unmake(S, d);
+            }
+
+            // OR node (attacker): pn = min, dn = sum over children. AND node: pn = sum, dn = min.
+            // Phi is the minimised number of the side to act, Delta the summed one.
+            const bool bOr = (S.sideToAct == Attacker);
+            const uint32 thPhi = bOr ? ThPN : ThDN;
+            const uint32 thDelta = bOr ? ThDN : ThPN;
+            for (;;)
+            {
+                uint32 phi = kPNInf, phi2 = kPNInf, delta = 0, bestDelta = 0;
+                int32 best = 0;
+                for (int32 i = 0; i < numMoves; ++i)
+                {
+                    uint32 pn, dn;
+                    Lookup(KeysAt[Level][i], pn, dn);
+                    const uint32 cPhi = bOr ? pn : dn;
+                    const uint32 cDelta = bOr ? dn : pn;
+                    delta = AddCapped(delta, cDelta);
+                    if (cPhi < phi) { phi2 = phi; phi = cPhi; best = i; bestDelta = cDelta; }
+                    else if (cPhi < phi2) phi2 = cPhi;
+                }
+
+                if (phi >= thPhi || delta >= thDelta || Nodes >= MaxNodes)
+                {
+                    Store(key, bOr ? phi : delta, bOr ? delta : phi);
+                    return;
+                }
+
+                // the best child runs until the runner-up would take over (plus 1/4, the "1+epsilon" trick
+                // against re-expanding the same two children) or the delta budget is spent
+                const uint32 cThPhi = FMath::Min(thPhi, AddCapped(phi2, phi2 / 4 + 1));
+                const uint32 cThDelta = (uint32)FMath::Min<uint64>((uint64)thDelta - delta + bestDelta, kPNInf);
+
+                UTBGDelta d;
+                R.make(S, MovesAt[Level][best], d);
+                ++Nodes;
+                MID(bOr ? cThPhi : cThDelta, bOr ? cThDelta : cThPhi, Level + 1);
+                R.unmake(S, d);
+            }
+        }
+
+        // Attacker's proved actions from the root until the turn passes or the king falls;
+        // immediate kills first.
+        bool ExtractLine(std::vector<Action>& OutLine)
+        {
+            std::vector<UTBGDelta> made;
+            bool bOk = true;
+            while (S.sideToAct == Attacker && Solved() < 0)
+            {
+                std::vector<Action> moves;
+                R.generateLegal(S, moves);
+
+                int pick = -1;
+                for (int i = 0; i < (int)moves.size(); ++i)
+                {
+                    UTBGDelta d;
+                    R.make(S, moves[i], d);
+                    uint32 pn, dn;
+                    Lookup(Key(), pn, dn);
+                    const int solved = Solved();
+                    R.unmake(S, d);
+                    if (solved == 1) { pick = i; break; }
+                    if (pick < 0 && solved < 0 && pn == 0) pick = i;
+                }
+                if (pick < 0) { bOk = false; break; }      // proof entry evicted
+
+                OutLine.push_back(moves[pick]);
+                made.emplace_back();
+                R.make(S, moves[pick], made.back());
+            }
+            for (int i = (int)made.size() - 1; i >= 0; --i) R.unmake(S, made[i]);
+            return bOk && !OutLine.empty();
+        }
+    };
+}
+
+namespace AICore
+{
+    bool ProveKingKill(GameState& S, const UTBGRules& R, int32 Turns, int64 MaxNodes, std::vector<Action>& OutLine, int64& OutNodes)
+    {
+        OutLine.clear();
+        OutNodes = 0;
+        if (Turns <= 0 || MaxNodes <= 0) return false;
+
+        FKingProof P(S, R, Turns, MaxNodes);
+        const bool bProved = P.Prove(OutLine);
+        OutNodes = P.GetNodes();
+        return bProved;
+    }
+}
@@ -0,0 +1,415 @@
+#include "AICoreScheduler.h"
+#include "AICoreLog.h"
+#include "AICoreSearchInternal.h"
+#include "tt.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+
+#include <vector>
+#include <algorithm>
+
+static TAutoConsoleVariable<int32> CVarAICore_SchedWorkers(TEXT("AICore.SchedWorkers"), 0, TEXT("Search scheduler worker threads (0=auto, read when the pool starts)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_SchedSliceMs(TEXT("AICore.SchedSliceMs"), 100, TEXT("Search scheduler time slice for alpha-beta jobs while other matches wait (0=no slicing)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_SchedTTMB(TEXT("AICore.SchedTTMB"), 16, TEXT("TT partition per match in MB (per-job memory budget)"), ECVF_Default);
+
+namespace AICore
+{
+    namespace
+    {
+        constexpr int32 kWaitWindow = 256;      // recent slice waits kept for avg/p95
+
+        struct FSearchJob
+        {
+            uint64 Id = 0;
+            FSearchMatchId Match = 0;
+            GameState S;
+            FUTBGSearchRequest Req;
+            TPromise<FScheduledSearchResult> Promise;
+            FScheduledSearchResult Acc;
+            TUniquePtr<FIncrementalSearchUTBG> Search;     // sliced alpha-beta, paused between slices
+            double QueuedAt = 0.0;      // last time the job (re)entered the queue
+        };
+
+        // Classic eval weights and the NNUE net (by load version) the search of S scores with;
+        // a partition TT scored under another key is cleared, as the shared TT is on a change.
+        uint64 EvalKeyOf(const GameState& S)
+        {
+            const EvalWeights E = EvalWeightsFromCVars();
+            uint64 K = 0xCBF29CE484222325ULL;
+            for (const int32 V : { E.HP, E.Pos, E.TFor, E.TAgainst, E.Coh, S.nnue.Net ? (int32)S.nnue.Net->version : -1 })
+                K = (K ^ (uint32)V) * 0x100000001B3ULL;
+            return K;
+        }
+
+        struct FMatchSlot
+        {
+            TTable TT;
+            double VTimeMs = 0.0;       // search time used; the least-served match runs next
+            int32  Queued = 0;
+            bool   bRunning = false;
+            uint64 EvalKey = 0;         // eval the TT entries were scored with (EvalKeyOf)
+            bool   bRelease = false;    // free once idle
+            uint64 CancelBelowId = 0;   // jobs submitted before the last Cancel are not requeued
+        };
+    }
+
+    struct FSearchScheduler::FImpl
+    {
+        class FWorker : public FRunnable
+        {
+        public:
+            explicit FWorker(FImpl& InOwner) : Owner(InOwner) {}
+            virtual uint32 Run() override { Owner.WorkerLoop(); return 0; }
+            virtual void Stop() override {}
+        private:
+            FImpl& Owner;
+        };
+
+        mutable FCriticalSection Lock;
+        FEvent* WorkEvent = nullptr;
+        TArray<FRunnableThread*> Threads;
+        TArray<TUniquePtr<FWorker>> Workers;
+        bool bStopping = false;
+
+        TArray<TUniquePtr<FSearchJob>> Queue;
+        TMap<FSearchMatchId, TUniquePtr<FMatchSlot>> Matches;
+        uint64 NextJobId = 1;
+        int32  Running = 0;
+
+        int64  JobsDone = 0;
+        int64  SliceCount = 0;
+        double WaitMaxMs = 0.0;
+        double RecentWaits[kWaitWindow] = {};
+        int32  RecentNum = 0;
+        int32  RecentHead = 0;
+
+        void Start()
+        {
+            int32 N = CVarAICore_SchedWorkers.GetValueOnAnyThread();
+            if (N <= 0) N = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1, 1, 16);
+
+            WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+            for (int32 i = 0; i < N; ++i)
+            {
+                Workers.Add(MakeUnique<FWorker>(*this));
+                Threads.Add(FRunnableThread::Create(Workers.Last().Get(),
+                    *FString::Printf(TEXT("AICoreSearch%d"), i), 0, TPri_BelowNormal));
+            }
+            UE_LOG(LogAICore, Log, TEXT("[Sched] %d search workers"), N);
+        }
+
+        void Stop()
+        {
+            TArray<TUniquePtr<FSearchJob>> Dropped;
+            {
+                FScopeLock L(&Lock);
+                bStopping = true;
+                Dropped = MoveTemp(Queue);
+            }
+            for (TUniquePtr<FSearchJob>& J : Dropped) Finish(*J, /*bCancelled*/true);
+
+            for (int32 i = 0; i < Threads.Num(); ++i) WorkEvent->Trigger();
+            for (FRunnableThread* T : Threads) { T->WaitForCompletion(); delete T; }
+            Threads.Reset();
+            Workers.Reset();
+            FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+            WorkEvent = nullptr;
+        }
+
+        static void Finish(FSearchJob& J, bool bCancelled)
+        {
+            J.Acc.bCancelled = bCancelled;
+            J.Promise.SetValue(MoveTemp(J.Acc));
+        }
+
+        void RecordWait(double Ms)
+        {
+            RecentWaits[RecentHead] = Ms;
+            RecentHead = (RecentHead + 1) % kWaitWindow;
+            RecentNum = FMath::Min(RecentNum + 1, kWaitWindow);
+            WaitMaxMs = FMath::Max(WaitMaxMs, Ms);
+        }
+
+        // Least-served match first among jobs whose match is idle; FIFO within a match. Lock held.
+        int32 PickLocked() const
+        {
+            int32 Best = INDEX_NONE;
+            double BestVTime = 0.0;
+            for (int32 i = 0; i < Queue.Num(); ++i)
+            {
+                const FMatchSlot& M = *Matches.FindChecked(Queue[i]->Match);
+                if (M.bRunning) continue;
+                if (Best == INDEX_NONE || M.VTimeMs < BestVTime ||
+                    (M.VTimeMs == BestVTime && Queue[i]->Id < Queue[Best]->Id))
+                {
+                    Best = i;
+                    BestVTime = M.VTimeMs;
+                }
+            }
+            return Best;
+        }
+
+        // an idle match re-enters at the current minimum so it cannot bank credit while away. Lock held.
+        double MinVTimeLocked() const
+        {
+            double Min = -1.0;
+            for (const auto& It : Matches)
+                if (It.Value->bRunning || It.Value->Queued > 0)
+                    Min = (Min < 0.0) ? It.Value->VTimeMs : FMath::Min(Min, It.Value->VTimeMs);
+            return FMath::Max(Min, 0.0);
+        }
+
+        void WorkerLoop()
+        {
+            for (;;)
+            {
+                TUniquePtr<FSearchJob> Job;
+                FMatchSlot* Slot = nullptr;
+                {
+                    FScopeLock L(&Lock);
+                    if (bStopping) return;
+                    const int32 Idx = PickLocked();
+                    if (Idx != INDEX_NONE)
+                    {
+                        Job = MoveTemp(Queue[Idx]);
+                        Queue.RemoveAt(Idx);
+                        Slot = Matches.FindChecked(Job->Match).Get();
+                        Slot->bRunning = true;
+                        --Slot->Queued;
+                        ++Running;
+
+                        const double WaitMs = (FPlatformTime::Seconds() - Job->QueuedAt) * 1000.0;
+                        Job->Acc.QueueWaitMs += WaitMs;
+                        RecordWait(WaitMs);
+                        ++SliceCount;
+                    }
+                }
+                if (!Job)
+                {
+                    WorkEvent->Wait(50);
+                    continue;
+                }
+
+                const FSearchMatchId Match = Job->Match;
+                const bool bDone = RunSlice(*Job, *Slot);
+
+                bool bCancelled = false;
+                {
+                    FScopeLock L(&Lock);
+                    Slot->bRunning = false;
+                    --Running;
+                    bCancelled = !bDone && (bStopping || Slot->bRelease || Job->Id < Slot->CancelBelowId);
+                    if (!bDone && !bCancelled)
+                    {
+                        Job->QueuedAt = FPlatformTime::Seconds();
+                        ++Slot->Queued;
+                        Queue.Add(MoveTemp(Job));
+                    }
+                    else
+                    {
+                        ++JobsDone;
+                    }
+                    if (Slot->bRelease && Slot->Queued == 0) Matches.Remove(Match);
+                }
+                if (Job && !bCancelled) LogUTBGSearch(Job->S, Job->Req, Job->Acc.Result, Job->Acc.QueueWaitMs);
+                if (Job) Finish(*Job, bCancelled);
+                WorkEvent->Trigger();   // a match became idle: its next job may be runnable
+            }
+        }
+
+        bool OthersWaiting() const
+        {
+            FScopeLock L(&Lock);
+            return Queue.Num() > 0;
+        }
+
+        // One slice on a worker. True when the job is complete.
+        bool RunSlice(FSearchJob& J, FMatchSlot& Slot)
+        {
+            const uint64 EvalKey = EvalKeyOf(J.S);
+            if (!Slot.TT.IsReady() || Slot.EvalKey != EvalKey)
+            {
+                const int32 MB = FMath::Max(1, CVarAICore_SchedTTMB.GetValueOnAnyThread());
+                Slot.TT.ResizeMB(MB);
+                Slot.EvalKey = EvalKey;
+            }
+
+            FUTBGSearchRequest Req = J.Req;
+            Req.TT = &Slot.TT;
+            Req.Threads = 1;            // MCTS stays on this worker; the pool is the parallelism
+
+            // node-budgeted jobs run whole: their result must not depend on the slicing
+            const int32 SliceMs = CVarAICore_SchedSliceMs.GetValueOnAnyThread();
+            const bool bSliceable = (Req.Engine == ESearchEngine::AlphaBeta) && Req.MaxNodes <= 0;
+            FScheduledSearchResult& A = J.Acc;
+            double Ms = 0.0;
+            bool bDone = true;
+            if (bSliceable)
+            {
+                // one search for the whole job: its clock only runs inside Step, so Req's
+                // soft/hard limits span the slices, and each slice resumes where the last stopped
+                if (!J.Search)
+                {
+                    J.Search = MakeUnique<FIncrementalSearchUTBG>();
+                    J.Search->Start(J.S, Req, /*bLog*/false);
+                }
+                // runs on in slices until it finishes or another job is waiting
+                const double T0 = FPlatformTime::Seconds();
+                do bDone = J.Search->Step(SliceMs > 0 ? SliceMs * 1000 : 0);
+                while (!bDone && !OthersWaiting());
+                Ms = (FPlatformTime::Seconds() - T0) * 1000.0;
+                if (bDone)
+                {
+                    A.Result = J.Search->GetResult();
+                    J.Search.Reset();
+                }
+            }
+            else
+            {
+                SearchUTBG(J.S, Req, A.Result);
+                Ms = A.Result.Ms;
+            }
+            ++A.Slices;
+
+            {
+                FScopeLock L(&Lock);
+                Slot.VTimeMs += Ms;
+            }
+            return bDone;
+        }
+    };
+
+    static TUniquePtr<FSearchScheduler> GScheduler;
+    static FCriticalSection GSchedulerLock;
+
+    FSearchScheduler& FSearchScheduler::Get()
+    {
+        FScopeLock L(&GSchedulerLock);
+        if (!GScheduler)
+        {
+            GScheduler.Reset(new FSearchScheduler());
+            GScheduler->Impl = MakeUnique<FImpl>();
+            GScheduler->Impl->Start();
+        }
+        return *GScheduler;
+    }
+
+    void FSearchScheduler::Shutdown()
+    {
+        FScopeLock L(&GSchedulerLock);
+        GScheduler.Reset();
+    }
+
+    FSearchScheduler::~FSearchScheduler()
+    {
+        if (Impl) Impl->Stop();
+    }
+
+    TFuture<FScheduledSearchResult> FSearchScheduler::Submit(FSearchMatchId Match, GameState&& S, const FUTBGSearchRequest& Req)
+    {
+        TUniquePtr<FSearchJob> Job = MakeUnique<FSearchJob>();
+        Job->Match = Match;
+        Job->S = MoveTemp(S);
+        Job->Req = Req;
+        Job->QueuedAt = FPlatformTime::Seconds();
+        TFuture<FScheduledSearchResult> Future = Job->Promise.GetFuture();
+
+        {
+            FScopeLock L(&Impl->Lock);
+            if (Impl->bStopping)
+            {
+                FImpl::Finish(*Job, /*bCancelled*/true);
+                return Future;
+            }
+            TUniquePtr<FMatchSlot>& Slot = Impl->Matches.FindOrAdd(Match);
+            if (!Slot)
+            {
+                Slot = MakeUnique<FMatchSlot>();
+                Slot->VTimeMs = Impl->MinVTimeLocked();
+            }
+            else if (!Slot->bRunning && Slot->Queued == 0)
+            {
+                Slot->VTimeMs = FMath::Max(Slot->VTimeMs, Impl->MinVTimeLocked());
+            }
+            Slot->bRelease = false;
+            ++Slot->Queued;
+            Job->Id = Impl->NextJobId++;
+            Impl->Queue.Add(MoveTemp(Job));
+        }
+        Impl->WorkEvent->Trigger();
+        return Future;
+    }
+
+    void FSearchScheduler::Cancel(FSearchMatchId Match)
+    {
+        TArray<TUniquePtr<FSearchJob>> Dropped;
+        {
+            FScopeLock L(&Impl->Lock);
+            for (int32 i = Impl->Queue.Num() - 1; i >= 0; --i)
+            {
+                if (Impl->Queue[i]->Match != Match) continue;
+                Dropped.Add(MoveTemp(Impl->Queue[i]));
+                Impl->Queue.RemoveAt(i);
+            }
+            if (TUniquePtr<FMatchSlot>* Slot = Impl->Matches.Find(Match))
+            {
+                (*Slot)->Queued = 0;
+                (*Slot)->CancelBelowId = Impl->NextJobId;
+            }
+        }
+        for (TUniquePtr<FSearchJob>& J : Dropped) FImpl::Finish(*J, /*bCancelled*/true);
+    }
+
+    void FSearchScheduler::ReleaseMatch(FSearchMatchId Match)
+    {
+        Cancel(Match);
+        FScopeLock L(&Impl->Lock);
+        if (TUniquePtr<FMatchSlot>* Slot = Impl->Matches.Find(Match))
+        {
+            if ((*Slot)->bRunning) (*Slot)->bRelease = true;     // the worker frees it after the slice
+            else Impl->Matches.Remove(Match);
+        }
+    }
+
+    FSchedulerStats FSearchScheduler::GetStats() const
+    {
+        FScopeLock L(&Impl->Lock);
+        FSchedulerStats St;
+        St.Workers = Impl->Threads.Num();
+        St.Matches = Impl->Matches.Num();
+        St.Queued = Impl->Queue.Num();
+        St.Running = Impl->Running;
+        St.JobsDone = Impl->JobsDone;
+        St.Slices = Impl->SliceCount;
+        St.WaitMaxMs = Impl->WaitMaxMs;
+        if (Impl->RecentNum > 0)
+        {
+            std::vector<double> W(Impl->RecentWaits, Impl->RecentWaits + Impl->RecentNum);
+            double Sum = 0.0;
+            for (double w : W) Sum += w;
+            St.WaitAvgMs = Sum / W.size();
+            const size_t P95 = std::min(W.size() - 1, (size_t)(W.size() * 0.95));
+            std::nth_element(W.begin(), W.begin() + P95, W.end());
+            St.WaitP95Ms = W[P95];
+        }
+        return St;
+    }
+}
+
+// AICore.SchedStats
+static void RunAICoreSchedStats()
+{
+    const AICore::FSchedulerStats St = AICore::FSearchScheduler::Get().GetStats();
+    UE_LOG(LogAICore, Log, TEXT("[Sched] workers=%d matches=%d queued=%d running=%d jobs=%lld slices=%lld wait(avg/p95/max)=%.2f/%.2f/%.2fms"),
+        St.Workers, St.Matches, St.Queued, St.Running, (long long)St.JobsDone, (long long)St.Slices,
+        St.WaitAvgMs, St.WaitP95Ms, St.WaitMaxMs);
+}
+
+static FAutoConsoleCommand CmdAICoreSchedStats(
+    TEXT("AICore.SchedStats"),
+    TEXT("Usage: AICore.SchedStats (search scheduler queue-wait latency and load)"),
+    FConsoleCommandDelegate::CreateStatic(&RunAICoreSchedStats)
+);
@@ -5,12 +5,17 @@
 #include "String/LexFromString.h"
 #include "Engine/World.h"
 #include "Engine/Engine.h"
-#include "Misc/Paths.h"
-#include "HAL/PlatformFilemanager.h"
-#include "Misc/FileHelper.h"
 #include "rules.h"
 #include "rules_utbg.h"
 #include "tt.h"
+#include "rng.h"
+#include "AICoreNNUE.h"
+#include "AICoreSearchInternal.h"
+#include "AICoreKeySet.h"
+#include "AICoreEvalCache.h"
+#include "AICoreArena.h"
+#include "AICoreStats.h"
+#include "AICoreSearchLog.h"
 
 #include <vector>
 #include <algorithm>
@@ -34,6 +39,9 @@ static struct FAICoreSearchTUProbe {
 static TTable GAICoreTT;
 static int32  GAICoreTTSizeMB = 64;
 
+// Static-eval hash (all engines/threads; entries keyed by position, weights and backend)
+static FEvalCache GAICoreEvalCache;
+
 //////////////////////////////////////////////////////////////////////////
 // Defaults (difficulty)
 //////////////////////////////////////////////////////////////////////////
@@ -43,6 +51,11 @@ static int32 GAICoreDefaultHardMs = 350;
 static int32 GAICoreDefaultDepth = 5;
 static int32 GAICoreDefaultRootK = -1;
 static int32 GAICoreDefaultNodeK = -1;
+static AICore::ESearchEngine GAICoreDefaultEngine = AICore::ESearchEngine::AlphaBeta;
+static int32 GAICoreDefaultMultiPV = 1;
+static int32 GAICoreDefaultPickMargin = 0;
+static int64 GAICoreDefaultMaxNodes = 60000;
+static int32 GAICoreDefaultDifficulty = -1;     // last AICore.Difficulty preset (0 easy, 1 normal, 2 hard), -1 none
 
 //////////////////////////////////////////////////////////////////////////
 // CVars
@@ -55,6 +68,9 @@ static TAutoConsoleVariable<int32> CVarAICore_W_ThreatFor(TEXT("AICore.W_ThreatF
 static TAutoConsoleVariable<int32> CVarAICore_W_ThreatAgainst(TEXT("AICore.W_ThreatAgainst"), 35, TEXT("Weight: enemy threats against us"), ECVF_Default);
 static TAutoConsoleVariable<int32> CVarAICore_W_Cohesion(TEXT("AICore.W_Coh"), 2, TEXT("Weight: ally cohesion"), ECVF_Default);
 
+// Eval backend
+static TAutoConsoleVariable<int32> CVarAICore_EvalBackend(TEXT("AICore.EvalBackend"), 0, TEXT("Eval backend: 0=classic, 1=NNUE (falls back to classic if no net is loaded)"), ECVF_Default);
+
 // Ordering weights
 static TAutoConsoleVariable<int32> CVarAICore_OrderPos(TEXT("AICore.OrderPos"), 8, TEXT("Ordering weight: positional closeness"), ECVF_Default);
 static TAutoConsoleVariable<int32> CVarAICore_OrderThreat(TEXT("AICore.OrderThreat"), 6, TEXT("Ordering weight: threat-relief delta"), ECVF_Default);
@@ -64,25 +80,40 @@ static TAutoConsoleVariable<int32> CVarAICore_OrderEndTurnBias(TEXT("AICore.Orde
 
 // Options
 static TAutoConsoleVariable<int32> CVarAICore_QStrict(TEXT("AICore.QStrict"), 1, TEXT("Quiescence strict: 1=lethal or threat-relief attacks only"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_QSee(TEXT("AICore.QSee"), 1, TEXT("Quiescence: skip attacks that lose their static exchange, winning exchanges first"), ECVF_Default);
 static TAutoConsoleVariable<int32> CVarAICore_Dedup(TEXT("AICore.Dedup"), 1, TEXT("Action-order invariance dedup when topology changes"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_VerifyHash(TEXT("AICore.VerifyHash"), 0, TEXT("Debug: recompute the Zobrist key from scratch at every UTBG search node"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_EvalCache(TEXT("AICore.EvalCache"), 1, TEXT("Cache static evals by position key (shared lockless table)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_Symmetry(TEXT("AICore.Symmetry"), 1, TEXT("UTBG: share TT entries between mirror images of the position (classic eval only)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_Commute(TEXT("AICore.Commute"), 1, TEXT("UTBG: search only the canonical order of commuting same-turn actions"), ECVF_Default);
 
 // Logging
-static TAutoConsoleVariable<int32>   CVarAICore_LogSearch(TEXT("AICore.LogSearch"), 1, TEXT("Write a JSONL per AICore.Search"), ECVF_Default);
-static TAutoConsoleVariable<FString> CVarAICore_LogPath(TEXT("AICore.LogPath"), TEXT("AICore/search.jsonl"), TEXT("Relative path under Saved/"), ECVF_Default);
+static TAutoConsoleVariable<int32>   CVarAICore_LogSearch(TEXT("AICore.LogSearch"), 1, TEXT("Log every search (AICore.LogFormat/LogPath; written by a background thread)"), ECVF_Default);
 
 // Overlay
 static TAutoConsoleVariable<int32> CVarAICore_Overlay(TEXT("AICore.Overlay"), 1, TEXT("On-screen overlay after search"), ECVF_Default);
 
+// Engine (UTBG)
+static TAutoConsoleVariable<int32> CVarAICore_Engine(TEXT("AICore.Engine"), -1, TEXT("UTBG search engine: -1=difficulty default, 0=alphabeta, 1=mcts, 2=turn planner"), ECVF_Default);
+
 // Root tie-breaking epsilon-noise
 static TAutoConsoleVariable<int32> CVarAICore_Epsilon(TEXT("AICore.Epsilon"), 0, TEXT("Percent [0..100]: pick randomly within ROOT top tie group"), ECVF_Default);
 static TAutoConsoleVariable<int32> CVarAICore_NoiseSeed(TEXT("AICore.NoiseSeed"), 12345, TEXT("Deterministic RNG seed for root tie-breaking"), ECVF_Default);
 
+// Multi-PV (difficulty scaling / hints)
+static TAutoConsoleVariable<int32> CVarAICore_MultiPV(TEXT("AICore.MultiPV"), -1, TEXT("Root moves searched to a score of their own: -1=difficulty default, 1=best only"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_NodeBudget(TEXT("AICore.NodeBudget"), 0, TEXT("Search node budget: 0=wall clock (SoftMs/HardMs), -1=difficulty default, >0=nodes (deterministic)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_KingProofTurns(TEXT("AICore.KingProofTurns"), 2, TEXT("Before each search, try to prove a forced king kill within this many own turns (0=off)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_KingProofNodes(TEXT("AICore.KingProofNodes"), 5000, TEXT("King-kill proof search budget in positions"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_PickMargin(TEXT("AICore.PickMargin"), -1, TEXT("Bots pick among Multi-PV lines within this score of the best: -1=difficulty default, 0=always best"), ECVF_Default);
+
 // --- UTBG ׼ ڿȭ ---
 static FString ActionToString_UTBG(const Action& a)
 {
     switch (a.type) {
     case ActionType::Move:    return FString::Printf(TEXT("Move(%d->%d)"), a.actorId, a.tileIndex);
     case ActionType::Attack:  return FString::Printf(TEXT("Attack(%d->%d)"), a.actorId, a.targetId);
+    case ActionType::Skill:   return FString::Printf(TEXT("Skill(%d#%d->%d)"), a.actorId, (int32)a.skillId, a.targetId);
     case ActionType::EndTurn: return TEXT("EndTurn");
     case ActionType::Pass:    return FString::Printf(TEXT("Pass(%d)"), a.actorId);
     }
@@ -90,67 +121,66 @@ static FString ActionToString_UTBG(const Action& a)
 }
 
 //////////////////////////////////////////////////////////////////////////
-//  UTBG: PV  ϸ APȭ/EndTurn θ JSONL 
+//  UTBG search log: the PV replayed for the AP trace, queued for the log thread
 //////////////////////////////////////////////////////////////////////////
 
-static void WriteUTBGSearchLogJSONL(
-    const GameState& S0, const UTBGRules& R,
-    const std::vector<Action>& PV,
-    int bestScore, int maxDepth, int64 nodes, double ms)
+void AICore::LogUTBGSearch(GameState& S, const FUTBGSearchRequest& Req, const FUTBGSearchResult& Res, double QueueMs)
 {
-    // ۷ι ġ(AICore.LogSearch) 󰡱
-    extern TAutoConsoleVariable<int32> CVarAICore_LogSearch;
     if (CVarAICore_LogSearch.GetValueOnAnyThread() == 0) return;
-
-    GameState S = S0; // ϰ  
-    FString actionsJson; actionsJson.Reserve(512);
-
-    actionsJson += TEXT("[");
-    bool first = true;
-    for (const Action& a : PV)
+    SCOPE_CYCLE_COUNTER(STAT_AICore_LogWrite);
+
+    AICore::FSearchLogRecord Rec;
+    Rec.Kind = (uint8)AICore::ESearchLogKind::UTBG;
+    Rec.Engine = (uint8)Res.Engine;
+    Rec.TsMs = (uint64)(FDateTime::UtcNow().ToUnixTimestamp() * 1000LL);
+    Rec.Depth = Req.MaxDepth;
+    Rec.Nodes = Res.Nodes;
+    Rec.Ms = Res.Ms;
+    Rec.QueueMs = QueueMs;
+    Rec.Score = Res.Score;
+    Rec.TeamAPStart[0] = (int16)S.teamAP[0];
+    Rec.TeamAPStart[1] = (int16)S.teamAP[1];
+    Rec.SideStart = (uint8)S.sideToAct;
+    Rec.Difficulty = (int8)Req.Difficulty;
+    Rec.BoardW = (uint8)FMath::Min(S.width, 255);
+    Rec.BoardH = (uint8)FMath::Min(S.height, 255);
+    int32 alive = 0;
+    for (const Unit& u : S.units) alive += u.alive ? 1 : 0;
+    Rec.NumUnits = (uint8)FMath::Min(alive, 255);
+    if (Req.MaxNodes <= 0 || Res.Engine == AICore::ESearchEngine::MCTS)     // MCTS ignores MaxNodes
     {
-        UTBGDelta dx{};
-        R.make(S, a, dx); // (AP/ ó )
-
-        const int sideBefore = (int)dx.SideBefore;
-        const int ap0_before = (int)dx.APBefore[0];
-        const int ap1_before = (int)dx.APBefore[1];
-        const int ap0_after = S.teamAP[0];
-        const int ap1_after = S.teamAP[1];
-        const bool flipped = (dx.bFlippedTurn != 0);
-
-        if (!first) actionsJson += TEXT(",");
-        first = false;
-
-        actionsJson += FString::Printf(
-            TEXT("{\"act\":\"%s\",\"side\":%d,\"ap_before\":[%d,%d],\"ap_after\":[%d,%d],\"flipped\":%s}"),
-            *ActionToString_UTBG(a), sideBefore,
-            ap0_before, ap1_before,
-            ap0_after, ap1_after,
-            flipped ? TEXT("true") : TEXT("false")
-        );
-        // S   · (rollback ʿ)
-    }
-    actionsJson += TEXT("]");
-
-    //  
-    const FString rel = TEXT("AICore/utbg_search.jsonl"); //  
-    const FString dir = FPaths::Combine(FPaths::ProjectSavedDir(), FPaths::GetPath(rel));
-    const FString file = FPaths::Combine(FPaths::ProjectSavedDir(), rel);
-    IPlatformFile& PF = FPlatformFileManager::Get().GetPlatformFile();
-    if (!PF.DirectoryExists(*dir)) PF.CreateDirectoryTree(*dir);
-
-    const uint64 ts_ms = (uint64)(FDateTime::UtcNow().ToUnixTimestamp() * 1000LL);
-    const FString line = FString::Printf(
-        TEXT("{\"ts\":%llu,\"depth\":%d,\"nodes\":%lld,\"ms\":%.3f,\"score\":%d,")
-        TEXT("\"teamAP_start\":[%d,%d],\"side_start\":%d,")
-        TEXT("\"actions\":%s}\n"),
-        (unsigned long long)ts_ms, maxDepth, (long long)nodes, ms, bestScore,
-        S0.teamAP[0], S0.teamAP[1], S0.sideToAct,
-        *actionsJson
-    );
-
-    FFileHelper::SaveStringToFile(line, *file, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+        Rec.SoftMs = Req.SoftMs;
+        Rec.HardMs = Req.HardMs;
+    }
+    Rec.RootKey = S.key;
+    Rec.DepthReached = (uint8)FMath::Min((int32)Res.DepthMs.size(), 255);
+    for (int32 d = 0; d < FMath::Min((int32)Res.DepthMs.size(), AICore::FSearchLogRecord::kMaxDepths); ++d)
+        Rec.DepthMs[d] = (float)Res.DepthMs[d];
+
+    // replay in place (team AP and turn handling included), then restore S
+    UTBGRules R; R.TurnAP = Req.TurnAP;
+    const std::vector<Action>& PV = Res.PV;
+    const int32 n = FMath::Min((int32)PV.size(), AICore::FSearchLogRecord::kMaxSteps);
+    AICore::TScratch<UTBGDelta> deltas;
+    deltas->resize(n);
+    for (int32 i = 0; i < n; ++i)
+    {
+        UTBGDelta& dx = (*deltas)[i];
+        R.make(S, PV[i], dx);
+
+        AICore::FSearchLogRecord::FStep& step = Rec.Steps[i];
+        step.Move = Move::fromAction(PV[i]).code;
+        step.Side = dx.SideBefore;
+        step.bFlipped = dx.bFlippedTurn != 0;
+        step.APBefore[0] = dx.APBefore[0];
+        step.APBefore[1] = dx.APBefore[1];
+        step.APAfter[0] = (int16)S.teamAP[0];
+        step.APAfter[1] = (int16)S.teamAP[1];
+    }
+    for (int32 i = n - 1; i >= 0; --i) R.unmake(S, (*deltas)[i]);
+    Rec.NumSteps = (uint8)n;
+
+    AICore::SubmitSearchLog(Rec);
 }
 
 
@@ -180,6 +210,34 @@ static void EnsureTTValidityOnWeightsChange()
     }
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Eval backend (classic / NNUE)
+//////////////////////////////////////////////////////////////////////////
+
+static int32  GLastEvalBackend = 0;
+static uint32 GLastNNUEVersion = 0;
+
+// Attach the selected backend to S (NNUE accumulator refresh). TT is cleared when the backend or net changes.
+void AICore::AttachEvalBackend(GameState& S)
+{
+    const int32 backend = CVarAICore_EvalBackend.GetValueOnAnyThread();
+    S.refreshNNUE((backend == 1) ? AICore::GetNNUENetwork() : nullptr);
+
+    const int32 effective = S.nnue.Net ? 1 : 0;
+    const uint32 version = AICore::GetNNUENetworkVersion();
+    if (effective != GLastEvalBackend || (effective == 1 && version != GLastNNUEVersion))
+    {
+        GAICoreTT.ResizeMB(128);
+        GAICoreTT.ResizeMB(GAICoreTTSizeMB);
+        GAICoreEvalCache.Clear();   // a reloaded net can reuse the old one's address
+        UE_LOG(LogAICore, Log, TEXT("[TT] Cleared due to eval backend change (%s)"), effective ? TEXT("nnue") : TEXT("classic"));
+        GLastEvalBackend = effective;
+        GLastNNUEVersion = version;
+    }
+    if (backend == 1 && !S.nnue.Net)
+        UE_LOG(LogAICore, Warning, TEXT("[Eval] NNUE requested but no matching net (board=%d) -> classic"), S.boardSize());
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Small RNG (deterministic)
 //////////////////////////////////////////////////////////////////////////
@@ -192,22 +250,6 @@ static FORCEINLINE int RandRange(uint64& s, int n) {
     return (n > 0) ? int(XS64(s) % (uint64)n) : 0;
 }
 
-//////////////////////////////////////////////////////////////////////////
-// Time manager
-//////////////////////////////////////////////////////////////////////////
-
-struct FTimeBudget { int32 SoftMs = 300; int32 HardMs = 350; };
-
-class FTimeManager {
-    double StartS = 0.0;
-    FTimeBudget B;
-public:
-    void Start(const FTimeBudget& In) { B = In; StartS = FPlatformTime::Seconds(); }
-    FORCEINLINE double ElapsedMs() const { return (FPlatformTime::Seconds() - StartS) * 1000.0; }
-    FORCEINLINE bool SoftExpired() const { return ElapsedMs() >= B.SoftMs; }
-    FORCEINLINE bool HardExpired() const { return ElapsedMs() >= B.HardMs; }
-};
-
 //////////////////////////////////////////////////////////////////////////
 // Namespace
 //////////////////////////////////////////////////////////////////////////
@@ -216,20 +258,43 @@ namespace AICore {
 
     constexpr int  INF = 1000000000;
     constexpr int  kAttackDamage = 5;
+    constexpr int  kKingWinMin = KingWinScore - 1000;  // king-kill scores: KingWinScore - plies to the kill
+
+    // the TT keeps king-kill scores relative to the node, the search relative to the root
+    static FORCEINLINE int ScoreToTT(int Score, int Ply)
+    {
+        return (Score >= kKingWinMin) ? Score + Ply : (Score <= -kKingWinMin) ? Score - Ply : Score;
+    }
+    static FORCEINLINE int ScoreFromTT(int Score, int Ply)
+    {
+        return (Score >= kKingWinMin) ? Score - Ply : (Score <= -kKingWinMin) ? Score + Ply : Score;
+    }
 
     //////////////////////////////////////////////////////////////////////////
     // Params & Stats
     //////////////////////////////////////////////////////////////////////////
 
-    struct EvalWeights {
-        int HP = 100, Pos = 3, TFor = 25, TAgainst = 35, Coh = 2;
-    };
-    struct OrderWeights {
-        int Pos = 8;
-        int Threat = 6;
-        int Cost = 0;
-        int EndTurnBias = 0;
-    };
+    EvalWeights EvalWeightsFromCVars()
+    {
+        return EvalWeights{
+            CVarAICore_W_HP.GetValueOnAnyThread(),
+            CVarAICore_W_Pos.GetValueOnAnyThread(),
+            CVarAICore_W_ThreatFor.GetValueOnAnyThread(),
+            CVarAICore_W_ThreatAgainst.GetValueOnAnyThread(),
+            CVarAICore_W_Cohesion.GetValueOnAnyThread()
+        };
+    }
+
+    OrderWeights OrderWeightsFromCVars()
+    {
+        return OrderWeights{
+            CVarAICore_OrderPos.GetValueOnAnyThread(),
+            CVarAICore_OrderThreat.GetValueOnAnyThread(),
+            CVarAICore_OrderCost.GetValueOnAnyThread(),
+            CVarAICore_OrderEndTurnBias.GetValueOnAnyThread()
+        };
+    }
+
     struct SearchParams {
         FTimeBudget Budget{};
         int MaxDepth = 5;
@@ -237,8 +302,10 @@ namespace AICore {
         int NodeK = -1;
         bool Dedup = true;
         bool QStrict = true;
+        bool QSee = true;
         int  Epsilon = 0;
         int  NoiseSeed = 12345;
+        int  MultiPV = 1;
         int  AttackDamage = kAttackDamage;
         EvalWeights  E{};
         OrderWeights O{};
@@ -251,6 +318,9 @@ namespace AICore {
         int64 TTLower = 0;
         int64 TTUpper = 0;
         int64 QCalls = 0;
+        int64 DedupPruned = 0;
+        int64 SeePruned = 0;
+        FEvalCacheStats EvalCache{};
     };
 
     //////////////////////////////////////////////////////////////////////////
@@ -270,25 +340,21 @@ namespace AICore {
     // Utilities
     //////////////////////////////////////////////////////////////////////////
 
-    static FORCEINLINE int Manhattan(int a, int b, int W) {
-        const int ax = a % W, ay = a / W, bx = b % W, by = b / W;
-        return FMath::Abs(ax - bx) + FMath::Abs(ay - by);
-    }
-
     static FORCEINLINE uint64 KeyAfterFlip(const GameState& S) {
         return (S.key ^ S.Z.sideToAct[S.sideToAct] ^ S.Z.sideToAct[S.sideToAct ^ 1]);
     }
 
     static FORCEINLINE void FlipSide(GameState& S) {
-        S.key ^= S.Z.sideToAct[S.sideToAct];
+        S.xorSideToAct(S.sideToAct);
         S.sideToAct ^= 1;
-        S.key ^= S.Z.sideToAct[S.sideToAct];
+        S.xorSideToAct(S.sideToAct);
     }
 
-    // Is this attack lethal under the current damage model?
+    // Is this attack (or damage skill) lethal under the current damage model?
     static FORCEINLINE bool IsLethalAttack(const GameState& S, const Action& a, int fallbackDamage) {
-        if (a.type != ActionType::Attack || a.targetId < 0) return false;
-        const int dmg = (a.actorId >= 0 && a.actorId < (int)S.units.size() && S.units[a.actorId].attack > 0)
+        if ((a.type != ActionType::Attack && a.type != ActionType::Skill) || a.targetId < 0) return false;
+        const int dmg = (a.type == ActionType::Skill) ? S.damageOf(a)
+            : (a.actorId >= 0 && a.actorId < (int)S.units.size() && S.units[a.actorId].attack > 0)
             ? S.units[a.actorId].attack : fallbackDamage;
         return (S.units[a.targetId].hp - dmg) <= 0;
     }
@@ -316,22 +382,45 @@ namespace AICore {
     // Heuristics
     //////////////////////////////////////////////////////////////////////////
 
+    // Built once per position (and thread): the eval, quiescence filters and move ordering
+    // of a node share it. nullptr when the position has units outside teams 0/1.
+    static const FThreatMap* ThreatMapFor(const GameState& S)
+    {
+        static thread_local FThreatMap Map;
+        if (!Map.Matches(S)) Map.Build(S);
+        return Map.bTwoTeams ? &Map : nullptr;
+    }
+
     static int NearestEnemyDistFrom(const GameState& S, int tile, int myTeam) {
+        const FThreatMap* M = ThreatMapFor(S);
+        if (M && tile >= 0 && tile < S.boardSize() && (myTeam == 0 || myTeam == 1)) {
+            const int d = M->NearDist[myTeam ^ 1][tile];
+            return (d >= FThreatMap::kFar) ? 0 : d;
+        }
+
         int best = INT_MAX;
         for (const auto& e : S.units) {
             if (!e.alive || e.team == myTeam || e.tile < 0) continue;
-            best = FMath::Min(best, Manhattan(tile, e.tile, S.width));
+            best = FMath::Min(best, S.manhattan(tile, e.tile));
         }
         return (best == INT_MAX) ? 0 : best;
     }
 
+    // (a, b) pairs where a is within its attack range of b (line blocking ignored)
     static int CountAdjThreatPairs(const GameState& S, int teamA, int teamB) {
         int cnt = 0;
+        const FThreatMap* M = ThreatMapFor(S);
+        if (M && (teamA == 0 || teamA == 1)) {
+            for (const auto& ub : S.units)
+                if (ub.alive && ub.tile >= 0 && ub.team == teamB) cnt += M->Cover[teamA][ub.tile];
+            return cnt;
+        }
+
         for (const auto& ua : S.units) {
             if (!ua.alive || ua.tile < 0 || ua.team != teamA) continue;
             for (const auto& ub : S.units) {
                 if (!ub.alive || ub.tile < 0 || ub.team != teamB) continue;
-                if (Manhattan(ua.tile, ub.tile, S.width) == 1) ++cnt;
+                if (S.manhattan(ua.tile, ub.tile) <= ua.attackRange) ++cnt;
             }
         }
         return cnt;
@@ -341,7 +430,7 @@ namespace AICore {
         int best = INT_MAX;
         for (const auto& a : S.units) {
             if (!a.alive || a.tile < 0 || a.team != myTeam) continue;
-            const int d = Manhattan(tile, a.tile, S.width);
+            const int d = S.manhattan(tile, a.tile);
             if (d > 0) best = FMath::Min(best, d); // exclude self
         }
         return best;
@@ -357,8 +446,14 @@ namespace AICore {
         return sum;
     }
 
-    static int Eval(const GameState& S, const EvalWeights& W)
+    int Eval(const GameState& S, const EvalWeights& W)
     {
+        const int outcome = UTBGRules::outcome(S);
+        if (outcome != UTBGRules::kOngoing)
+            return (outcome == UTBGRules::kDraw) ? 0 : (outcome == S.sideToAct) ? KingWinScore : -KingWinScore;
+
+        if (S.nnue.Net) return NNUEEvaluate(S.nnue, S.sideToAct);
+
         const int me = S.sideToAct;
         const int them = me ^ 1;
         int score = 0;
@@ -387,24 +482,41 @@ namespace AICore {
         return score;
     }
 
+    int EvalCached(const GameState& S, const EvalWeights& W, FEvalCacheStats* Stats)
+    {
+        AICORE_SCOPE_CYCLE(STAT_AICore_Eval);
+        if (CVarAICore_EvalCache.GetValueOnAnyThread() == 0) return Eval(S, W);
+
+        // weights and backend are part of the entry's identity
+        uint64 k = S.key;
+        k ^= (uint64)(uint32)W.HP * 0x9E3779B97F4A7C15ULL;
+        k ^= (uint64)(uint32)W.Pos * 0xC2B2AE3D27D4EB4FULL;
+        k ^= (uint64)(uint32)W.TFor * 0x165667B19E3779F9ULL;
+        k ^= (uint64)(uint32)W.TAgainst * 0xD6E8FEB86659FD93ULL;
+        k ^= (uint64)(uint32)W.Coh * 0xFF51AFD7ED558CCDULL;
+        k ^= (uint64)(UPTRINT)S.nnue.Net * 0xC4CEB9FE1A85EC53ULL;
+
+        if (Stats) ++Stats->Probes;
+        int32 score;
+        if (GAICoreEvalCache.Probe(k, score)) {
+            if (Stats) ++Stats->Hits;
+            return score;
+        }
+        score = Eval(S, W);
+        GAICoreEvalCache.Store(k, score);
+        return score;
+    }
+
+    // enemies whose attack range covers tile (line blocking ignored)
     static int AdjacentEnemyCountAtTile(const GameState& S, int tile, int myTeam) {
         if (tile < 0) return 0;
-        const int W = S.width, H = S.height;
-        const int x = tile % W, y = tile / W;
-
-        auto ToIdx = [&](int tx, int ty)->int {
-            if (tx < 0 || ty < 0 || tx >= W || ty >= H) return -1;
-            return ty * W + tx;
-            };
+        const FThreatMap* M = ThreatMapFor(S);
+        if (M && tile < S.boardSize() && (myTeam == 0 || myTeam == 1)) return M->Cover[myTeam ^ 1][tile];
 
-        const int nb[4] = { ToIdx(x - 1,y), ToIdx(x + 1,y), ToIdx(x,y - 1), ToIdx(x,y + 1) };
         int cnt = 0;
-        for (int k = 0; k < 4; ++k) {
-            const int idx = nb[k];
-            if (idx < 0) continue;
-            for (const auto& u : S.units) {
-                if (u.alive && u.tile == idx && u.team != myTeam) { ++cnt; break; }
-            }
+        for (const auto& u : S.units) {
+            if (!u.alive || u.tile < 0 || u.team == myTeam) continue;
+            if (S.manhattan(u.tile, tile) <= u.attackRange) ++cnt;
         }
         return cnt;
     }
@@ -418,33 +530,140 @@ namespace AICore {
     }
 
     static int ThreatReliefForAttack(const GameState& S, const Action& a, int attackDamage) {
-        if (a.type != ActionType::Attack || a.targetId < 0) return 0;
+        if ((a.type != ActionType::Attack && a.type != ActionType::Skill) || a.targetId < 0) return 0;
         const auto& u = S.units[a.actorId];
         const auto& t = S.units[a.targetId];
         if (u.tile < 0 || t.tile < 0) return 0;
 
-        const bool adjacent = Manhattan(u.tile, t.tile, S.width) == 1;
+        // nothing of the target's team covers the attacker's tile
+        const FThreatMap* M = ThreatMapFor(S);
+        if (M && (t.team == 0 || t.team == 1) && M->Cover[t.team][u.tile] == 0) return 0;
+
+        const bool threatensUs = S.manhattan(u.tile, t.tile) <= t.attackRange;
         const bool lethal = IsLethalAttack(S, a, attackDamage);
-        return (adjacent && lethal) ? 1 : 0;
+        return (threatensUs && lethal) ? 1 : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Static exchange (team AP)
+    //////////////////////////////////////////////////////////////////////////
+
+    // HP taken off V by Dealt damage, plus V's attack (its threat) or KingWinScore when it dies
+    static FORCEINLINE int ExchangeHitValue(const Unit& V, int Dealt) {
+        if (Dealt < V.hp) return Dealt;
+        return V.hp + (V.king ? KingWinScore : V.attack);
+    }
+
+    // Best single hit the opponent of Side lands once the turn passes; the two best attackers are
+    // kept so a killed target can be dropped. Built on first use, shared by a node's attacks.
+    struct FCounterHits {
+        bool bReady = false;
+        int  Best = 0, BestBy = -1, Second = 0;
+
+        void Build(const GameState& S, int Side, int fallbackDamage) {
+            bReady = true;
+            for (const Unit& e : S.units) {
+                if (!e.alive || e.tile < 0 || e.team == Side || e.attackRange <= 0) continue;
+                const int dmg = (e.attack > 0) ? e.attack : fallbackDamage;
+                int hit = 0;
+                for (const Unit& u : S.units) {
+                    if (!u.alive || u.tile < 0 || u.team != Side) continue;
+                    if (S.manhattan(e.tile, u.tile) > e.attackRange) continue;
+                    hit = FMath::Max(hit, ExchangeHitValue(u, dmg));
+                }
+                if (hit > Best) { Second = Best; Best = hit; BestBy = e.id; }
+                else if (hit > Second) Second = hit;
+            }
+        }
+        int Without(int Dead) const { return (Dead >= 0 && Dead == BestBy) ? Second : Best; }
+    };
+
+    // Static exchange of an attack/skill for its side, in HP points (kills add the victim's attack,
+    // kings KingWinScore): the hit and our best follow-up hits on the target while APBudget (team AP
+    // before the action; 0 = the turn passes after it) lasts. A kill also takes the target's hit back
+    // off the opponent's best counter-hit; the counter-hits it leaves are there whether we attack or
+    // not, so they are not charged. Best stopping point; reach is Manhattan (blockers ignored).
+    static int StaticExchange(const GameState& S, const Action& a, int APBudget, int fallbackDamage, int fallbackCost, FCounterHits& Counter)
+    {
+        if ((a.type != ActionType::Attack && a.type != ActionType::Skill) || a.targetId < 0 || a.actorId < 0) return 0;
+        const Unit& A = S.units[a.actorId];
+        const Unit& T = S.units[a.targetId];
+        if (!T.alive || T.tile < 0) return 0;
+
+        const int side = A.team;
+        const bool bEnemy = (T.team != side);
+        const bool bEndsTurn = (a.type == ActionType::Skill && a.skillId < A.numSkills && A.skills[a.skillId].endsTurn);
+        int budget = bEndsTurn ? 0 : APBudget - (int)a.apCost;
+
+        // cheapest damage per AP among our units reaching T; the actor may hit again
+        int pileDmg = 0, pileCost = 0;
+        if (bEnemy) {
+            for (const Unit& u : S.units) {
+                if (!u.alive || u.tile < 0 || u.team != side || u.attackRange <= 0) continue;
+                if (S.manhattan(u.tile, T.tile) > u.attackRange) continue;
+                const int dmg = (u.attack > 0) ? u.attack : fallbackDamage;
+                const int cost = (u.attackCost > 0) ? u.attackCost : fallbackCost;
+                if (pileCost == 0 || dmg * pileCost > pileDmg * cost) { pileDmg = dmg; pileCost = cost; }
+            }
+        }
+
+        int dealt = (a.type == ActionType::Skill) ? S.damageOf(a)
+            : (A.attack > 0) ? A.attack : fallbackDamage;
+        int best = std::numeric_limits<int>::min();
+        for (;;) {
+            const bool bKilled = dealt >= T.hp;
+            int value = ExchangeHitValue(T, dealt) * (bEnemy ? 1 : -1);
+            if (bKilled && bEnemy) {
+                if (!Counter.bReady) Counter.Build(S, side, fallbackDamage);
+                value += Counter.Best - Counter.Without(T.id);
+            }
+            best = FMath::Max(best, value);
+
+            if (bKilled || pileCost == 0 || budget < pileCost) break;
+            budget -= pileCost;
+            dealt += pileDmg;
+        }
+        return best;
+    }
+
+    // Drops attacks with a losing exchange; the rest go winning-first, stable over the incoming order
+    static int FilterByExchange(const GameState& S, std::vector<Action>& mv, int APBudget, int fallbackDamage, int fallbackCost)
+    {
+        thread_local std::vector<std::pair<int, int>> Scored;   // (exchange, index)
+        Scored.clear();
+        FCounterHits Counter;
+        for (int i = 0; i < (int)mv.size(); ++i) {
+            const int see = StaticExchange(S, mv[i], APBudget, fallbackDamage, fallbackCost, Counter);
+            if (see >= 0) Scored.emplace_back(see, i);
+        }
+        const int pruned = (int)mv.size() - (int)Scored.size();
+        if (pruned == 0 && Scored.size() < 2) return 0;
+
+        std::stable_sort(Scored.begin(), Scored.end(), [](const std::pair<int, int>& x, const std::pair<int, int>& y) { return x.first > y.first; });
+        thread_local std::vector<Action> Kept;
+        Kept.clear();
+        for (const auto& e : Scored) Kept.push_back(mv[e.second]);
+        mv.assign(Kept.begin(), Kept.end());     // keeps mv's buffer (TScratch leases)
+        return pruned;
     }
 
     //////////////////////////////////////////////////////////////////////////
     // Move ordering
     //////////////////////////////////////////////////////////////////////////
 
-    static int ScoreActionForOrdering(const GameState& S, const Action& a, const OrderWeights& OW, int fallbackDamage)
+    int ScoreActionForOrdering(const GameState& S, const Action& a, const OrderWeights& OW, int fallbackDamage)
     {
         int sc = 0;
 
-        if (a.type == ActionType::Attack && a.targetId >= 0) 
+        if ((a.type == ActionType::Attack || a.type == ActionType::Skill) && a.targetId >= 0) 
         {
             const auto& t = S.units[a.targetId];
-            const int dmg = FMath::Clamp(
-                (a.actorId >= 0 && a.actorId < (int)S.units.size() && S.units[a.actorId].attack > 0)
+            const int dmg = FMath::Clamp((a.type == ActionType::Skill) ? S.damageOf(a)
+                : (a.actorId >= 0 && a.actorId < (int)S.units.size() && S.units[a.actorId].attack > 0)
                 ? S.units[a.actorId].attack : fallbackDamage, 0, t.hp);
             const int remaining = t.hp - dmg;
 
-            if (t.hp - dmg <= 0) sc += 5000;           // Ȯ ų ֿ켱
+            if (t.hp - dmg <= 0) sc += t.king ? 20000 : 5000; // Ȯ ų ֿ켱
             sc += dmg * 10;                            //  ط ʽ
             sc += ThreatReliefForAttack(S, a, dmg > 0 ? dmg : fallbackDamage) * OW.Threat;
         }
@@ -472,59 +691,58 @@ namespace AICore {
         return sc;
     }
 
-    static void SortActionsDeterministic(const GameState& S, std::vector<Action>& moves, const OrderWeights& OW, int attackDamage)
+    void SortActionsDeterministic(const GameState& S, std::vector<Action>& moves, const OrderWeights& OW, int attackDamage)
     {
-        std::stable_sort(moves.begin(), moves.end(), [&](const Action& A, const Action& B) {
-            const int sa = ScoreActionForOrdering(S, A, OW, attackDamage);
-            const int sb = ScoreActionForOrdering(S, B, OW, attackDamage);
-            if (sa != sb) return sa > sb;
-            return A.signature() < B.signature();
+        struct FKeyed { int Score; Move Packed; Action A; };
+        static thread_local std::vector<FKeyed> keyed;
+        keyed.clear();
+        keyed.reserve(moves.size());
+        for (const Action& a : moves) keyed.push_back({ ScoreActionForOrdering(S, a, OW, attackDamage), Move::fromAction(a), a });
+
+        // equal codes only for duplicate actions, so the order is still deterministic
+        std::sort(keyed.begin(), keyed.end(), [](const FKeyed& A, const FKeyed& B) {
+            if (A.Score != B.Score) return A.Score > B.Score;
+            return A.Packed < B.Packed;
             });
+        for (size_t i = 0; i < keyed.size(); ++i) moves[i] = keyed[i].A;
     }
 
-    static void PreferBestMove(std::vector<Action>& mv, const Action& best)
+    const Action* FindAction(const std::vector<Action>& moves, Move m)
     {
-        if (best.actorId < 0) return;
-        auto it = std::find_if(mv.begin(), mv.end(), [&](const Action& x) {
-            return x.signature() == best.signature();
-            });
+        for (const Action& a : moves) if (Move::fromAction(a) == m) return &a;
+        return nullptr;
+    }
+
+    static void PreferBestMove(std::vector<Action>& mv, Move best)
+    {
+        if (best.actorId() < 0) return;
+        auto it = std::find_if(mv.begin(), mv.end(), [best](const Action& x) { return Move::fromAction(x) == best; });
         if (it != mv.end()) std::iter_swap(mv.begin(), it);
     }
 
     //////////////////////////////////////////////////////////////////////////
-    // Logging (JSONL)
+    // Logging (queued for the log thread, AICoreSearchLog)
     //////////////////////////////////////////////////////////////////////////
 
-    static void WriteSearchLogJSONL(
+    static void LogSearch(
         int depth, int64 nodes, double ms, int bestScore, const std::vector<Action>& pv, const EvalWeights& W)
     {
         if (CVarAICore_LogSearch.GetValueOnAnyThread() == 0) return;
-
-        const FString rel   = CVarAICore_LogPath.GetValueOnAnyThread();
-        const FString dir   = FPaths::Combine(FPaths::ProjectSavedDir(), FPaths::GetPath(rel));
-        const FString file  = FPaths::Combine(FPaths::ProjectSavedDir(), rel);
-        IPlatformFile& PF   = FPlatformFileManager::Get().GetPlatformFile();
-        if (!PF.DirectoryExists(*dir)) PF.CreateDirectoryTree(*dir);
-
-        // Serialize PV
-        FString pvText; pvText.Reserve(256);
-        for (size_t i = 0; i < pv.size(); ++i) {
-            const Action& a = pv[i];
-            if (a.type == ActionType::Move)   pvText += FString::Printf(TEXT("Move(%d->%d)"), a.actorId, a.tileIndex);
-            else if (a.type == ActionType::Attack) pvText += FString::Printf(TEXT("Attack(%d->%d)"), a.actorId, a.targetId);
-            else                                 pvText += FString::Printf(TEXT("Pass(%d)"), a.actorId);
-            if (i + 1 < pv.size()) pvText += TEXT(" -> ");
-        }
-
-        const uint64 ts_ms = (uint64)(FDateTime::UtcNow().ToUnixTimestamp() * 1000LL);
-        const FString line = FString::Printf(
-            TEXT("{\"ts\":%llu,\"depth\":%d,\"nodes\":%lld,\"ms\":%.3f,\"score\":%d,")
-            TEXT("\"W_HP\":%d,\"W_Pos\":%d,\"W_TFor\":%d,\"W_TAgainst\":%d,\"W_Coh\":%d,")
-            TEXT("\"pv\":\"%s\"}\n"),
-            (unsigned long long)ts_ms, depth, (long long)nodes, ms, bestScore,
-            W.HP, W.Pos, W.TFor, W.TAgainst, W.Coh, *pvText);
-
-        FFileHelper::SaveStringToFile(line, *file, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+        SCOPE_CYCLE_COUNTER(STAT_AICore_LogWrite);
+
+        FSearchLogRecord Rec;
+        Rec.Kind = (uint8)ESearchLogKind::Search;
+        Rec.TsMs = (uint64)(FDateTime::UtcNow().ToUnixTimestamp() * 1000LL);
+        Rec.Depth = depth;
+        Rec.Nodes = nodes;
+        Rec.Ms = ms;
+        Rec.Score = bestScore;
+        Rec.Weights[0] = (int16)W.HP; Rec.Weights[1] = (int16)W.Pos; Rec.Weights[2] = (int16)W.TFor;
+        Rec.Weights[3] = (int16)W.TAgainst; Rec.Weights[4] = (int16)W.Coh;
+        Rec.NumSteps = (uint8)FMath::Min((int32)pv.size(), FSearchLogRecord::kMaxSteps);
+        for (int32 i = 0; i < Rec.NumSteps; ++i) Rec.Steps[i].Move = Move::fromAction(pv[i]).code;
+
+        SubmitSearchLog(Rec);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -534,13 +752,14 @@ namespace AICore {
     static int Quiescence(GameState& S, int alpha, int beta, SearchCtx& Ctx)
     {
         Ctx.Stats.QCalls++;
-        if (Ctx.TM->HardExpired()) return Eval(S, Ctx.P->E);
+        if (Ctx.TM->HardExpired()) return EvalCached(S, Ctx.P->E, &Ctx.Stats.EvalCache);
 
-        int stand = Eval(S, Ctx.P->E);
+        int stand = EvalCached(S, Ctx.P->E, &Ctx.Stats.EvalCache);
         if (stand >= beta) return beta;
         if (stand > alpha) alpha = stand;
 
-        std::vector<Action> mv;
+        TScratch<Action> mvBuf;
+        std::vector<Action>& mv = *mvBuf;
         Ctx.Rules->generateLegal(S, mv);
 
         // keep only attacks
@@ -558,6 +777,8 @@ namespace AICore {
         if (mv.empty()) return alpha;
 
         SortActionsDeterministic(S, mv, Ctx.P->O, Ctx.P->AttackDamage);
+        // per-unit AP: every attack here hands the turn over (FlipSide)
+        if (Ctx.P->QSee) Ctx.Stats.SeePruned += FilterByExchange(S, mv, 0, Ctx.P->AttackDamage, 1);
 
         for (const auto& a : mv) {
             if (S.units[a.actorId].ap < a.apCost) continue;
@@ -582,18 +803,27 @@ namespace AICore {
 
     static int AlphaBeta(GameState& S, int depth, int alpha, int beta, SearchCtx& Ctx, std::vector<Action>& outPV)
     {
-        if (Ctx.TM->HardExpired()) return Eval(S, Ctx.P->E);
+        if (Ctx.TM->HardExpired()) return EvalCached(S, Ctx.P->E, &Ctx.Stats.EvalCache);
 
         const int alphaOrig = alpha;
 
         // TT probe
         TTEntry ent;
-        const bool haveTT = (Ctx.TT && Ctx.TT->Probe(S.key, ent));
+        bool haveTT = false;
+        if (Ctx.TT) {
+            AICORE_SCOPE_CYCLE(STAT_AICore_TTProbe);
+            haveTT = Ctx.TT->Probe(S.key, ent);
+        }
         if (haveTT && ent.Depth >= depth) {
             Ctx.Stats.TTHits++;
             if (ent.Bound == ETTBound::Exact) {
                 Ctx.Stats.TTExact++;
-                outPV.clear(); outPV.push_back(ent.BestMove);
+                outPV.clear();
+                if (!ent.BestMove.isNone()) {
+                    TScratch<Action> mv;
+                    Ctx.Rules->generateLegal(S, *mv);
+                    if (const Action* a = FindAction(*mv, ent.BestMove)) outPV.push_back(*a);
+                }
                 return ent.Score;
             }
             if (ent.Bound == ETTBound::Lower && ent.Score >= beta) { Ctx.Stats.TTLower++; return ent.Score; }
@@ -602,7 +832,8 @@ namespace AICore {
 
         if (depth == 0) return Quiescence(S, alpha, beta, Ctx);
 
-        std::vector<Action> mv;
+        TScratch<Action> mvBuf, bestPVBuf;
+        std::vector<Action>& mv = *mvBuf;
         Ctx.Rules->generateLegal(S, mv);
 
         // prune illegal by AP
@@ -610,37 +841,34 @@ namespace AICore {
             return S.units[a.actorId].ap < a.apCost;
             }), mv.end());
 
-        if (mv.empty()) return Eval(S, Ctx.P->E);
+        if (mv.empty()) return EvalCached(S, Ctx.P->E, &Ctx.Stats.EvalCache);
 
         SortActionsDeterministic(S, mv, Ctx.P->O, Ctx.P->AttackDamage);
-        if (haveTT && ent.BestMove.actorId != -1) PreferBestMove(mv, ent.BestMove);
+        if (haveTT) PreferBestMove(mv, ent.BestMove);
 
         if (Ctx.P->NodeK > 0 && (int)mv.size() > Ctx.P->NodeK)
             mv.resize(Ctx.P->NodeK);
 
         const bool bDedup = Ctx.P->Dedup;
-        std::vector<uint64> seenChildKeys; if (bDedup) seenChildKeys.reserve(mv.size());
+        FChildKeySet seenChildKeys; if (bDedup) seenChildKeys.Reset((int32)mv.size());
 
         int best = std::numeric_limits<int>::min();
-        std::vector<Action> bestPV;
+        std::vector<Action>& bestPV = *bestPVBuf;
 
         for (const auto& a : mv) {
             FScopedMake guard(*Ctx.Rules, S, a);
 
             bool skip = false;
             if (bDedup && (a.type == ActionType::Move || IsLethalAttack(S, a, Ctx.P->AttackDamage))) {
-                const uint64 childKeyPostFlip = KeyAfterFlip(S);
-                if (std::find(seenChildKeys.begin(), seenChildKeys.end(), childKeyPostFlip) != seenChildKeys.end())
-                    skip = true;
-                else
-                    seenChildKeys.push_back(childKeyPostFlip);
+                if (!seenChildKeys.Insert(KeyAfterFlip(S))) { skip = true; Ctx.Stats.DedupPruned++; }
             }
 
             if (!skip) {
                 FlipSide(S);
                 Ctx.Stats.Nodes++;
 
-                std::vector<Action> childPV;
+                TScratch<Action> childPVBuf;
+                std::vector<Action>& childPV = *childPVBuf;
                 const int sc = -AlphaBeta(S, depth - 1, -beta, -alpha, Ctx, childPV);
 
                 FlipSide(S);
@@ -665,14 +893,44 @@ namespace AICore {
             if (best <= alphaOrig)      b = ETTBound::Upper;
             else if (best >= beta)      b = ETTBound::Lower;
 
-            const Action storeBest = bestPV.empty() ? Action{} : bestPV.front();
+            const Move storeBest = bestPV.empty() ? Move{} : Move::fromAction(bestPV.front());
+            AICORE_SCOPE_CYCLE(STAT_AICore_TTStore);
             Ctx.TT->Store(S.key, (int16)depth, best, b, storeBest, Ctx.Age);
         }
 
-        outPV = std::move(bestPV);
+        outPV.assign(bestPV.begin(), bestPV.end());
         return best;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    // Multi-PV root lines
+    //////////////////////////////////////////////////////////////////////////
+
+    // Root window: once MultiPV lines are known only a move beating the last one matters.
+    // One below its score, so equal scores still come back exact for the signature tie-break.
+    static FORCEINLINE int RootAlpha(const std::vector<FRootLine>& Lines, int MultiPV)
+    {
+        return ((int)Lines.size() >= MultiPV) ? Lines.back().Score - 1 : -INF;
+    }
+
+    // Keeps Lines sorted by score (desc), then first-move signature (asc), at most MultiPV long.
+    static void InsertRootLine(std::vector<FRootLine>& Lines, int MultiPV,
+        int Score, const Action& A, const std::vector<Action>& ChildPV)
+    {
+        const uint64 sig = A.signature();
+        auto it = Lines.begin();
+        while (it != Lines.end() && (it->Score > Score || (it->Score == Score && it->PV.front().signature() < sig))) ++it;
+        if (it - Lines.begin() >= MultiPV) return;
+
+        FRootLine L;
+        L.Score = Score;
+        L.PV.reserve(ChildPV.size() + 1);
+        L.PV.push_back(A);
+        L.PV.insert(L.PV.end(), ChildPV.begin(), ChildPV.end());
+        Lines.insert(it, std::move(L));
+        if ((int)Lines.size() > MultiPV) Lines.pop_back();
+    }
+
     //////////////////////////////////////////////////////////////////////////
     // Root (IDDFS + PW + dedup)
     //////////////////////////////////////////////////////////////////////////
@@ -680,7 +938,8 @@ namespace AICore {
     static void SearchRoot_IDDFS(
         GameState& S, BasicRules& R,
         const SearchParams& P,
-        std::vector<Action>& OutPV, int& OutScore, int64& OutNodes, double& OutMs)
+        std::vector<Action>& OutPV, int& OutScore, int64& OutNodes, double& OutMs,
+        std::vector<FRootLine>* OutLines = nullptr)
     {
         if (!GAICoreTT.IsReady()) {
             GAICoreTT.ResizeMB(64);
@@ -689,6 +948,7 @@ namespace AICore {
 
         FTimeManager TM; TM.Start(P.Budget);
         SearchCtx Ctx{ &R, &TM, &GAICoreTT, 0, {}, &P };
+        TM.CountNodes(&Ctx.Stats.Nodes);
 
         std::vector<Action> rootMoves;
         R.generateLegal(S, rootMoves);
@@ -724,18 +984,17 @@ namespace AICore {
             }
         }
 
-        int bestScore = std::numeric_limits<int>::min();
-        std::vector<Action> bestPV;
+        const int MultiPV = FMath::Max(1, P.MultiPV);
+        std::vector<FRootLine> bestLines;
 
         for (int depth = 1; depth <= P.MaxDepth; ++depth) {
             if (TM.SoftExpired()) break;
             Ctx.Age = (uint16)depth;
 
-            int iterBest = std::numeric_limits<int>::min();
-            std::vector<Action> iterPV;
+            std::vector<FRootLine> iterLines;
 
             const bool bDedup = P.Dedup;
-            std::vector<uint64> seenChildKeysRoot; if (bDedup) seenChildKeysRoot.reserve(rootMoves.size());
+            FChildKeySet seenChildKeysRoot; if (bDedup) seenChildKeysRoot.Reset((int32)rootMoves.size());
 
             for (const auto& a : rootMoves) {
                 if (TM.SoftExpired()) break;
@@ -744,52 +1003,44 @@ namespace AICore {
 
                 bool skip = false;
                 if (bDedup && (a.type == ActionType::Move || IsLethalAttack(S, a, P.AttackDamage))) {
-                    const uint64 childKeyPostFlip = KeyAfterFlip(S);
-                    if (std::find(seenChildKeysRoot.begin(), seenChildKeysRoot.end(), childKeyPostFlip) != seenChildKeysRoot.end())
-                        skip = true;
-                    else
-                        seenChildKeysRoot.push_back(childKeyPostFlip);
+                    if (!seenChildKeysRoot.Insert(KeyAfterFlip(S))) { skip = true; Ctx.Stats.DedupPruned++; }
                 }
 
                 if (!skip) {
                     FlipSide(S);
                     std::vector<Action> childPV;
-                    const int sc = -AlphaBeta(S, depth - 1, -INF, +INF, Ctx, childPV);
+                    const int alpha = RootAlpha(iterLines, MultiPV);
+                    const int sc = -AlphaBeta(S, depth - 1, -INF, -alpha, Ctx, childPV);
                     FlipSide(S);
 
-                    if (sc > iterBest ||
-                        (sc == iterBest && a.signature() < (iterPV.empty() ? ~0ULL : iterPV.front().signature())))
-                    {
-                        iterBest = sc;
-                        iterPV.clear(); iterPV.push_back(a);
-                        iterPV.insert(iterPV.end(), childPV.begin(), childPV.end());
-                    }
+                    // sc <= alpha is only an upper bound: the move is not among the best MultiPV
+                    if (sc > alpha) InsertRootLine(iterLines, MultiPV, sc, a, childPV);
                 }
                 // unmake by guard dtor
             }
 
-            if (!iterPV.empty()) { bestScore = iterBest; bestPV = iterPV; }
+            if (!iterLines.empty()) bestLines = std::move(iterLines);
 
             // reorder root with last best
-            if (!bestPV.empty()) {
-                const uint64 sig = bestPV.front().signature();
-                std::stable_sort(rootMoves.begin(), rootMoves.end(), [&](const Action& A, const Action& B) {
-                    if (A.signature() == sig) return true;
-                    if (B.signature() == sig) return false;
-                    const int sa = ScoreActionForOrdering(S, A, P.O, P.AttackDamage);
-                    const int sb = ScoreActionForOrdering(S, B, P.O, P.AttackDamage);
-                    if (sa != sb) return sa > sb;
-                    return A.signature() < B.signature();
-                    });
+            if (!bestLines.empty()) {
+                SortActionsDeterministic(S, rootMoves, P.O, P.AttackDamage);
+                const Move best = Move::fromAction(bestLines.front().PV.front());
+                auto it = std::find_if(rootMoves.begin(), rootMoves.end(), [best](const Action& a) { return Move::fromAction(a) == best; });
+                if (it != rootMoves.end()) std::rotate(rootMoves.begin(), it, it + 1);
             }
         }
 
-        OutPV = bestPV;
-        OutScore = bestScore;
+        OutPV = bestLines.empty() ? std::vector<Action>{} : bestLines.front().PV;
+        OutScore = bestLines.empty() ? std::numeric_limits<int>::min() : bestLines.front().Score;
+        if (OutLines) *OutLines = bestLines;
         OutNodes = Ctx.Stats.Nodes;
         OutMs = TM.ElapsedMs();
+        INC_DWORD_STAT_BY(STAT_AICore_Nodes, (uint32)OutNodes);
+
+        UE_LOG(LogAICore, Verbose, TEXT("[Search] dedupPruned=%lld seePruned=%lld evalCache=%.1f%% of %lld"),
+            (long long)Ctx.Stats.DedupPruned, (long long)Ctx.Stats.SeePruned, Ctx.Stats.EvalCache.HitRate() * 100.0, (long long)Ctx.Stats.EvalCache.Probes);
 
-        WriteSearchLogJSONL(P.MaxDepth, OutNodes, OutMs, OutScore, OutPV, P.E);
+        LogSearch(P.MaxDepth, OutNodes, OutMs, OutScore, OutPV, P.E);
     }
 
 } // namespace AICore
@@ -801,207 +1052,924 @@ namespace AICore {
 
 namespace {
 
-    // ø RAII (Delta Ÿ ܺο ѱ  ְ)
-    template<typename TRules, typename TDelta>
-    struct FScopedMakeT {
-        TRules& R;
-        GameState& S;
-        TDelta     D{};
-        bool       Active{ false };
-
-        FScopedMakeT(TRules& InR, GameState& InS, const Action& A) : R(InR), S(InS) {
-            R.make(S, A, D); Active = true;
-        }
-        ~FScopedMakeT() { if (Active) R.unmake(S, D); }
-        void Release() { Active = false; }
-    };
-
     struct SearchCtxUTBG {
         FTimeManager* TM = nullptr;
-        TTable* TT = nullptr;   // ʿϸ nullptr  TT ̻
+        TTable* TT = nullptr;   // nullptr = no TT
         int64         Nodes = 0;
+        int64         TTProbes = 0;
         int64         TTHits = 0;
+        int64         TTHitsByBound[3] = {};    // TTHits by ETTBound
+        int64         Cutoffs = 0;              // beta cutoffs, main search and quiescence
+        int64         Iterations = 0;           // root iterations started
+        int64         DedupPruned = 0;
+        int64         CommutePruned = 0;
+        int64         SeePruned = 0;
+        int64         HashErrors = 0;   // AICore.VerifyHash mismatches
+        bool          bVerifyHash = false;
+        AICore::FEvalCacheStats EvalCache;
     };
 
-    static int Quiescence_UTBG(GameState& S, int alpha, int beta,
-        UTBGRules& R, SearchCtxUTBG& Ctx)
+    static void VerifyKeyUTBG(const GameState& S, SearchCtxUTBG& Ctx, const TCHAR* Where)
     {
-        if (Ctx.TM->HardExpired()) return AICore::Eval(S, {
-            CVarAICore_W_HP.GetValueOnAnyThread(),
-            CVarAICore_W_Pos.GetValueOnAnyThread(),
-            CVarAICore_W_ThreatFor.GetValueOnAnyThread(),
-            CVarAICore_W_ThreatAgainst.GetValueOnAnyThread(),
-            CVarAICore_W_Cohesion.GetValueOnAnyThread()
-            });
+        const uint64 full = S.computeKey();
+        if (full != S.key && Ctx.HashErrors++ == 0)
+            UE_LOG(LogAICore, Error, TEXT("[VerifyHash] %s: incremental=0x%016llX full=0x%016llX"),
+                Where, (unsigned long long)S.key, (unsigned long long)full);
 
-        int stand = AICore::Eval(S, {
-            CVarAICore_W_HP.GetValueOnAnyThread(),
-            CVarAICore_W_Pos.GetValueOnAnyThread(),
-            CVarAICore_W_ThreatFor.GetValueOnAnyThread(),
-            CVarAICore_W_ThreatAgainst.GetValueOnAnyThread(),
-            CVarAICore_W_Cohesion.GetValueOnAnyThread()
-            });
+        for (int s = 0; S.sym && s < S.sym->count; ++s)
+        {
+            const uint64 image = S.computeKey(&S.sym->t[s]);
+            if (image != S.symKey[s] && Ctx.HashErrors++ == 0)
+                UE_LOG(LogAICore, Error, TEXT("[VerifyHash] %s: mirror image %d incremental=0x%016llX full=0x%016llX"),
+                    Where, s, (unsigned long long)S.symKey[s], (unsigned long long)image);
+        }
+    }
 
-        if (stand >= beta) return beta;
-        if (stand > alpha) alpha = stand;
+    //////////////////////////////////////////////////////////////////////////
+    // UTBG alpha-beta (IDDFS root + PVS-less negamax + quiescence) as an explicit-stack machine.
+    //
+    // One Run() call advances it until the search ends or the slice runs out; the state
+    // (frames, made actions, root iteration) stays on the machine between calls. The blocking
+    // search is a single unbounded Run(), the incremental one (FIncrementalSearchUTBG) many
+    // bounded ones: both visit the same nodes in the same order and check the same clock, which
+    // only advances while Run() is active, so equal budgets give equal results.
+    //
+    // Scores are relative to the side to act. With team AP the same side often acts again:
+    // only a turn flip negates the child's score (and mirrors the window).
+    //////////////////////////////////////////////////////////////////////////
 
-        std::vector<Action> mv;
-        R.generateLegal(S, mv);
-        mv.erase(std::remove_if(mv.begin(), mv.end(),
-            [](const Action& a) { return a.type != ActionType::Attack; }), mv.end());
+    // Interior-node move picker stages. Each stage is generated only when the previous ones failed
+    // to cut: most cutoffs come from the TT move or a capture, before any quiet move is generated.
+    enum EPickStage : int { PickTT, PickAttacks, PickKillers, PickQuiets, PickEndTurn, PickDone };
 
-        if (mv.empty()) return alpha;
+    struct FABFrame
+    {
+        bool   bQuiescence = false;
+        int    Depth = 0;
+        int    Alpha = 0;
+        int    Beta = 0;
+        int    AlphaOrig = 0;
+        int    Best = 0;
+        std::vector<Action> Moves;          // current stage's actions (every action when not staged)
+        size_t Next = 0;
+        std::vector<Action> BestPV;
+
+        int    Stage = PickDone;
+        int    Ply = 0;                     // frame index, for the killer slots
+        int32  Generated = 0;               // actions handed out by all stages so far
+        Move   TTMove;
+        Move   Yielded[3];                  // TT move/killers, skipped by the generated stages
+        int    NumYielded = 0;
+
+        bool   bDedup = false;
+        bool   bCommute = false;
+        bool   bCommutePruned = false;
+        AICore::FActionFootprint Prev;     // same side's previous action (bCommute only)
+        FChildKeySet Seen;
+
+        // child being searched
+        bool      bChildActive = false;
+        Action    Child;
+        AICore::FActionFootprint ChildFp;
+        UTBGDelta ChildDelta;
+    };
 
-        AICore::SortActionsDeterministic(
-            S, mv,
-            AICore::OrderWeights{
-                CVarAICore_OrderPos.GetValueOnAnyThread(),
-                CVarAICore_OrderThreat.GetValueOnAnyThread(),
-                CVarAICore_OrderCost.GetValueOnAnyThread(),
-                CVarAICore_OrderEndTurnBias.GetValueOnAnyThread()
-            },
-            /*attackDamage*/5);
-
-        for (const auto& a : mv)
+    class FAlphaBetaUTBG
+    {
+    public:
+        FAlphaBetaUTBG(GameState& InS, const AICore::FUTBGSearchRequest& Req)
+            : S(InS), MaxDepth(Req.MaxDepth), MultiPV(FMath::Max(1, Req.MultiPV))
         {
-            FScopedMakeT<UTBGRules, UTBGDelta> guard(R, S, a);
-            ++Ctx.Nodes;
+            R.TurnAP = Req.TurnAP;
+            if (!Req.TT && !GAICoreTT.IsReady()) { GAICoreTT.ResizeMB(64); }
+            TM.Start(FTimeBudget{ Req.SoftMs, Req.HardMs, Req.MaxNodes });
+            TM.Pause();         // the clock runs only inside Run(), like between slices
+            TM.CountNodes(&Ctx.Nodes);
+            Ctx.TM = &TM;
+            Ctx.TT = Req.TT ? Req.TT : &GAICoreTT;
+            Ctx.bVerifyHash = (CVarAICore_VerifyHash.GetValueOnAnyThread() != 0);
+            EW = AICore::EvalWeightsFromCVars();
+            OW = AICore::OrderWeights{ CVarAICore_OrderPos.GetValueOnAnyThread(), CVarAICore_OrderThreat.GetValueOnAnyThread() };
+            QW = AICore::OrderWeightsFromCVars();
+            NodeK = GAICoreDefaultNodeK;
+            bDedupOn = (CVarAICore_Dedup.GetValueOnAnyThread() != 0);
+            bCommuteOn = (CVarAICore_Commute.GetValueOnAnyThread() != 0);
+            bSeeOn = (CVarAICore_QSee.GetValueOnAnyThread() != 0);
+
+            // mirror images play alike only for the classic eval (NNUE features are per tile and team)
+            if (CVarAICore_Symmetry.GetValueOnAnyThread() != 0 && !S.nnue.Net) S.initSymmetry();
+            else S.clearSymmetry();
+        }
 
-            const int sc = -Quiescence_UTBG(S, -beta, -alpha, R, Ctx);
+        ~FAlphaBetaUTBG() { Abort(); S.clearSymmetry(); }
 
-            if (sc >= beta) return beta;
-            if (sc > alpha) alpha = sc;
+        // Advances the search. SliceSeconds/SliceSteps <= 0: no limit. True once the search is over.
+        bool Run(double SliceSeconds, int64 SliceSteps)
+        {
+            if (bDone) return true;
+            TM.Resume();
+            const double SliceEnd = (SliceSeconds > 0.0) ? FPlatformTime::Seconds() + SliceSeconds : 0.0;
+            int64 Steps = 0;
+            if (bIterActive) DepthEvent.Begin(RootDepth);
 
-            if (Ctx.TM->HardExpired()) break;
+            while (!bDone)
+            {
+                if ((SliceSteps > 0 && Steps >= SliceSteps) || (SliceEnd > 0.0 && FPlatformTime::Seconds() >= SliceEnd))
+                {
+                    EndSlice();
+                    TM.Pause();
+                    return false;
+                }
+                ++Steps;
+
+                if (bHaveRet)
+                {
+                    bHaveRet = false;
+                    if (Top > 0) ConsumeChild(*Frames[Top - 1]);
+                    else ConsumeRootChild();
+                }
+                else if (Top > 0)
+                {
+                    FABFrame& F = *Frames[Top - 1];
+                    if (F.bQuiescence) StepQuiescence(F); else StepNode(F);
+                }
+                else
+                {
+                    StepRoot();
+                }
+            }
+            EndSlice();
+            return true;
         }
-        return alpha;
-    }
 
-    static int AlphaBeta_UTBG(GameState& S, int depth, int alpha, int beta,
-        UTBGRules& R, SearchCtxUTBG& Ctx, std::vector<Action>& outPV)
-    {
-        if (Ctx.TM->HardExpired()) return AICore::Eval(S, {
-            CVarAICore_W_HP.GetValueOnAnyThread(),
-            CVarAICore_W_Pos.GetValueOnAnyThread(),
-            CVarAICore_W_ThreatFor.GetValueOnAnyThread(),
-            CVarAICore_W_ThreatAgainst.GetValueOnAnyThread(),
-            CVarAICore_W_Cohesion.GetValueOnAnyThread()
-            });
+        void GetResult(AICore::FUTBGSearchResult& Out) const
+        {
+            Out.Engine = AICore::ESearchEngine::AlphaBeta;
+            Out.Lines = Lines;
+            Out.PV = Lines.empty() ? std::vector<Action>{} : Lines.front().PV;
+            Out.Score = Lines.empty() ? std::numeric_limits<int>::min() : Lines.front().Score;
+            Out.Nodes = Ctx.Nodes;
+            Out.DedupPruned = Ctx.DedupPruned;
+            Out.CommutePruned = Ctx.CommutePruned;
+            Out.SeePruned = Ctx.SeePruned;
+            Out.TTProbes = Ctx.TTProbes;
+            Out.TTHits = Ctx.TTHits;
+            Out.EvalCacheProbes = Ctx.EvalCache.Probes;
+            Out.EvalCacheHits = Ctx.EvalCache.Hits;
+            Out.Ms = TM.ElapsedMs();
+            Out.DepthMs = DepthMs;
+        }
 
-        const int alphaOrig = alpha;
+        const SearchCtxUTBG& GetCtx() const { return Ctx; }
 
-        // (ɼ) TT probe -  teamAP ؽÿ  Ȱ 
-        if (Ctx.TT)
+        // Overrides the difficulty preset's NodeK and AICore.Commute (AICore.CommuteCheck). Before Run.
+        void SetPruning(int InNodeK, bool bInCommute) { NodeK = InNodeK; bCommuteOn = bInCommute; }
+
+        // Unmakes every action still on the stack (S is back to the root position).
+        void Abort()
         {
-            TTEntry ent;
-            if (Ctx.TT->Probe(S.key, ent) && ent.Depth >= depth)
+            for (int32 i = Top - 1; i >= 0; --i)
             {
-                Ctx.TTHits++;
-                if (ent.Bound == ETTBound::Exact) { outPV.clear(); outPV.push_back(ent.BestMove); return ent.Score; }
-                if (ent.Bound == ETTBound::Lower && ent.Score >= beta)  return ent.Score;
-                if (ent.Bound == ETTBound::Upper && ent.Score <= alpha) return ent.Score;
+                FABFrame& F = *Frames[i];
+                if (F.bChildActive) { R.unmake(S, F.ChildDelta); F.bChildActive = false; }
             }
+            Top = 0;
+            if (bRootChildActive) { R.unmake(S, RootDelta); bRootChildActive = false; }
+            bHaveRet = false;
+            bDone = true;
         }
 
-        if (depth == 0)
-            return Quiescence_UTBG(S, alpha, beta, R, Ctx);
-
-        std::vector<Action> mv;
-        R.generateLegal(S, mv);
-        if (mv.empty())
-            return AICore::Eval(S, {
-                CVarAICore_W_HP.GetValueOnAnyThread(),
-                CVarAICore_W_Pos.GetValueOnAnyThread(),
-                CVarAICore_W_ThreatFor.GetValueOnAnyThread(),
-                CVarAICore_W_ThreatAgainst.GetValueOnAnyThread(),
-                CVarAICore_W_Cohesion.GetValueOnAnyThread()
-                });
-
-        AICore::SortActionsDeterministic(
-            S, mv,
-            AICore::OrderWeights{
-                CVarAICore_OrderPos.GetValueOnAnyThread(),
-                CVarAICore_OrderThreat.GetValueOnAnyThread()
-            },
-            /*attackDamage*/5);
-
-        const int nodeK = GAICoreDefaultNodeK;
-        if (nodeK > 0 && (int)mv.size() > nodeK) mv.resize(nodeK);
-
-        const bool bDedup = (CVarAICore_Dedup.GetValueOnAnyThread() != 0);
-        std::vector<uint64> seenKeys; if (bDedup) seenKeys.reserve(mv.size());
+    private:
+        GameState& S;
+        UTBGRules R;
+        FTimeManager TM;
+        SearchCtxUTBG Ctx;
+        AICore::EvalWeights EW;
+        AICore::OrderWeights OW;    // main search ordering
+        AICore::OrderWeights QW;    // quiescence ordering
+        int  NodeK = -1;
+        bool bDedupOn = true;
+        bool bCommuteOn = true;
+        bool bSeeOn = true;
+
+        std::vector<Move> Killers;      // two quiet moves per ply that caused a beta cutoff: [Ply * 2 + slot]
+
+        TArray<TUniquePtr<FABFrame>> Frames;     // pooled, so frames keep their buffers; [0, Top) in use
+        int32 Top = 0;
+
+        // value handed from a finished node to its parent
+        bool bHaveRet = false;
+        int  RetScore = 0;
+        std::vector<Action> RetPV;
+
+        // root (iterative deepening, Multi-PV)
+        int  MaxDepth = 1;
+        int  MultiPV = 1;
+        int  RootDepth = 0;
+        bool bIterActive = false;
+        std::vector<Action> RootMoves;
+        size_t RootNext = 0;
+        std::vector<AICore::FRootLine> IterLines;
+        std::vector<uint64> IterSearched;   // signatures of this iteration's root moves searched in full
+        bool bRootChildActive = false;
+        Action RootChild;
+        AICore::FActionFootprint RootFp;
+        UTBGDelta RootDelta;
+        int  RootChildAlpha = 0;
+        std::vector<AICore::FRootLine> Lines;
+        std::vector<double> DepthMs;    // TM time at each completed iteration
+        bool bDone = false;
+
+        // profiling: the open depth event and the counters already handed to the stats system
+        AICore::FDepthTraceEvent DepthEvent;
+        SearchCtxUTBG Published;
+
+        FORCEINLINE int Eval() { return AICore::EvalCached(S, EW, &Ctx.EvalCache); }
+
+        void Return(int Score)
+        {
+            bHaveRet = true;
+            RetScore = Score;
+            RetPV.clear();
+        }
 
-        int best = std::numeric_limits<int>::min();
-        std::vector<Action> bestPV;
+        // Closes the depth event and publishes this slice's counters (stat AICore is per frame).
+        void EndSlice()
+        {
+            DepthEvent.End();
+#if STATS
+            INC_DWORD_STAT_BY(STAT_AICore_Nodes, (uint32)(Ctx.Nodes - Published.Nodes));
+            INC_DWORD_STAT_BY(STAT_AICore_TTHitExact, (uint32)(Ctx.TTHitsByBound[(int)ETTBound::Exact] - Published.TTHitsByBound[(int)ETTBound::Exact]));
+            INC_DWORD_STAT_BY(STAT_AICore_TTHitLower, (uint32)(Ctx.TTHitsByBound[(int)ETTBound::Lower] - Published.TTHitsByBound[(int)ETTBound::Lower]));
+            INC_DWORD_STAT_BY(STAT_AICore_TTHitUpper, (uint32)(Ctx.TTHitsByBound[(int)ETTBound::Upper] - Published.TTHitsByBound[(int)ETTBound::Upper]));
+            INC_DWORD_STAT_BY(STAT_AICore_Cutoffs, (uint32)(Ctx.Cutoffs - Published.Cutoffs));
+            INC_DWORD_STAT_BY(STAT_AICore_Iterations, (uint32)(Ctx.Iterations - Published.Iterations));
+            Published = Ctx;
+#endif
+        }
+
+        // Decided match (UTBGRules::outcome) for the side to act; a nearer king kill scores higher.
+        // Nodes entered with the stack at Top are Top + 1 plies below the root.
+        bool Terminal(int& OutScore) const
+        {
+            const int o = UTBGRules::outcome(S);
+            if (o == UTBGRules::kOngoing) return false;
+            const int win = AICore::KingWinScore - (Top + 1);
+            OutScore = (o == UTBGRules::kDraw) ? 0 : (o == S.sideToAct) ? win : -win;
+            return true;
+        }
+
+        FABFrame& Push()
+        {
+            if (Top == Frames.Num()) Frames.Add(MakeUnique<FABFrame>());
+            FABFrame& F = *Frames[Top++];
+            F.Next = 0;
+            F.BestPV.clear();
+            F.bChildActive = false;
+            F.bCommutePruned = false;
+            return F;
+        }
+
+        // child score/window in the parent's perspective
+        static FORCEINLINE int FromChild(bool bFlipped, int Score) { return bFlipped ? -Score : Score; }
+
+        void EnterNode(int Depth, int Alpha, int Beta, const AICore::FActionFootprint* Prev)
+        {
+            if (TM.HardExpired()) { Return(Eval()); return; }
+
+            if (Ctx.bVerifyHash) VerifyKeyUTBG(S, Ctx, TEXT("node"));
+
+            int terminal;
+            if (Terminal(terminal)) { Return(terminal); return; }
+
+            // TT probe: the key covers positions, HP/alive, attack, team AP and side. Mirror images
+            // share the entry of the smallest key; its move is in that image's frame.
+            Move ttMove;
+            if (Ctx.TT)
+            {
+                TTEntry ent;
+                int image;
+                bool bFound;
+                {
+                    AICORE_SCOPE_CYCLE(STAT_AICore_TTProbe);
+                    ++Ctx.TTProbes;
+                    bFound = Ctx.TT->Probe(S.canonicalKey(image), ent);
+                }
+                if (bFound)
+                {
+                    if (image >= 0) ent.BestMove = S.sym->fromImage(ent.BestMove, image);
+                    if (ent.Depth >= Depth)
+                    {
+                        Ctx.TTHits++;
+                        Ctx.TTHitsByBound[(int)ent.Bound]++;
+                        ent.Score = AICore::ScoreFromTT(ent.Score, Top + 1);
+                        if (ent.Bound == ETTBound::Exact)
+                        {
+                            Return(ent.Score);
+                            Action a;
+                            if (!ent.BestMove.isNone() && R.findLegal(S, ent.BestMove, a)) RetPV.push_back(a);
+                            return;
+                        }
+                        if (ent.Bound == ETTBound::Lower && ent.Score >= Beta)  { Return(ent.Score); return; }
+                        if (ent.Bound == ETTBound::Upper && ent.Score <= Alpha) { Return(ent.Score); return; }
+                    }
+                    ttMove = ent.BestMove;      // still the best first guess from a shallower search
+                }
+            }
+
+            if (Depth == 0) { EnterQuiescence(Alpha, Beta); return; }
+
+            FABFrame& F = Push();
+            F.bQuiescence = false;
+            F.Depth = Depth;
+            F.Alpha = Alpha;
+            F.Beta = Beta;
+            F.AlphaOrig = Alpha;
+            F.Best = std::numeric_limits<int>::min();
+            F.Ply = Top - 1;
+            F.NumYielded = 0;
+
+            // NodeK keeps the best K of the whole ordering, so it needs every action up front
+            F.Moves.clear();
+            if (NodeK > 0)
+            {
+                R.generateLegal(S, F.Moves);
+                AICore::SortActionsDeterministic(S, F.Moves, OW, /*attackDamage*/5);
+                if ((int)F.Moves.size() > NodeK) F.Moves.resize(NodeK);
+                F.Stage = PickDone;
+                F.Generated = (int32)F.Moves.size();
+            }
+            else
+            {
+                F.Stage = PickTT;
+                F.TTMove = ttMove;
+                F.Generated = 0;
+            }
+
+            F.bDedup = bDedupOn;
+            if (F.bDedup) F.Seen.Reset(F.Generated);
+            // commutation pruning skips b->a because a->b is searched elsewhere; NodeK may have cut b
+            // at the parent or a under b, on any node of the line, so it only runs untruncated
+            F.bCommute = Prev && bCommuteOn && NodeK <= 0;
+            if (F.bCommute) F.Prev = *Prev;
+        }
+
+        // Refills F.Moves from the next non-empty stage; false once every stage is done.
+        bool NextStage(FABFrame& F)
+        {
+            Action a;
+            F.Moves.clear();
+            F.Next = 0;
+            while (F.Moves.empty())
+            {
+                if (F.Stage >= PickDone) return false;
+                switch (F.Stage++)
+                {
+                case PickTT:
+                    if (!F.TTMove.isNone() && R.findLegal(S, F.TTMove, a)) Yield(F, a);
+                    break;
+                case PickAttacks:       // attacks and skills; the ordering puts lethal hits first
+                    R.generateKinds(S, UTBGRules::GenAttacks, F.Moves);
+                    DropYielded(F);
+                    AICore::SortActionsDeterministic(S, F.Moves, OW, /*attackDamage*/5);
+                    break;
+                case PickKillers:
+                    for (int k = 0; k < 2; ++k)
+                    {
+                        const Move m = KillerAt(F.Ply, k);
+                        if (m.type() == ActionType::Move && !IsYielded(F, m) && R.findLegal(S, m, a)) Yield(F, a);
+                    }
+                    break;
+                case PickQuiets:
+                    R.generateKinds(S, UTBGRules::GenMoves, F.Moves);
+                    DropYielded(F);
+                    AICore::SortActionsDeterministic(S, F.Moves, OW, /*attackDamage*/5);
+                    break;
+                case PickEndTurn:
+                    R.generateKinds(S, UTBGRules::GenEndTurn, F.Moves);
+                    DropYielded(F);
+                    break;
+                }
+            }
+            F.Generated += (int32)F.Moves.size();
+            if (F.bDedup) F.Seen.Reserve(F.Generated);
+            return true;
+        }
+
+        static FORCEINLINE bool IsYielded(const FABFrame& F, Move m)
+        {
+            for (int i = 0; i < F.NumYielded; ++i) if (F.Yielded[i] == m) return true;
+            return false;
+        }
+
+        static void Yield(FABFrame& F, const Action& a)
+        {
+            check(F.NumYielded < UE_ARRAY_COUNT(F.Yielded));
+            F.Yielded[F.NumYielded++] = Move::fromAction(a);
+            F.Moves.push_back(a);
+        }
 
-        for (const auto& a : mv)
+        static void DropYielded(FABFrame& F)
         {
-            FScopedMakeT<UTBGRules, UTBGDelta> guard(R, S, a);
+            if (F.NumYielded == 0) return;
+            F.Moves.erase(std::remove_if(F.Moves.begin(), F.Moves.end(),
+                [&F](const Action& a) { return IsYielded(F, Move::fromAction(a)); }), F.Moves.end());
+        }
+
+        Move& KillerAt(int Ply, int Slot)
+        {
+            if ((int)Killers.size() < (Ply + 1) * 2) Killers.resize((Ply + 1) * 2);
+            return Killers[Ply * 2 + Slot];
+        }
+
+        void StoreKiller(int Ply, const Action& a)
+        {
+            const Move m = Move::fromAction(a);
+            Move& k0 = KillerAt(Ply, 0);
+            if (k0 == m) return;
+            KillerAt(Ply, 1) = k0;
+            KillerAt(Ply, 0) = m;
+        }
+
+        void EnterQuiescence(int Alpha, int Beta)
+        {
+            AICORE_SCOPE_CYCLE(STAT_AICore_QSearch);
+            if (TM.HardExpired()) { Return(Eval()); return; }
+
+            int terminal;
+            if (Terminal(terminal)) { Return(terminal); return; }
+
+            const int stand = Eval();
+            if (stand >= Beta) { Return(Beta); return; }
+            if (stand > Alpha) Alpha = stand;
 
-            if (bDedup)
+            AICore::TScratch<Action> mvBuf;
+            std::vector<Action>& mv = *mvBuf;
+            R.generateKinds(S, UTBGRules::GenAttacks, mv);
+            if (mv.empty()) { Return(Alpha); return; }
+
+            AICore::SortActionsDeterministic(S, mv, QW, /*attackDamage*/5);
+            if (bSeeOn)
+            {
+                Ctx.SeePruned += AICore::FilterByExchange(S, mv, S.teamAP[S.sideToAct], /*attackDamage*/5, R.AttackCost);
+                if (mv.empty()) { Return(Alpha); return; }
+            }
+
+            FABFrame& F = Push();
+            F.bQuiescence = true;
+            F.Alpha = Alpha;
+            F.Beta = Beta;
+            F.Moves.assign(mv.begin(), mv.end());
+        }
+
+        void StepNode(FABFrame& F)
+        {
+            while (F.Next < F.Moves.size() || NextStage(F))
             {
-                const uint64 k = S.key;
-                if (std::find(seenKeys.begin(), seenKeys.end(), k) != seenKeys.end())
+                const Action a = F.Moves[F.Next++];
+                const AICore::FActionFootprint fp = AICore::MakeFootprint(S, a);
+
+                // (b after a) == (a after b) for commuting actions: keep only the order with ascending signature
+                if (F.bCommute && fp.Packed < F.Prev.Packed && AICore::ActionsCommute(F.Prev, fp, S))
+                {
+                    ++Ctx.CommutePruned;
+                    F.bCommutePruned = true;
                     continue;
-                seenKeys.push_back(k);
+                }
+
+                R.make(S, a, F.ChildDelta);
+                if (F.bDedup && !F.Seen.Insert(S.key))
+                {
+                    ++Ctx.DedupPruned;
+                    R.unmake(S, F.ChildDelta);
+                    continue;
+                }
+
+                ++Ctx.Nodes;
+                F.bChildActive = true;
+                F.Child = a;
+                F.ChildFp = fp;
+                const int Depth = F.Depth - 1;
+                if (F.ChildDelta.bFlippedTurn) EnterNode(Depth, -F.Beta, -F.Alpha, nullptr);
+                else                           EnterNode(Depth, F.Alpha, F.Beta, &F.ChildFp);
+                return;
+            }
+            if (F.Generated == 0) { --Top; Return(Eval()); return; }
+            FinishNode(F);
+        }
+
+        void FinishNode(FABFrame& F)
+        {
+            if (Ctx.bVerifyHash) VerifyKeyUTBG(S, Ctx, TEXT("unmake"));
+
+            // Aborted nodes are not stored. Commutation-pruned nodes skipped real children,
+            // so their value is only a lower bound for the position.
+            if (Ctx.TT && !TM.HardExpired())
+            {
+                ETTBound b = ETTBound::Exact;
+                if (F.Best <= F.AlphaOrig) b = ETTBound::Upper;
+                else if (F.Best >= F.Beta) b = ETTBound::Lower;
+                if (F.bCommutePruned && b == ETTBound::Exact) b = ETTBound::Lower;
+                int image;
+                const uint64 key = S.canonicalKey(image);
+                Move storeBest = F.BestPV.empty() ? Move{} : Move::fromAction(F.BestPV.front());
+                if (image >= 0) storeBest = S.sym->toImage(storeBest, image);
+                AICORE_SCOPE_CYCLE(STAT_AICore_TTStore);
+                if (!(F.bCommutePruned && b == ETTBound::Upper))
+                    Ctx.TT->Store(key, (int16)F.Depth, AICore::ScoreToTT(F.Best, F.Ply + 1), b, storeBest, /*age*/(uint16)F.Depth);
             }
 
+            --Top;
+            bHaveRet = true;
+            RetScore = F.Best;
+            RetPV.swap(F.BestPV);
+        }
+
+        void StepQuiescence(FABFrame& F)
+        {
+            if (F.Next >= F.Moves.size())
+            {
+                --Top;
+                Return(F.Alpha);
+                return;
+            }
+            const Action& a = F.Moves[F.Next++];
+            R.make(S, a, F.ChildDelta);
             ++Ctx.Nodes;
+            F.bChildActive = true;
+            if (F.ChildDelta.bFlippedTurn) EnterQuiescence(-F.Beta, -F.Alpha);
+            else                           EnterQuiescence(F.Alpha, F.Beta);
+        }
 
-            std::vector<Action> childPV;
-            const int sc = -AlphaBeta_UTBG(S, depth - 1, -beta, -alpha, R, Ctx, childPV);
+        void ConsumeChild(FABFrame& F)
+        {
+            const int sc = FromChild(F.ChildDelta.bFlippedTurn, RetScore);
+            R.unmake(S, F.ChildDelta);
+            F.bChildActive = false;
 
-            if (sc > best) {
-                best = sc;
-                bestPV.clear(); bestPV.push_back(a);
-                bestPV.insert(bestPV.end(), childPV.begin(), childPV.end());
+            if (F.bQuiescence)
+            {
+                if (sc >= F.Beta) { ++Ctx.Cutoffs; --Top; Return(F.Beta); return; }
+                if (sc > F.Alpha) F.Alpha = sc;
+                if (TM.HardExpired()) { --Top; Return(F.Alpha); }
+                return;
             }
-            if (best > alpha) alpha = best;
-            if (alpha >= beta || Ctx.TM->HardExpired()) break;
+
+            if (sc > F.Best)
+            {
+                F.Best = sc;
+                F.BestPV.clear(); F.BestPV.push_back(F.Child);
+                F.BestPV.insert(F.BestPV.end(), RetPV.begin(), RetPV.end());
+            }
+            if (F.Best > F.Alpha) F.Alpha = F.Best;
+            if (F.Alpha >= F.Beta)
+            {
+                ++Ctx.Cutoffs;
+                if (F.Child.type == ActionType::Move) StoreKiller(F.Ply, F.Child);
+                FinishNode(F);
+            }
+            else if (TM.HardExpired()) FinishNode(F);
         }
 
-        if (Ctx.TT)
+        void StepRoot()
         {
-            ETTBound b = ETTBound::Exact;
-            if (best <= alphaOrig) b = ETTBound::Upper;
-            else if (best >= beta) b = ETTBound::Lower;
-            const Action storeBest = bestPV.empty() ? Action{} : bestPV.front();
-            Ctx.TT->Store(S.key, (int16)depth, best, b, storeBest, /*age*/(uint16)depth);
+            for (;;)
+            {
+                if (!bIterActive)
+                {
+                    if (RootDepth >= MaxDepth || TM.SoftExpired()) { bDone = true; return; }
+                    ++RootDepth;
+                    ++Ctx.Iterations;
+                    DepthEvent.Begin(RootDepth);
+                    IterLines.clear();
+                    IterSearched.clear();
+                    RootMoves.clear();
+                    R.generateLegal(S, RootMoves);
+                    AICore::SortActionsDeterministic(S, RootMoves, OW, /*attackDamage*/5);
+                    PreferPreviousLines();
+                    RootNext = 0;
+                    bIterActive = true;
+                }
+
+                if (RootNext >= RootMoves.size() || TM.SoftExpired())
+                {
+                    if (IterSearched.size() == RootMoves.size())
+                    {
+                        DepthMs.push_back(TM.ElapsedMs());
+                        Lines = IterLines;
+                    }
+                    else
+                    {
+                        MergePartialIteration();
+                    }
+                    bIterActive = false;
+                    DepthEvent.End();
+                    continue;
+                }
+
+                RootChild = RootMoves[RootNext++];
+                RootFp = AICore::MakeFootprint(S, RootChild);
+                RootChildAlpha = AICore::RootAlpha(IterLines, MultiPV);
+                R.make(S, RootChild, RootDelta);
+                bRootChildActive = true;
+                if (RootDelta.bFlippedTurn) EnterNode(RootDepth - 1, -AICore::INF, -RootChildAlpha, nullptr);
+                else                        EnterNode(RootDepth - 1, RootChildAlpha, AICore::INF, &RootFp);
+                return;
+            }
         }
 
-        outPV = std::move(bestPV);
-        return best;
-    }
+        void ConsumeRootChild()
+        {
+            const int sc = FromChild(RootDelta.bFlippedTurn, RetScore);
+            R.unmake(S, RootDelta);
+            bRootChildActive = false;
+
+            // past the hard limit nodes return their static eval: the score is not a search result
+            // (kept only when there is no line at all to play)
+            if (TM.HardExpired())
+            {
+                if (Lines.empty() && IterLines.empty()) AICore::InsertRootLine(IterLines, MultiPV, sc, RootChild, RetPV);
+                return;
+            }
+            IterSearched.push_back(RootChild.signature());
+
+            // sc <= alpha is only an upper bound: the move is not among the best MultiPV
+            if (sc > RootChildAlpha) AICore::InsertRootLine(IterLines, MultiPV, sc, RootChild, RetPV);
+        }
+
+        // An iteration stopped early: its fully searched root moves replace their lines, the
+        // previous iteration's lines stand for the moves it did not get to.
+        void MergePartialIteration()
+        {
+            std::vector<AICore::FRootLine> Merged = IterLines;
+            std::vector<Action> Tail;
+            for (const AICore::FRootLine& L : Lines)
+            {
+                const uint64 sig = L.PV.front().signature();
+                if (std::find(IterSearched.begin(), IterSearched.end(), sig) != IterSearched.end()) continue;
+                if (std::any_of(Merged.begin(), Merged.end(), [sig](const AICore::FRootLine& M) { return M.PV.front().signature() == sig; })) continue;
+                Tail.assign(L.PV.begin() + 1, L.PV.end());
+                AICore::InsertRootLine(Merged, MultiPV, L.Score, L.PV.front(), Tail);
+            }
+            Lines = MoveTemp(Merged);
+        }
+
+        // The previous iteration's lines first (in their order): the root window closes sooner.
+        void PreferPreviousLines()
+        {
+            auto First = RootMoves.begin();
+            for (const AICore::FRootLine& L : Lines)
+            {
+                const uint64 sig = L.PV.front().signature();
+                auto it = std::find_if(First, RootMoves.end(), [sig](const Action& a) { return a.signature() == sig; });
+                if (it == RootMoves.end()) continue;
+                std::rotate(First, it, it + 1);
+                ++First;
+            }
+        }
+    };
 }
 
+//////////////////////////////////////////////////////////////////////////
+// UTBG search API (AlphaBeta engine + engine dispatch)
+//////////////////////////////////////////////////////////////////////////
+
+namespace AICore {
+
+    void SearchUTBG_AlphaBeta(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out)
+    {
+        FAlphaBetaUTBG AB(S, Req);
+        AB.Run(0.0, 0);
+        AB.GetResult(Out);
+
+        const SearchCtxUTBG& Ctx = AB.GetCtx();
+        UE_LOG(LogAICore, Verbose, TEXT("[SearchUTBG] ttHits=%lld%s"), (long long)Ctx.TTHits,
+            Ctx.bVerifyHash ? *FString::Printf(TEXT(" hashErrors=%lld"), (long long)Ctx.HashErrors) : TEXT(""));
+    }
+
+    // Runs the king-kill proof search when Req asks for it; true (and Out filled) on a proof.
+    static bool TryKingProof(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out)
+    {
+        if (Req.KingProofTurns <= 0) return false;
+
+        const double T0 = FPlatformTime::Seconds();
+        UTBGRules R;
+        R.TurnAP = Req.TurnAP;
+        std::vector<Action> line;
+        const bool bProved = ProveKingKill(S, R, Req.KingProofTurns, Req.KingProofNodes, line, Out.ProofNodes);
+        Out.Ms += (FPlatformTime::Seconds() - T0) * 1000.0;
+        if (!bProved) return false;
+
+        Out.Engine = Req.Engine;
+        Out.PV = MoveTemp(line);
+        Out.Score = KingWinScore - (int32)Out.PV.size();
+        Out.Nodes = Out.ProofNodes;
+        Out.bKingProof = true;
+        Out.Lines.assign(1, FRootLine{ Out.PV, Out.Score });
+        UE_LOG(LogAICore, Verbose, TEXT("[SearchUTBG] king kill proved within %d turns (%lld positions, %.1fms)"),
+            Req.KingProofTurns, (long long)Out.ProofNodes, Out.Ms);
+        return true;
+    }
+
+    struct FIncrementalSearchUTBG::FImpl
+    {
+        GameState S;
+        FUTBGSearchRequest Req;
+        TUniquePtr<FAlphaBetaUTBG> AB;
+        FUTBGSearchResult Result;
+        bool bRunning = false;
+        bool bProofPending = false;     // the proof search runs as the first slice
+        bool bLog = true;
+        int64 ProofNodes = 0;           // a failed proof, added to the result as SearchUTBG does
+        double ProofMs = 0.0;
+    };
+
+    FIncrementalSearchUTBG::FIncrementalSearchUTBG() : Impl(MakeUnique<FImpl>()) {}
+    FIncrementalSearchUTBG::~FIncrementalSearchUTBG() { Reset(); }
+
+    void FIncrementalSearchUTBG::Start(const GameState& S, const FUTBGSearchRequest& Req, bool bLog)
+    {
+        Reset();
+        Impl->S = S;
+        Impl->Req = Req;
+        Impl->Req.Engine = ESearchEngine::AlphaBeta;
+        Impl->Result = FUTBGSearchResult{};
+        Impl->bRunning = !Impl->S.units.empty() && Impl->S.boardSize() > 0;
+        Impl->bProofPending = Impl->bRunning && Req.KingProofTurns > 0;
+        Impl->ProofNodes = 0;
+        Impl->ProofMs = 0.0;
+        Impl->bLog = bLog;
+        if (Impl->bRunning) Impl->AB = MakeUnique<FAlphaBetaUTBG>(Impl->S, Impl->Req);
+    }
+
+    bool FIncrementalSearchUTBG::Step(int32 SliceUs, int32 SliceSteps)
+    {
+        if (!Impl->bRunning) return true;
+        SCOPE_CYCLE_COUNTER(STAT_AICore_Search);
+        TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("AICore::IncrementalStep", AICoreChannel);
+        if (Impl->bProofPending)
+        {
+            Impl->bProofPending = false;
+            if (TryKingProof(Impl->S, Impl->Req, Impl->Result))
+            {
+                Impl->AB.Reset();
+                Impl->bRunning = false;
+                return true;
+            }
+            Impl->ProofNodes = Impl->Result.ProofNodes;
+            Impl->ProofMs = Impl->Result.Ms;
+            Impl->Result = FUTBGSearchResult{};
+            return false;
+        }
+        if (!Impl->AB->Run(SliceUs > 0 ? SliceUs * 1e-6 : 0.0, SliceSteps)) return false;
+
+        Impl->AB->GetResult(Impl->Result);
+        Impl->Result.ProofNodes = Impl->ProofNodes;
+        Impl->Result.Ms += Impl->ProofMs;
+        for (double& d : Impl->Result.DepthMs) d += Impl->ProofMs;
+        Impl->AB.Reset();
+        Impl->bRunning = false;
+        if (Impl->bLog) LogUTBGSearch(Impl->S, Impl->Req, Impl->Result, /*QueueMs*/0.0);
+        return true;
+    }
+
+    bool FIncrementalSearchUTBG::IsRunning() const { return Impl->bRunning; }
+
+    const FUTBGSearchResult& FIncrementalSearchUTBG::GetResult() const { return Impl->Result; }
+
+    void FIncrementalSearchUTBG::Reset()
+    {
+        Impl->AB.Reset();       // unwinds the stack on the private copy of the state
+        Impl->bRunning = false;
+    }
+
+    ESearchEngine GetDefaultSearchEngine()
+    {
+        const int32 e = CVarAICore_Engine.GetValueOnAnyThread();
+        if (e == 0) return ESearchEngine::AlphaBeta;
+        if (e == 1) return ESearchEngine::MCTS;
+        if (e == 2) return ESearchEngine::TurnPlanner;
+        return GAICoreDefaultEngine;
+    }
+
+    bool SearchUTBG(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out)
+    {
+        SCOPE_CYCLE_COUNTER(STAT_AICore_Search);
+        TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("AICore::SearchUTBG", AICoreChannel);
+        Out = FUTBGSearchResult{};
+        if (S.units.empty() || S.boardSize() <= 0) return false;
+        if (TryKingProof(S, Req, Out)) return true;
+
+        const int64 proofNodes = Out.ProofNodes;
+        const double proofMs = Out.Ms;
+        const int64 arenaMisses = GetSearchArenaMisses();
+        switch (Req.Engine) {
+        case ESearchEngine::MCTS:        SearchUTBG_MCTS(S, Req, Out); break;
+        case ESearchEngine::TurnPlanner: SearchUTBG_TurnPlanner(S, Req, Out); break;
+        default:                         SearchUTBG_AlphaBeta(S, Req, Out); break;
+        }
+        if (Out.Lines.empty() && !Out.PV.empty()) Out.Lines.push_back(FRootLine{ Out.PV, Out.Score });
+        Out.ProofNodes = proofNodes;
+        Out.Ms += proofMs;
+        for (double& d : Out.DepthMs) d += proofMs;
+        Out.ArenaMisses = GetSearchArenaMisses() - arenaMisses;
+        return !Out.PV.empty();
+    }
+
+    int32 GetDefaultDifficulty()
+    {
+        return GAICoreDefaultDifficulty;
+    }
+
+    int32 GetDefaultKingProofTurns()
+    {
+        return FMath::Max(0, CVarAICore_KingProofTurns.GetValueOnAnyThread());
+    }
+
+    int64 GetDefaultKingProofNodes()
+    {
+        return FMath::Max(0, CVarAICore_KingProofNodes.GetValueOnAnyThread());
+    }
+
+    int32 GetDefaultMultiPV()
+    {
+        const int32 n = CVarAICore_MultiPV.GetValueOnAnyThread();
+        return FMath::Max(1, n >= 0 ? n : GAICoreDefaultMultiPV);
+    }
+
+    int64 GetDefaultNodeBudget()
+    {
+        const int32 n = CVarAICore_NodeBudget.GetValueOnAnyThread();
+        return n >= 0 ? (int64)n : GAICoreDefaultMaxNodes;
+    }
+
+    int32 GetDefaultPickMargin()
+    {
+        const int32 m = CVarAICore_PickMargin.GetValueOnAnyThread();
+        return m >= 0 ? m : GAICoreDefaultPickMargin;
+    }
+
+    int32 PickRootLine(const FUTBGSearchResult& Res, int32 Margin, uint64 Seed)
+    {
+        if (Margin <= 0 || Res.Lines.size() < 2) return 0;
+
+        int32 n = 1;
+        while (n < (int32)Res.Lines.size() && Res.Lines[n].Score >= Res.Lines[0].Score - Margin) ++n;
+
+        uint64 s = Seed ^ (uint64)CVarAICore_NoiseSeed.GetValueOnAnyThread() ^ 0x9E3779B97F4A7C15ULL;
+        return RandRange(s, n);
+    }
+
+} // namespace AICore
+
 //////////////////////////////////////////////////////////////////////////
 // Console Commands (public API remains the same)
 //////////////////////////////////////////////////////////////////////////
 
 using namespace AICore;
 
-// AICore.Difficulty <easy|normal|hard>
+// AICore.Difficulty <easy|normal|hard> [ab|mcts|turn]
 static void RunAICoreDifficulty(const TArray<FString>& Args, UWorld*)
 {
     if (Args.Num() < 1) {
-        UE_LOG(LogAICore, Log, TEXT("Usage: AICore.Difficulty <easy|normal|hard>"));
+        UE_LOG(LogAICore, Log, TEXT("Usage: AICore.Difficulty <easy|normal|hard> [ab|mcts|turn]"));
         return;
     }
     const FString Mode = Args[0].ToLower();
 
+    // optional engine (UTBG search); presets keep alpha-beta unless asked
+    GAICoreDefaultEngine = ESearchEngine::AlphaBeta;
+    if (Args.Num() >= 2 && Args[1].ToLower() == TEXT("mcts")) {
+        GAICoreDefaultEngine = ESearchEngine::MCTS;
+        UE_LOG(LogAICore, Log, TEXT("[Difficulty] engine=mcts"));
+    }
+    else if (Args.Num() >= 2 && Args[1].ToLower() == TEXT("turn")) {
+        GAICoreDefaultEngine = ESearchEngine::TurnPlanner;
+        UE_LOG(LogAICore, Log, TEXT("[Difficulty] engine=turn"));
+    }
+
     if (Mode == TEXT("easy")) {
+        GAICoreDefaultDifficulty = 0;
         GAICoreDefaultSoftMs = 150; GAICoreDefaultHardMs = 180; GAICoreDefaultDepth = 4;
         GAICoreDefaultRootK = 8;   GAICoreDefaultNodeK = 6;
+        GAICoreDefaultMultiPV = 4; GAICoreDefaultPickMargin = 60;
+        GAICoreDefaultMaxNodes = 15000;
         UE_LOG(LogAICore, Log, TEXT("[Difficulty] easy"));
     }
     else if (Mode == TEXT("normal")) {
+        GAICoreDefaultDifficulty = 1;
         GAICoreDefaultSoftMs = 300; GAICoreDefaultHardMs = 350; GAICoreDefaultDepth = 5;
         GAICoreDefaultRootK = -1;  GAICoreDefaultNodeK = -1;
+        GAICoreDefaultMultiPV = 1; GAICoreDefaultPickMargin = 0;
+        GAICoreDefaultMaxNodes = 60000;
         UE_LOG(LogAICore, Log, TEXT("[Difficulty] normal"));
     }
     else if (Mode == TEXT("hard")) {
+        GAICoreDefaultDifficulty = 2;
         GAICoreDefaultSoftMs = 500; GAICoreDefaultHardMs = 600; GAICoreDefaultDepth = 7;
         GAICoreDefaultRootK = 16;  GAICoreDefaultNodeK = 12;
+        GAICoreDefaultMultiPV = 1; GAICoreDefaultPickMargin = 0;
+        GAICoreDefaultMaxNodes = 250000;
         UE_LOG(LogAICore, Log, TEXT("[Difficulty] hard"));
     }
     else {
@@ -1010,7 +1978,7 @@ static void RunAICoreDifficulty(const TArray<FString>& Args, UWorld*)
 }
 static FAutoConsoleCommandWithWorldAndArgs CmdAICoreDifficulty(
     TEXT("AICore.Difficulty"),
-    TEXT("Usage: AICore.Difficulty <easy|normal|hard> // sets default search params"),
+    TEXT("Usage: AICore.Difficulty <easy|normal|hard> [ab|mcts|turn] // sets default search params"),
     FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreDifficulty)
 );
 
@@ -1035,6 +2003,7 @@ static void RunAICoreSearch(const TArray<FString>& Args, UWorld* /*World*/)
     SearchParams P{};
     P.Budget.SoftMs = SoftMs;
     P.Budget.HardMs = HardMs;
+    P.Budget.MaxNodes = GetDefaultNodeBudget();
     P.MaxDepth = MaxDepth;
     P.RootK = RootK;
     P.NodeK = NodeK;
@@ -1052,6 +2021,7 @@ static void RunAICoreSearch(const TArray<FString>& Args, UWorld* /*World*/)
     P.O.EndTurnBias = CVarAICore_OrderEndTurnBias.GetValueOnAnyThread();
 
     P.QStrict = (CVarAICore_QStrict.GetValueOnAnyThread() != 0);
+    P.QSee = (CVarAICore_QSee.GetValueOnAnyThread() != 0);
     P.Dedup = (CVarAICore_Dedup.GetValueOnAnyThread() != 0);
     P.Epsilon = CVarAICore_Epsilon.GetValueOnAnyThread();
     P.NoiseSeed = CVarAICore_NoiseSeed.GetValueOnAnyThread();
@@ -1061,6 +2031,7 @@ static void RunAICoreSearch(const TArray<FString>& Args, UWorld* /*World*/)
     S.width = 5; S.height = 5; S.sideToAct = 0;
     S.units = { Unit{0,0,12,10,2,true}, Unit{1,1,13,10,2,true} };
     S.initZobrist(0xC0FFEEULL, (int)S.units.size());
+    AttachEvalBackend(S);
 
     BasicRules R;
 
@@ -1175,9 +2146,10 @@ static void RunAICoreSearchWorld(const TArray<FString>& Args, UWorld* World)
         return;
     }
     UE_LOG(LogAICore, Log, TEXT("[SearchWorld] %s"), *Info);
+    AttachEvalBackend(S);
 
     SearchParams P{};
-    P.Budget.SoftMs = SoftMs; P.Budget.HardMs = HardMs;
+    P.Budget.SoftMs = SoftMs; P.Budget.HardMs = HardMs; P.Budget.MaxNodes = GetDefaultNodeBudget();
     P.MaxDepth = MaxDepth; P.RootK = GAICoreDefaultRootK; P.NodeK = GAICoreDefaultNodeK;
 
     // CVars 
@@ -1189,6 +2161,7 @@ static void RunAICoreSearchWorld(const TArray<FString>& Args, UWorld* World)
     P.O.Pos = CVarAICore_OrderPos.GetValueOnAnyThread();
     P.O.Threat = CVarAICore_OrderThreat.GetValueOnAnyThread();
     P.QStrict = (CVarAICore_QStrict.GetValueOnAnyThread() != 0);
+    P.QSee = (CVarAICore_QSee.GetValueOnAnyThread() != 0);
     P.Dedup = (CVarAICore_Dedup.GetValueOnAnyThread() != 0);
     P.Epsilon = CVarAICore_Epsilon.GetValueOnAnyThread();
     P.NoiseSeed = CVarAICore_NoiseSeed.GetValueOnAnyThread();
@@ -1247,61 +2220,21 @@ static void RunAICoreSearchWorldUTBG(const TArray<FString>& Args, UWorld* World)
         return;
     }
     UE_LOG(LogAICore, Log, TEXT("[SearchWorldUTBG] %s"), *Info);
+    AttachEvalBackend(S);
 
     // 2) Ģ/Ž
-    UTBGRules R; R.TurnAP = TeamAP; //   AP
-    FTimeBudget B{ Soft, Hard };
-    FTimeManager TM; TM.Start(B);
-    if (!GAICoreTT.IsReady()) { GAICoreTT.ResizeMB(64); }
-    SearchCtxUTBG Ctx; Ctx.TM = &TM; Ctx.TT = &GAICoreTT;
+    FUTBGSearchRequest Req;
+    Req.SoftMs = Soft; Req.HardMs = Hard; Req.MaxDepth = D; Req.TurnAP = TeamAP;
+    Req.MaxNodes = GetDefaultNodeBudget();
+    Req.Engine = GetDefaultSearchEngine();
+    Req.Difficulty = GetDefaultDifficulty();
 
-    std::vector<Action> PV; int score = 0;
-    double ms = 0.0;
-
-    // IDDFS
-    int best = std::numeric_limits<int>::min();
-    std::vector<Action> bestPV;
-    const double T0 = FPlatformTime::Seconds();
-
-    for (int depth = 1; depth <= D; ++depth)
-    {
-        if (TM.SoftExpired()) break;
-
-        int iterBest = std::numeric_limits<int>::min();
-        std::vector<Action> iterPV;
-
-        std::vector<Action> root;
-        R.generateLegal(S, root);
-        AICore::SortActionsDeterministic(
-            S, root,
-            AICore::OrderWeights{
-                CVarAICore_OrderPos.GetValueOnAnyThread(),
-                CVarAICore_OrderThreat.GetValueOnAnyThread()
-            },
-            /*attackDamage*/5);
-
-        for (const auto& a : root)
-        {
-            if (TM.SoftExpired()) break;
-            FScopedMakeT<UTBGRules, UTBGDelta> guard(R, S, a);
-
-            std::vector<Action> childPV;
-            const int sc = -AlphaBeta_UTBG(S, depth - 1, -1000000000, +1000000000, R, Ctx, childPV);
-
-            if (sc > iterBest ||
-                (sc == iterBest && a.signature() < (iterPV.empty() ? ~0ULL : iterPV.front().signature())))
-            {
-                iterBest = sc;
-                iterPV.clear(); iterPV.push_back(a);
-                iterPV.insert(iterPV.end(), childPV.begin(), childPV.end());
-            }
-        }
-
-        if (!iterPV.empty()) { best = iterBest; bestPV = iterPV; }
-    }
+    FUTBGSearchResult Res;
+    AICore::SearchUTBG(S, Req, Res);
 
-    ms = (FPlatformTime::Seconds() - T0) * 1000.0;
-    PV = bestPV; score = best;
+    const std::vector<Action>& PV = Res.PV;
+    const int score = Res.Score;
+    const double ms = Res.Ms;
 
     // 3) 
     FString pvText;
@@ -1309,28 +2242,165 @@ static void RunAICoreSearchWorldUTBG(const TArray<FString>& Args, UWorld* World)
         const Action& a = PV[i];
         if (a.type == ActionType::Move)        pvText += FString::Printf(TEXT("Move(u=%d->%d)"), a.actorId, a.tileIndex);
         else if (a.type == ActionType::Attack) pvText += FString::Printf(TEXT("Attack(u=%d->t=%d)"), a.actorId, a.targetId);
+        else if (a.type == ActionType::Skill)  pvText += FString::Printf(TEXT("Skill(u=%d#%d->t=%d)"), a.actorId, (int32)a.skillId, a.targetId);
         else if (a.type == ActionType::EndTurn)pvText += TEXT("EndTurn");
         else                                    pvText += FString::Printf(TEXT("Pass(u=%d)"), a.actorId);
         if (i + 1 < PV.size()) pvText += TEXT(" -> ");
     }
 
-    const double nps = (ms > 0.0) ? (double)Ctx.Nodes / (ms / 1000.0) : 0.0;
+    const double nps = (ms > 0.0) ? (double)Res.Nodes / (ms / 1000.0) : 0.0;
     UE_LOG(LogAICore, Log, TEXT("[SearchWorldUTBG] bestScore=%d depth<=%d nodes=%lld time=%.2fms nps=%.0f"),
-        score, D, (long long)Ctx.Nodes, ms, nps);
+        score, D, (long long)Res.Nodes, ms, nps);
     UE_LOG(LogAICore, Log, TEXT("[SearchWorldUTBG] PV: %s"), *pvText);
+    UE_LOG(LogAICore, Log, TEXT("[SearchWorldUTBG] arenaMisses=%lld"), (long long)Res.ArenaMisses);
+    UE_LOG(LogAICore, Log, TEXT("[SearchWorldUTBG] pruned: dedup=%lld commute=%lld see=%lld evalCache=%lld/%lld hits tt=%lld/%lld hits"),
+        (long long)Res.DedupPruned, (long long)Res.CommutePruned, (long long)Res.SeePruned, (long long)Res.EvalCacheHits, (long long)Res.EvalCacheProbes,
+        (long long)Res.TTHits, (long long)Res.TTProbes);
+    if (Res.Engine == ESearchEngine::MCTS)
+        UE_LOG(LogAICore, Log, TEXT("[SearchWorldUTBG] mcts playouts=%lld playouts/s=%.0f"),
+            (long long)Res.Playouts, Res.PlayoutsPerSec());
 
     if (CVarAICore_Overlay.GetValueOnAnyThread() != 0 && GEngine) {
         GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Green,
             FString::Printf(TEXT("[AICore]UTBG depth<=%d score=%d nodes=%lld time=%.2fms nps=%.0f"),
-                D, score, (long long)Ctx.Nodes, ms, nps));
+                D, score, (long long)Res.Nodes, ms, nps));
         GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Silver,
             FString::Printf(TEXT("[PV] %s"), *pvText));
     }
-    WriteUTBGSearchLogJSONL(S, R, PV, score, D, Ctx.Nodes, ms);
+    LogUTBGSearch(S, Req, Res, /*QueueMs*/0.0);
 }
 
 static FAutoConsoleCommandWithWorldAndArgs CmdAICoreSearchWorldUTBG(
     TEXT("AICore.SearchWorldUTBG"),
     TEXT("Usage: AICore.SearchWorldUTBG [soft] [hard] [depth] [W] [H] [side=0] [teamAP=5]"),
     FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreSearchWorldUTBG)
-);
\ No newline at end of file
+);
+
+// AICore.Hint [lines=3] [soft] [hard] [depth] [W] [H] [side=0] [teamAP=5]
+static void RunAICoreHint(const TArray<FString>& Args, UWorld* World)
+{
+    int32 NumLines = 3;
+    int32 Soft = GAICoreDefaultSoftMs, Hard = GAICoreDefaultHardMs, D = GAICoreDefaultDepth;
+    int32 W = 10, H = 10, Side = 0, TeamAP = 5;
+    if (Args.Num() >= 1) LexFromString(NumLines, *Args[0]);
+    if (Args.Num() >= 2) LexFromString(Soft, *Args[1]);
+    if (Args.Num() >= 3) LexFromString(Hard, *Args[2]);
+    if (Args.Num() >= 4) LexFromString(D, *Args[3]);
+    if (Args.Num() >= 5) LexFromString(W, *Args[4]);
+    if (Args.Num() >= 6) LexFromString(H, *Args[5]);
+    if (Args.Num() >= 7) LexFromString(Side, *Args[6]);
+    if (Args.Num() >= 8) LexFromString(TeamAP, *Args[7]);
+
+    FSnapshotBuildConfig Cfg; Cfg.Width = W; Cfg.Height = H; Cfg.SideToAct = Side; Cfg.TeamAPStart = TeamAP;
+
+    GameState S; FString Info;
+    if (!AICore::BuildSnapshotFromWorld(World, Cfg, S, &Info)) {
+        UE_LOG(LogAICore, Error, TEXT("[Hint] snapshot failed."));
+        return;
+    }
+    AttachEvalBackend(S);
+
+    // one alpha-beta search scores every line; NodeK (difficulty presets) and a time cut make them approximate
+    FUTBGSearchRequest Req;
+    Req.SoftMs = Soft; Req.HardMs = Hard; Req.MaxDepth = D; Req.TurnAP = TeamAP;
+    Req.MaxNodes = GetDefaultNodeBudget();
+    Req.Engine = ESearchEngine::AlphaBeta;
+    Req.MultiPV = FMath::Max(1, NumLines);
+    Req.Difficulty = GetDefaultDifficulty();
+
+    FUTBGSearchResult Res;
+    if (!AICore::SearchUTBG(S, Req, Res)) {
+        UE_LOG(LogAICore, Log, TEXT("[Hint] no legal move."));
+        return;
+    }
+
+    UE_LOG(LogAICore, Log, TEXT("[Hint] side=%d lines=%d nodes=%lld time=%.2fms"),
+        Side, (int32)Res.Lines.size(), (long long)Res.Nodes, Res.Ms);
+    for (int32 i = 0; i < (int32)Res.Lines.size(); ++i)
+    {
+        const FRootLine& L = Res.Lines[i];
+        FString pvText;
+        for (size_t k = 0; k < L.PV.size(); ++k) {
+            pvText += ActionToString_UTBG(L.PV[k]);
+            if (k + 1 < L.PV.size()) pvText += TEXT(" -> ");
+        }
+        const FString line = FString::Printf(TEXT("#%d %s score=%d (%+d) PV: %s"),
+            i + 1, *ActionToString_UTBG(L.PV.front()), L.Score, L.Score - Res.Lines[0].Score, *pvText);
+        UE_LOG(LogAICore, Log, TEXT("[Hint] %s"), *line);
+
+        if (CVarAICore_Overlay.GetValueOnAnyThread() != 0 && GEngine)
+            GEngine->AddOnScreenDebugMessage(-1, 5.0f, i == 0 ? FColor::Green : FColor::Silver, TEXT("[Hint] ") + line);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreHint(
+    TEXT("AICore.Hint"),
+    TEXT("Usage: AICore.Hint [lines=3] [soft] [hard] [depth] [W] [H] [side=0] [teamAP=5] // best root moves and their search scores (approximate under NodeK presets or a time cut)"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreHint)
+);
+
+// Commutation pruning must not change a score: with NodeK truncating every node, fixed-depth
+// searches of seeded random positions score the same with and without it.
+static void RunAICoreCommuteCheck(const TArray<FString>& Args, UWorld* /*World*/)
+{
+    int32 NodeK = 6, MaxDepth = 4, NumPositions = 16;
+    if (Args.Num() >= 1) LexFromString(NodeK, *Args[0]);
+    if (Args.Num() >= 2) LexFromString(MaxDepth, *Args[1]);
+    if (Args.Num() >= 3) LexFromString(NumPositions, *Args[2]);
+
+    SplitMix64 Rng(0xC0FFEEULL);
+    int32 NumBad = 0;
+    int64 NumPruned = 0;
+    for (int32 p = 0; p < NumPositions; ++p)
+    {
+        GameState S;
+        S.width = 6; S.height = 6; S.sideToAct = p & 1;
+        std::vector<int> Tiles(S.width * S.height);
+        for (int t = 0; t < (int)Tiles.size(); ++t) Tiles[t] = t;
+        for (int k = 0; k < 6; ++k)
+        {
+            std::swap(Tiles[k], Tiles[k + (int)(Rng.next() % (Tiles.size() - k))]);
+            Unit u;
+            u.id = k; u.team = k & 1; u.tile = Tiles[k];
+            u.hp = 4 + (int)(Rng.next() % 9);
+            u.attack = 2 + (int)(Rng.next() % 4);
+            u.moveRange = 1 + (int)(Rng.next() % 2);
+            u.attackRange = 1 + (int)(Rng.next() % 2);
+            S.units.push_back(u);
+        }
+        S.teamAP[0] = S.teamAP[1] = 5; S.maxAP = 5;
+        S.initZobrist(0xC0FFEEULL, (int)S.units.size());
+
+        for (int32 d = 1; d <= MaxDepth; ++d)
+        {
+            int32 Score[2] = { 0, 0 };
+            for (int32 c = 0; c < 2; ++c)
+            {
+                TTable TT; TT.ResizeMB(4);
+                FUTBGSearchRequest Req;
+                Req.SoftMs = Req.HardMs = 600000; Req.MaxDepth = d; Req.TurnAP = 5; Req.TT = &TT;
+                FAlphaBetaUTBG AB(S, Req);
+                AB.SetPruning(NodeK, c == 1);
+                AB.Run(0.0, 0);
+                FUTBGSearchResult Res;
+                AB.GetResult(Res);
+                Score[c] = Res.Score;
+                NumPruned += Res.CommutePruned;
+            }
+            if (Score[0] != Score[1])
+            {
+                ++NumBad;
+                UE_LOG(LogAICore, Error, TEXT("[CommuteCheck] FAIL position=%d depth=%d nodeK=%d score=%d with commutation=%d"),
+                    p, d, NodeK, Score[0], Score[1]);
+            }
+        }
+    }
+    if (NumBad == 0)
+        UE_LOG(LogAICore, Log, TEXT("[CommuteCheck] OK nodeK=%d depth<=%d positions=%d commutePruned=%lld"), NodeK, MaxDepth, NumPositions, (long long)NumPruned);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreCommuteCheck(
+    TEXT("AICore.CommuteCheck"),
+    TEXT("Usage: AICore.CommuteCheck [nodeK=6] [depth=4] [positions=16]  // scores with and without commutation pruning must agree"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreCommuteCheck)
+);
@@ -0,0 +1,142 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "AICoreSearch.h"
+#include "rules_utbg.h"
+
+// Shared between the search TUs (AICoreSearch.cpp / AICoreMCTS.cpp)
+
+//////////////////////////////////////////////////////////////////////////
+// Time manager
+//////////////////////////////////////////////////////////////////////////
+
+// MaxNodes > 0: the search stops on its node counter instead of the clock (same result on every
+// run and machine); the soft limit keeps the SoftMs/HardMs proportion of MaxNodes.
+struct FTimeBudget { int32 SoftMs = 300; int32 HardMs = 350; int64 MaxNodes = 0; };
+
+class FTimeManager {
+    double StartS = 0.0;
+    double PausedS = 0.0;   // > 0 while paused (cooperative search between slices)
+    FTimeBudget B;
+    const int64* Nodes = nullptr;
+    int64 SoftNodes = 0;
+public:
+    void Start(const FTimeBudget& In)
+    {
+        B = In; StartS = FPlatformTime::Seconds(); PausedS = 0.0;
+        SoftNodes = (B.HardMs > 0) ? FMath::Max<int64>(1, B.MaxNodes * FMath::Min(B.SoftMs, B.HardMs) / B.HardMs) : B.MaxNodes;
+    }
+    // Node budget: the engine's node counter (node-budgeted only while set)
+    void CountNodes(const int64* InNodes) { Nodes = InNodes; }
+    FORCEINLINE bool IsNodeBudget() const { return B.MaxNodes > 0 && Nodes; }
+    void Pause() { if (PausedS <= 0.0) PausedS = FPlatformTime::Seconds(); }
+    void Resume() { if (PausedS > 0.0) { StartS += FPlatformTime::Seconds() - PausedS; PausedS = 0.0; } }
+    FORCEINLINE double ElapsedMs() const { return ((PausedS > 0.0 ? PausedS : FPlatformTime::Seconds()) - StartS) * 1000.0; }
+    FORCEINLINE bool SoftExpired() const { return IsNodeBudget() ? *Nodes >= SoftNodes : ElapsedMs() >= B.SoftMs; }
+    FORCEINLINE bool HardExpired() const { return IsNodeBudget() ? *Nodes >= B.MaxNodes : ElapsedMs() >= B.HardMs; }
+};
+
+namespace AICore {
+
+    struct EvalWeights {
+        int HP = 100, Pos = 3, TFor = 25, TAgainst = 35, Coh = 2;
+    };
+    struct OrderWeights {
+        int Pos = 8;
+        int Threat = 6;
+        int Cost = 0;
+        int EndTurnBias = 0;
+    };
+
+    // Queues the search log record of a finished UTBG search (AICore.LogSearch): S is the root
+    // (the PV is replayed on it and undone), QueueMs the scheduler wait. Any thread.
+    void LogUTBGSearch(GameState& S, const FUTBGSearchRequest& Req, const FUTBGSearchResult& Res, double QueueMs);
+
+    // side-to-act relative static eval (classic or NNUE)
+    int Eval(const GameState& S, const EvalWeights& W);
+
+    struct FEvalCacheStats
+    {
+        int64 Probes = 0;
+        int64 Hits = 0;
+        double HitRate() const { return Probes > 0 ? (double)Hits / (double)Probes : 0.0; }
+    };
+
+    // Eval through the shared eval hash (AICore.EvalCache); same value as Eval
+    int EvalCached(const GameState& S, const EvalWeights& W, FEvalCacheStats* Stats = nullptr);
+    int ScoreActionForOrdering(const GameState& S, const Action& a, const OrderWeights& OW, int fallbackDamage);
+    // best-first by ScoreActionForOrdering (each action scored once), ties by packed move code
+    void SortActionsDeterministic(const GameState& S, std::vector<Action>& moves, const OrderWeights& OW, int attackDamage);
+    // the generated action a packed move stands for (nullptr: not among them)
+    const Action* FindAction(const std::vector<Action>& moves, Move m);
+
+    // Tiles/units an action touches, captured before it is made (commutation test).
+    // Moves and attacks flood-fill through empty tiles, so their legality depends on occupancy
+    // within Reach (Manhattan) of the actor; skill range depends only on caster and target tiles.
+    struct FActionFootprint
+    {
+        int32  Actor = -1;
+        int32  Target = -1;
+        int32  TileA = -1;      // actor tile
+        int32  TileB = -1;      // move destination / target tile
+        int32  Reach = 0;       // occupancy radius around TileA the action's legality depends on
+        Move   Packed;          // total order for "keep one of the two orders"
+        bool   bMove = false;
+        bool   bValid = false;  // unit Move/Attack/Skill only
+    };
+
+    inline FActionFootprint MakeFootprint(const GameState& S, const Action& a)
+    {
+        FActionFootprint F;
+        if (a.actorId < 0 || (a.type != ActionType::Move && a.type != ActionType::Attack && a.type != ActionType::Skill)) return F;
+        const Unit& U = S.units[a.actorId];
+        // a turn-ending skill cannot be reordered before other same-turn actions
+        if (a.type == ActionType::Skill && (a.skillId >= U.numSkills || U.skills[a.skillId].endsTurn)) return F;
+        F.Actor = a.actorId;
+        F.TileA = U.tile;
+        if (a.type == ActionType::Move) { F.TileB = a.tileIndex; F.Reach = U.moveRange; F.bMove = true; }
+        else if (a.targetId >= 0) {
+            F.Target = a.targetId; F.TileB = S.units[a.targetId].tile;
+            F.Reach = (a.type == ActionType::Attack) ? U.attackRange : 0;
+        }
+        F.Packed = Move::fromAction(a);
+        F.bValid = true;
+        return F;
+    }
+
+    // Does X change occupancy anywhere Y's legality depends on?
+    // X changes TileA/TileB (move) or TileB (a kill frees the target tile).
+    inline bool FootprintTouches(const FActionFootprint& X, const FActionFootprint& Y, const GameState& S)
+    {
+        const int32 changed[2] = { X.bMove ? X.TileA : -1, X.TileB };
+        for (int32 c : changed) {
+            if (c < 0) continue;
+            if (c == Y.TileA || c == Y.TileB) return true;
+            if (Y.TileA >= 0 && S.manhattan(c, Y.TileA) <= Y.Reach) return true;
+        }
+        return false;
+    }
+
+    // Two same-turn actions commute when they involve different units and neither
+    // changes occupancy inside the other's reach (both orders legal, same result).
+    inline bool ActionsCommute(const FActionFootprint& A, const FActionFootprint& B, const GameState& S)
+    {
+        if (!A.bValid || !B.bValid || S.width <= 0) return false;
+        if (A.Actor == B.Actor || A.Actor == B.Target || B.Actor == A.Target) return false;
+        if (A.Target >= 0 && A.Target == B.Target) return false;
+        return !FootprintTouches(A, B, S) && !FootprintTouches(B, A, S);
+    }
+
+    // Depth-first proof-number search (AICoreProofSearch.cpp): can S.sideToAct kill the enemy
+    // king(s) within Turns of its own turns against any defence? On a proof OutLine holds the
+    // attacker's actions for the current turn. OutNodes = positions made. S is restored.
+    bool ProveKingKill(GameState& S, const UTBGRules& R, int32 Turns, int64 MaxNodes, std::vector<Action>& OutLine, int64& OutNodes);
+
+    // CVar snapshots (AICore.W_* / AICore.Order*)
+    EvalWeights  EvalWeightsFromCVars();
+    OrderWeights OrderWeightsFromCVars();
+
+    // engines behind SearchUTBG
+    void SearchUTBG_AlphaBeta(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out);
+    void SearchUTBG_MCTS(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out);
+    void SearchUTBG_TurnPlanner(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out);
+}
@@ -0,0 +1,630 @@
+#include "AICoreSearchLog.h"
+#include "AICoreLog.h"
+#include "AICoreStats.h"
+#include "move.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static TAutoConsoleVariable<FString> CVarAICore_LogPath(TEXT("AICore.LogPath"), TEXT("AICore/search.jsonl"), TEXT("Relative path under Saved/"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_LogFormat(TEXT("AICore.LogFormat"), 0, TEXT("Search log format: 0=JSONL, 1=binary .aclog (AICore.LogToJSONL converts)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_LogMaxMB(TEXT("AICore.LogMaxMB"), 32, TEXT("Search log: rotate a file once it reaches this size in MB (0=never)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_LogKeep(TEXT("AICore.LogKeep"), 3, TEXT("Search log: rotated files kept as name.1 .. name.N"), ECVF_Default);
+
+namespace AICore
+{
+    namespace
+    {
+        // Binary file: FLogFileHeader, then per record its fixed part and NumSteps steps, in the
+        // native (little-endian) layout of FSearchLogRecord.
+        // Version 2: engine, difficulty, board, budgets, queue wait, root key, time to depth.
+        struct FLogFileHeader
+        {
+            uint32 Magic = 0x474C4341;      // "ACLG"
+            uint32 Version = 2;
+        };
+
+        constexpr int64 kRecordFixedBytes = offsetof(FSearchLogRecord, Steps);
+        static_assert(kRecordFixedBytes == 144 && sizeof(FSearchLogRecord::FStep) == 16,
+            "FSearchLogRecord layout changed: bump FLogFileHeader::Version");
+
+        constexpr uint32 kRingSize = 256;       // records; a power of two
+        constexpr uint32 kFlushMs = 100;        // the log thread wakes at least this often
+        constexpr int64 kReadChunk = 4 << 20;   // bytes per read while streaming a log back
+
+        FORCEINLINE int64 RecordBytes(const FSearchLogRecord& R)
+        {
+            return kRecordFixedBytes + (int64)R.NumSteps * sizeof(FSearchLogRecord::FStep);
+        }
+
+        // Bounded MPSC ring (Vyukov): a producer claims a slot with one CAS and publishes it with
+        // the slot's sequence number; the log thread is the only consumer.
+        class FRecordRing
+        {
+        public:
+            FRecordRing()
+            {
+                for (uint32 i = 0; i < kRingSize; ++i) Slots[i].Seq.store(i, std::memory_order_relaxed);
+            }
+
+            bool TryPush(const FSearchLogRecord& Rec)
+            {
+                uint64 Pos = Head.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    FSlot& S = Slots[Pos & (kRingSize - 1)];
+                    const int64 Dif = (int64)S.Seq.load(std::memory_order_acquire) - (int64)Pos;
+                    if (Dif == 0)
+                    {
+                        if (Head.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+                        {
+                            FMemory::Memcpy(&S.Rec, &Rec, RecordBytes(Rec));
+                            S.Seq.store(Pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (Dif < 0) return false;     // full
+                    else Pos = Head.load(std::memory_order_relaxed);
+                }
+            }
+
+            bool TryPop(FSearchLogRecord& Out)
+            {
+                FSlot& S = Slots[Tail & (kRingSize - 1)];
+                if ((int64)S.Seq.load(std::memory_order_acquire) - (int64)(Tail + 1) < 0) return false;
+                FMemory::Memcpy(&Out, &S.Rec, RecordBytes(S.Rec));
+                S.Seq.store(Tail + kRingSize, std::memory_order_release);
+                ++Tail;
+                return true;
+            }
+
+        private:
+            struct FSlot
+            {
+                std::atomic<uint64> Seq{ 0 };
+                FSearchLogRecord Rec;
+            };
+
+            FSlot Slots[kRingSize];
+            alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head{ 0 };
+            alignas(PLATFORM_CACHE_LINE_SIZE) uint64 Tail = 0;
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        // JSONL (same lines the synchronous writers produced)
+        //////////////////////////////////////////////////////////////////////////
+
+        FString StepToString(uint32 Code)
+        {
+            Move m; m.code = Code;
+            switch (m.type()) {
+            case ActionType::Move:    return FString::Printf(TEXT("Move(%d->%d)"), m.actorId(), m.operand());
+            case ActionType::Attack:  return FString::Printf(TEXT("Attack(%d->%d)"), m.actorId(), m.operand());
+            case ActionType::Skill:   return FString::Printf(TEXT("Skill(%d#%d->%d)"), m.actorId(), (int32)m.skillId(), m.operand());
+            case ActionType::EndTurn: return TEXT("EndTurn");
+            case ActionType::Pass:    return FString::Printf(TEXT("Pass(%d)"), m.actorId());
+            }
+            return TEXT("Unknown");
+        }
+
+        void AppendJSONL(const FSearchLogRecord& R, FString& Out)
+        {
+            if (R.Kind == (uint8)ESearchLogKind::UTBG)
+            {
+                FString actions; actions.Reserve(512);
+                for (int32 i = 0; i < R.NumSteps; ++i)
+                {
+                    const FSearchLogRecord::FStep& s = R.Steps[i];
+                    if (i > 0) actions += TEXT(",");
+                    actions += FString::Printf(
+                        TEXT("{\"act\":\"%s\",\"side\":%d,\"ap_before\":[%d,%d],\"ap_after\":[%d,%d],\"flipped\":%s}"),
+                        *StepToString(s.Move), (int32)s.Side,
+                        (int32)s.APBefore[0], (int32)s.APBefore[1],
+                        (int32)s.APAfter[0], (int32)s.APAfter[1],
+                        s.bFlipped ? TEXT("true") : TEXT("false"));
+                }
+                FString depthMs;
+                for (int32 d = 0; d < FMath::Min((int32)R.DepthReached, FSearchLogRecord::kMaxDepths); ++d)
+                {
+                    if (d > 0) depthMs += TEXT(",");
+                    depthMs += FString::Printf(TEXT("%.3f"), R.DepthMs[d]);
+                }
+                Out += FString::Printf(
+                    TEXT("{\"ts\":%llu,\"depth\":%d,\"nodes\":%lld,\"ms\":%.3f,\"score\":%d,")
+                    TEXT("\"teamAP_start\":[%d,%d],\"side_start\":%d,")
+                    TEXT("\"engine\":%d,\"difficulty\":%d,\"units\":%d,\"board\":[%d,%d],")
+                    TEXT("\"soft_ms\":%d,\"hard_ms\":%d,\"queue_ms\":%.3f,")
+                    TEXT("\"depth_reached\":%d,\"depth_ms\":[%s],\"key\":\"0x%016llX\",")
+                    TEXT("\"actions\":[%s]}\n"),
+                    (unsigned long long)R.TsMs, R.Depth, (long long)R.Nodes, R.Ms, R.Score,
+                    (int32)R.TeamAPStart[0], (int32)R.TeamAPStart[1], (int32)R.SideStart,
+                    (int32)R.Engine, (int32)R.Difficulty, (int32)R.NumUnits, (int32)R.BoardW, (int32)R.BoardH,
+                    R.SoftMs, R.HardMs, R.QueueMs,
+                    (int32)R.DepthReached, *depthMs, (unsigned long long)R.RootKey,
+                    *actions);
+                return;
+            }
+
+            FString pvText; pvText.Reserve(256);
+            for (int32 i = 0; i < R.NumSteps; ++i)
+            {
+                Move m; m.code = R.Steps[i].Move;
+                if (m.type() == ActionType::Move)        pvText += FString::Printf(TEXT("Move(%d->%d)"), m.actorId(), m.operand());
+                else if (m.type() == ActionType::Attack) pvText += FString::Printf(TEXT("Attack(%d->%d)"), m.actorId(), m.operand());
+                else                                      pvText += FString::Printf(TEXT("Pass(%d)"), m.actorId());
+                if (i + 1 < R.NumSteps) pvText += TEXT(" -> ");
+            }
+            Out += FString::Printf(
+                TEXT("{\"ts\":%llu,\"depth\":%d,\"nodes\":%lld,\"ms\":%.3f,\"score\":%d,")
+                TEXT("\"W_HP\":%d,\"W_Pos\":%d,\"W_TFor\":%d,\"W_TAgainst\":%d,\"W_Coh\":%d,")
+                TEXT("\"pv\":\"%s\"}\n"),
+                (unsigned long long)R.TsMs, R.Depth, (long long)R.Nodes, R.Ms, R.Score,
+                (int32)R.Weights[0], (int32)R.Weights[1], (int32)R.Weights[2], (int32)R.Weights[3], (int32)R.Weights[4],
+                *pvText);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        // JSONL back to records (the lines AppendJSONL writes; version 1 lines lack the newer keys)
+        //////////////////////////////////////////////////////////////////////////
+
+        // the value after "Key": in a line (nullptr: absent)
+        const char* FindKey(const char* Line, const char* Key)
+        {
+            char Pat[32];
+            std::snprintf(Pat, sizeof(Pat), "\"%s\":", Key);
+            const char* p = std::strstr(Line, Pat);
+            return p ? p + std::strlen(Pat) : nullptr;
+        }
+
+        template<typename T>
+        void ReadNumber(const char* Line, const char* Key, T& Out)
+        {
+            if (const char* p = FindKey(Line, Key)) Out = (T)std::strtod(p, nullptr);
+        }
+
+        template<typename T>
+        void ReadPair(const char* Line, const char* Key, T& A, T& B)
+        {
+            int a = 0, b = 0;
+            const char* p = FindKey(Line, Key);
+            if (p && std::sscanf(p, "[%d,%d]", &a, &b) == 2) { A = (T)a; B = (T)b; }
+        }
+
+        // StepToString text at p back to a move code
+        bool ParseStep(const char* p, uint32& Code)
+        {
+            int a = 0, b = 0, k = 0;
+            if (std::sscanf(p, "Move(%d->%d)", &a, &b) == 2)           Code = Move::pack(ActionType::Move, a, b, 0).code;
+            else if (std::sscanf(p, "Attack(%d->%d)", &a, &b) == 2)    Code = Move::pack(ActionType::Attack, a, b, 0).code;
+            else if (std::sscanf(p, "Skill(%d#%d->%d)", &a, &k, &b) == 3) Code = Move::pack(ActionType::Skill, a, b, (uint8)k).code;
+            else if (std::sscanf(p, "Pass(%d)", &a) == 1)              Code = Move::pack(ActionType::Pass, a, -1, 0).code;    // AP cost not logged
+            else if (std::strncmp(p, "EndTurn", 7) == 0)               Code = Move::pack(ActionType::EndTurn, -1, -1, 0).code;
+            else return false;
+            return true;
+        }
+
+        bool ParseJSONL(const char* Line, FSearchLogRecord& R)
+        {
+            R = FSearchLogRecord{};
+            if (!FindKey(Line, "ms") || !FindKey(Line, "nodes")) return false;
+            ReadNumber(Line, "ts", R.TsMs);
+            ReadNumber(Line, "depth", R.Depth);
+            ReadNumber(Line, "nodes", R.Nodes);
+            ReadNumber(Line, "ms", R.Ms);
+            ReadNumber(Line, "score", R.Score);
+
+            if (const char* p = FindKey(Line, "actions"))
+            {
+                R.Kind = (uint8)ESearchLogKind::UTBG;
+                ReadPair(Line, "teamAP_start", R.TeamAPStart[0], R.TeamAPStart[1]);
+                ReadNumber(Line, "side_start", R.SideStart);
+                ReadNumber(Line, "engine", R.Engine);
+                ReadNumber(Line, "difficulty", R.Difficulty);
+                ReadNumber(Line, "units", R.NumUnits);
+                ReadPair(Line, "board", R.BoardW, R.BoardH);
+                ReadNumber(Line, "soft_ms", R.SoftMs);
+                ReadNumber(Line, "hard_ms", R.HardMs);
+                ReadNumber(Line, "queue_ms", R.QueueMs);
+                ReadNumber(Line, "depth_reached", R.DepthReached);
+                if (const char* k = FindKey(Line, "key")) R.RootKey = std::strtoull(k + 1, nullptr, 16);
+                if (const char* d = FindKey(Line, "depth_ms"))
+                {
+                    for (int32 i = 0; i < FSearchLogRecord::kMaxDepths && *d != ']'; ++i)
+                    {
+                        char* End = nullptr;
+                        R.DepthMs[i] = std::strtof(d + 1, &End);
+                        if (End == d + 1) break;
+                        d = End;
+                    }
+                }
+
+                // each step carries all its keys, so the first match after the step's start is its own
+                while (R.NumSteps < FSearchLogRecord::kMaxSteps && (p = std::strstr(p, "{\"act\":\"")) != nullptr)
+                {
+                    p += 8;
+                    FSearchLogRecord::FStep& s = R.Steps[R.NumSteps];
+                    if (!ParseStep(p, s.Move)) return false;
+                    ReadNumber(p, "side", s.Side);
+                    ReadPair(p, "ap_before", s.APBefore[0], s.APBefore[1]);
+                    ReadPair(p, "ap_after", s.APAfter[0], s.APAfter[1]);
+                    const char* f = FindKey(p, "flipped");
+                    s.bFlipped = (f && *f == 't') ? 1 : 0;
+                    ++R.NumSteps;
+                }
+                return true;
+            }
+
+            const char* p = FindKey(Line, "pv");
+            if (!p || *p != '"') return false;
+            R.Kind = (uint8)ESearchLogKind::Search;
+            ReadNumber(Line, "W_HP", R.Weights[0]);
+            ReadNumber(Line, "W_Pos", R.Weights[1]);
+            ReadNumber(Line, "W_TFor", R.Weights[2]);
+            ReadNumber(Line, "W_TAgainst", R.Weights[3]);
+            ReadNumber(Line, "W_Coh", R.Weights[4]);
+            for (++p; *p && *p != '"' && R.NumSteps < FSearchLogRecord::kMaxSteps; )
+            {
+                if (!ParseStep(p, R.Steps[R.NumSteps].Move)) return false;
+                ++R.NumSteps;
+                const char* Next = std::strstr(p, " -> ");
+                const char* Quote = std::strchr(p, '"');
+                if (!Next || (Quote && Next > Quote)) break;
+                p = Next + 4;
+            }
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        // Log thread
+        //////////////////////////////////////////////////////////////////////////
+
+        class FSearchLogSink : public FRunnable
+        {
+        public:
+            FRecordRing Ring;
+            std::atomic<int64> Dropped{ 0 };
+
+            void Start()
+            {
+                WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+                Thread = FRunnableThread::Create(this, TEXT("AICoreSearchLog"), 0, TPri_BelowNormal);
+            }
+
+            void StopAndJoin()
+            {
+                bStopping.store(true);
+                WakeEvent->Trigger();
+                Thread->WaitForCompletion();
+                delete Thread;
+                Thread = nullptr;
+                FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+                WakeEvent = nullptr;
+            }
+
+            virtual uint32 Run() override
+            {
+                while (!bStopping.load())
+                {
+                    WakeEvent->Wait(kFlushMs);
+                    Drain();
+                }
+                Drain();
+                for (FLogFile& F : Files) F.Handle.Reset();
+                return 0;
+            }
+
+        private:
+            struct FLogFile
+            {
+                FString Path;
+                TUniquePtr<IFileHandle> Handle;
+                int64 Size = 0;
+                bool bOpenFailed = false;   // warned once per path
+            };
+
+            FRunnableThread* Thread = nullptr;
+            FEvent* WakeEvent = nullptr;
+            std::atomic<bool> bStopping{ false };
+            FSearchLogRecord Rec;                               // pop target
+            FLogFile Files[(int32)ESearchLogKind::Num];
+            TArray<uint8> Pending[(int32)ESearchLogKind::Num];  // this batch's bytes per file
+            int64 DroppedReported = 0;
+
+            void Drain()
+            {
+                const bool bBinary = CVarAICore_LogFormat.GetValueOnAnyThread() != 0;
+                int32 Count = 0;
+                {
+                    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("AICore::SearchLogFormat", AICoreChannel);
+                    FString Line;
+                    while (Ring.TryPop(Rec))
+                    {
+                        if (Rec.Kind >= (uint8)ESearchLogKind::Num) continue;
+                        TArray<uint8>& Out = Pending[Rec.Kind];
+                        if (bBinary)
+                        {
+                            Out.Append((const uint8*)&Rec, (int32)RecordBytes(Rec));
+                        }
+                        else
+                        {
+                            Line.Reset();
+                            AppendJSONL(Rec, Line);
+                            FTCHARToUTF8 Utf8(*Line);
+                            Out.Append((const uint8*)Utf8.Get(), Utf8.Length());
+                        }
+                        ++Count;
+                    }
+                }
+
+                const int64 NowDropped = Dropped.load(std::memory_order_relaxed);
+                if (NowDropped != DroppedReported)
+                {
+                    UE_LOG(LogAICore, Warning, TEXT("[SearchLog] %lld records dropped (queue full)"), (long long)(NowDropped - DroppedReported));
+                    DroppedReported = NowDropped;
+                }
+                if (Count == 0) return;
+
+                TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("AICore::SearchLogWrite", AICoreChannel);
+                for (int32 k = 0; k < (int32)ESearchLogKind::Num; ++k)
+                {
+                    if (Pending[k].Num() == 0) continue;
+                    Write(Files[k], PathFor((ESearchLogKind)k, bBinary), bBinary, Pending[k]);
+                    Pending[k].Reset();
+                }
+            }
+
+            static FString PathFor(ESearchLogKind Kind, bool bBinary)
+            {
+                const FString Rel = (Kind == ESearchLogKind::Search) ? CVarAICore_LogPath.GetValueOnAnyThread() : FString(TEXT("AICore/utbg_search.jsonl"));
+                const FString Path = SearchLogPath(Rel);
+                return bBinary ? FPaths::ChangeExtension(Path, TEXT("aclog")) : Path;
+            }
+
+            static FString Numbered(const FString& Path, int32 N)
+            {
+                return FString::Printf(TEXT("%s.%d"), *Path, N);
+            }
+
+            bool Open(FLogFile& F, const FString& Path, bool bBinary)
+            {
+                IPlatformFile& PF = FPlatformFileManager::Get().GetPlatformFile();
+                const FString Dir = FPaths::GetPath(Path);
+                if (!PF.DirectoryExists(*Dir)) PF.CreateDirectoryTree(*Dir);
+
+                F.Path = Path;
+                F.Handle.Reset(PF.OpenWrite(*Path, /*bAppend*/true, /*bAllowRead*/true));
+                if (!F.Handle)
+                {
+                    if (!F.bOpenFailed) UE_LOG(LogAICore, Warning, TEXT("[SearchLog] cannot open %s"), *Path);
+                    F.bOpenFailed = true;
+                    return false;
+                }
+                F.bOpenFailed = false;
+                F.Size = F.Handle->Size();
+                if (bBinary && F.Size == 0)
+                {
+                    const FLogFileHeader H;
+                    F.Handle->Write((const uint8*)&H, sizeof(H));
+                    F.Size = sizeof(H);
+                }
+                return true;
+            }
+
+            // name -> name.1 -> ... -> name.Keep (dropped)
+            void Rotate(FLogFile& F, bool bBinary)
+            {
+                F.Handle.Reset();
+                IPlatformFile& PF = FPlatformFileManager::Get().GetPlatformFile();
+                const int32 Keep = FMath::Max(0, CVarAICore_LogKeep.GetValueOnAnyThread());
+                if (Keep == 0)
+                {
+                    PF.DeleteFile(*F.Path);
+                }
+                else
+                {
+                    PF.DeleteFile(*Numbered(F.Path, Keep));
+                    for (int32 i = Keep - 1; i >= 1; --i) PF.MoveFile(*Numbered(F.Path, i + 1), *Numbered(F.Path, i));
+                    PF.MoveFile(*Numbered(F.Path, 1), *F.Path);
+                }
+                Open(F, F.Path, bBinary);
+            }
+
+            void Write(FLogFile& F, const FString& Path, bool bBinary, const TArray<uint8>& Bytes)
+            {
+                // a changed AICore.LogPath / AICore.LogFormat switches files
+                if (!F.Handle || F.Path != Path)
+                {
+                    F.Handle.Reset();
+                    if (!Open(F, Path, bBinary)) return;
+                }
+                F.Handle->Write(Bytes.GetData(), Bytes.Num());
+                F.Handle->Flush();
+                F.Size += Bytes.Num();
+
+                const int64 MaxBytes = (int64)CVarAICore_LogMaxMB.GetValueOnAnyThread() << 20;
+                if (MaxBytes > 0 && F.Size >= MaxBytes) Rotate(F, bBinary);
+            }
+        };
+
+        FCriticalSection GSinkLock;
+        std::atomic<FSearchLogSink*> GSink{ nullptr };
+        bool GSinkShutdown = false;
+
+        FSearchLogSink* GetSink()
+        {
+            if (FSearchLogSink* S = GSink.load(std::memory_order_acquire)) return S;
+
+            FScopeLock L(&GSinkLock);
+            if (GSinkShutdown) return nullptr;
+            if (!GSink.load(std::memory_order_relaxed))
+            {
+                FSearchLogSink* S = new FSearchLogSink();
+                S->Start();
+                GSink.store(S, std::memory_order_release);
+            }
+            return GSink.load(std::memory_order_relaxed);
+        }
+    }
+
+    void SubmitSearchLog(const FSearchLogRecord& Rec)
+    {
+        FSearchLogSink* Sink = GetSink();
+        if (Sink && !Sink->Ring.TryPush(Rec)) Sink->Dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    FString SearchLogPath(const FString& Path)
+    {
+        return FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectSavedDir(), Path) : Path;
+    }
+
+    FString SearchLogPVToString(const FSearchLogRecord& Rec)
+    {
+        FString Out;
+        for (int32 i = 0; i < Rec.NumSteps; ++i)
+        {
+            if (i > 0) Out += TEXT(" ");
+            Out += StepToString(Rec.Steps[i].Move);
+        }
+        return Out;
+    }
+
+    bool ReadSearchLog(const FString& Path, TFunctionRef<void(const FSearchLogRecord&)> Visit, int64* OutSkipped)
+    {
+        TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+        if (!File) return false;
+
+        // Buf[Begin, Num) is read but not consumed yet; the file streams through it in chunks
+        TArray<uint8> Buf;
+        int32 Begin = 0;
+        int64 Remaining = File->Size();
+        auto Refill = [&]() -> bool
+        {
+            if (Remaining <= 0) return false;
+            const int32 Keep = Buf.Num() - Begin;
+            if (Keep > 0 && Begin > 0) FMemory::Memmove(Buf.GetData(), Buf.GetData() + Begin, Keep);
+            const int32 N = (int32)FMath::Min<int64>(Remaining, kReadChunk);
+            Buf.SetNumUninitialized(Keep + N);
+            Begin = 0;
+            if (!File->Read(Buf.GetData() + Keep, N)) { Buf.SetNum(Keep); Remaining = 0; return false; }
+            Remaining -= N;
+            return true;
+        };
+
+        int64 Skipped = 0;
+        FSearchLogRecord Rec;
+        Refill();
+
+        const FLogFileHeader Expected;
+        FLogFileHeader H;
+        if (Buf.Num() >= (int32)sizeof(H)) FMemory::Memcpy(&H, Buf.GetData(), sizeof(H));
+        if (Buf.Num() >= (int32)sizeof(H) && H.Magic == Expected.Magic)
+        {
+            if (H.Version != Expected.Version)
+            {
+                UE_LOG(LogAICore, Error, TEXT("[SearchLog] %s: binary log version %u, expected %u"), *Path, H.Version, Expected.Version);
+                return false;
+            }
+            Begin = sizeof(H);
+            for (;;)
+            {
+                const int32 Avail = Buf.Num() - Begin;
+                if (Avail >= kRecordFixedBytes)
+                {
+                    FMemory::Memcpy(&Rec, Buf.GetData() + Begin, kRecordFixedBytes);
+                    if (Rec.NumSteps > FSearchLogRecord::kMaxSteps || Rec.Kind >= (uint8)ESearchLogKind::Num) break;   // corrupt: stop
+                    if (Avail >= RecordBytes(Rec))
+                    {
+                        FMemory::Memcpy(Rec.Steps, Buf.GetData() + Begin + kRecordFixedBytes, RecordBytes(Rec) - kRecordFixedBytes);
+                        Begin += (int32)RecordBytes(Rec);
+                        Visit(Rec);
+                        continue;
+                    }
+                }
+                if (!Refill()) break;
+            }
+            if (Begin < Buf.Num()) ++Skipped;       // truncated or corrupt tail
+        }
+        else
+        {
+            for (;;)
+            {
+                uint8* Nl = (Begin < Buf.Num()) ? (uint8*)std::memchr(Buf.GetData() + Begin, '\n', Buf.Num() - Begin) : nullptr;
+                if (!Nl)
+                {
+                    if (Refill()) continue;
+                    if (Begin >= Buf.Num()) break;
+                    Buf.Add('\n');                   // last line without a newline
+                    Nl = Buf.GetData() + Buf.Num() - 1;
+                }
+                *Nl = 0;
+                const char* Line = (const char*)Buf.GetData() + Begin;
+                Begin = (int32)(Nl - Buf.GetData()) + 1;
+                while (*Line == ' ' || *Line == '\r' || *Line == '\t') ++Line;
+                if (*Line == 0) continue;
+                if (ParseJSONL(Line, Rec)) Visit(Rec); else ++Skipped;
+            }
+        }
+
+        if (OutSkipped) *OutSkipped += Skipped;
+        return true;
+    }
+
+    void ShutdownSearchLog()
+    {
+        FSearchLogSink* Sink;
+        {
+            FScopeLock L(&GSinkLock);
+            GSinkShutdown = true;
+            Sink = GSink.exchange(nullptr);
+        }
+        if (!Sink) return;
+        Sink->StopAndJoin();
+        delete Sink;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console: AICore.LogToJSONL <file.aclog> [out.jsonl]
+//////////////////////////////////////////////////////////////////////////
+
+static void RunAICoreLogToJSONL(const TArray<FString>& Args, UWorld* /*World*/)
+{
+    using namespace AICore;
+    if (Args.Num() < 1)
+    {
+        UE_LOG(LogAICore, Warning, TEXT("Usage: AICore.LogToJSONL <file.aclog> [out.jsonl] (paths relative to Saved/)"));
+        return;
+    }
+    const FString InPath = SearchLogPath(Args[0]);
+    const FString OutPath = (Args.Num() >= 2) ? SearchLogPath(Args[1]) : InPath + TEXT(".jsonl");
+
+    FString Out;
+    int64 Num = 0, Skipped = 0;
+    if (!ReadSearchLog(InPath, [&](const FSearchLogRecord& Rec) { AppendJSONL(Rec, Out); ++Num; }, &Skipped))
+    {
+        UE_LOG(LogAICore, Error, TEXT("[LogToJSONL] cannot read %s"), *InPath);
+        return;
+    }
+    if (Skipped > 0)
+        UE_LOG(LogAICore, Warning, TEXT("[LogToJSONL] %s: %lld unreadable records skipped"), *InPath, (long long)Skipped);
+
+    FFileHelper::SaveStringToFile(Out, *OutPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    UE_LOG(LogAICore, Log, TEXT("[LogToJSONL] %lld records -> %s"), (long long)Num, *OutPath);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreLogToJSONL(
+    TEXT("AICore.LogToJSONL"),
+    TEXT("Usage: AICore.LogToJSONL <file.aclog> [out.jsonl] - convert a binary search log (AICore.LogFormat 1) to JSONL"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreLogToJSONL)
+);
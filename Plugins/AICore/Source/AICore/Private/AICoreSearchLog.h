@@ -0,0 +1,81 @@
+#pragma once
+#include "CoreMinimal.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Search log sink
+//
+// A search hands its log entry over as a fixed-size record (no strings, no
+// allocation) through a lock-free ring; a background thread formats the
+// records in batches and appends them to files it keeps open. Files rotate
+// by size (AICore.LogMaxMB, AICore.LogKeep). AICore.LogFormat picks JSONL
+// or a compact binary format (.aclog) that AICore.LogToJSONL converts back
+// to the same JSONL. ReadSearchLog streams either format back as records
+// (the AICoreLogStats commandlet aggregates them).
+//////////////////////////////////////////////////////////////////////////
+
+namespace AICore
+{
+    enum class ESearchLogKind : uint8
+    {
+        Search = 0,     // BasicRules search (AICore.LogPath)
+        UTBG = 1,       // UTBG search with the PV replayed (AICore/utbg_search.jsonl)
+        Num
+    };
+
+    struct FSearchLogRecord
+    {
+        static constexpr int32 kMaxSteps = 32;      // PV actions kept; longer PVs are cut
+        static constexpr int32 kMaxDepths = 16;     // iterations with a time-to-depth
+
+        struct FStep
+        {
+            uint32 Move = 0;            // Move::code
+            uint8  Side = 0;            // side to act before the action (UTBG)
+            uint8  bFlipped = 0;        // the action ended the turn (UTBG)
+            int16  APBefore[2] = {};    // team AP around the action (UTBG)
+            int16  APAfter[2] = {};
+        };
+
+        uint8  Kind = 0;                // ESearchLogKind
+        uint8  NumSteps = 0;
+        uint8  SideStart = 0;
+        uint8  Engine = 0;              // ESearchEngine (UTBG)
+        int16  TeamAPStart[2] = {};
+        int32  Depth = 0;               // max depth asked for
+        int32  Score = 0;
+        int16  Weights[5] = {};         // HP, Pos, TFor, TAgainst, Coh (Search)
+        int8   Difficulty = -1;         // AICore.Difficulty preset (0 easy .. 2 hard), -1 none
+        uint8  NumUnits = 0;            // alive units at the root
+        uint8  BoardW = 0;
+        uint8  BoardH = 0;
+        uint8  DepthReached = 0;        // completed iterations (AlphaBeta)
+        uint8  Pad = 0;
+        int32  SoftMs = 0;              // budget (0 = node budget or unknown)
+        int32  HardMs = 0;
+        int64  Nodes = 0;
+        double Ms = 0.0;                // search time
+        double QueueMs = 0.0;           // scheduler wait before and between slices
+        uint64 TsMs = 0;                // unix time in ms
+        uint64 RootKey = 0;             // Zobrist key of the root
+        float  DepthMs[kMaxDepths] = {};    // search time when depth d + 1 completed
+        FStep  Steps[kMaxSteps];
+    };
+
+    // Queues Rec for the log thread (started on first use). Never blocks: with the ring full
+    // the record is dropped and counted.
+    void SubmitSearchLog(const FSearchLogRecord& Rec);
+
+    // Writes what is queued, closes the files and stops the log thread (module shutdown).
+    void ShutdownSearchLog();
+
+    // Streams the records of a search log, JSONL or .aclog (told apart by the header), calling
+    // Visit for each. Lines or records it cannot read are counted in OutSkipped. False if the
+    // file cannot be opened or is a binary log of another version.
+    bool ReadSearchLog(const FString& Path, TFunctionRef<void(const FSearchLogRecord&)> Visit, int64* OutSkipped = nullptr);
+
+    // Saved/-relative paths resolved, absolute ones kept
+    FString SearchLogPath(const FString& Path);
+
+    // The record's PV as the log writes its actions ("Move(3->17) Attack(3->7) ...")
+    FString SearchLogPVToString(const FSearchLogRecord& Rec);
+}
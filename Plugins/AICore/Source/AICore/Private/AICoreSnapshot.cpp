@@ -1,23 +1,70 @@
 #include "AICoreSnapshot.h"
 #include "AICoreLog.h"
+#include "AICoreUnitSlots.h"
+#include "AICoreStats.h"
 
 #include "EngineUtils.h"
 #include "GameFramework/Pawn.h"
+#include "Components/ActorComponent.h"
 #include "UObject/UnrealType.h"
 #include "UObject/EnumProperty.h"
+#include "HAL/IConsoleManager.h"
 
-// ƿ:  ӽ UnitId 
-namespace {
-    TMap<TWeakObjectPtr<APawn>, uint16> GUnitIdMap;
-    uint16 GNextUnitId = 0;
+static TAutoConsoleVariable<int32> CVarAICore_TypedSnapshot(TEXT("AICore.TypedSnapshot"), 1, TEXT("Use the game's typed/mirrored snapshot provider when registered (0 = always reflection scan)"), ECVF_Default);
 
-    uint16 GetOrAssignUnitId(APawn* P)
+// ƿ: ġ  UnitId  (dense,  ִ  )
+namespace {
+    struct FSnapshotUnitSlots
     {
-        if (const uint16* Found = GUnitIdMap.Find(P)) return *Found;
-        const uint16 NewId = GNextUnitId++;
-        GUnitIdMap.Add(P, NewId);
-        return NewId;
-    }
+        TWeakObjectPtr<UWorld> World;               // match the slots belong to
+        FUnitSlotAllocator Alloc;
+        TArray<TWeakObjectPtr<APawn>> SlotPawn;     // slot -> pawn
+        TArray<uint32> SeenStamp;                   // slot -> last scan that saw it
+        TArray<int32> SlotByObject;                 // UObject index -> slot, checked against SlotPawn
+        uint32 Stamp = 0;
+
+        void Reset(UWorld* InWorld)
+        {
+            World = InWorld;
+            Alloc.Reset();
+            SlotPawn.Reset();
+            SeenStamp.Reset();
+            SlotByObject.Reset();
+        }
+
+        int32 Find(const APawn* P) const
+        {
+            const int32 Obj = (int32)P->GetUniqueID();
+            const int32 Slot = SlotByObject.IsValidIndex(Obj) ? SlotByObject[Obj] : INDEX_NONE;
+            return (Alloc.IsLive(Slot) && SlotPawn[Slot].Get() == P) ? Slot : INDEX_NONE;
+        }
+
+        int32 Add(APawn* P)
+        {
+            const int32 Slot = Alloc.Acquire();
+            if (SlotPawn.Num() <= Slot) { SlotPawn.SetNum(Slot + 1); SeenStamp.SetNumZeroed(Slot + 1); }
+            SlotPawn[Slot] = P;
+
+            const int32 Obj = (int32)P->GetUniqueID();
+            if (SlotByObject.Num() <= Obj)
+            {
+                const int32 Old = SlotByObject.Num();
+                SlotByObject.SetNumUninitialized(Obj + 1);
+                for (int32 i = Old; i <= Obj; ++i) SlotByObject[i] = INDEX_NONE;
+            }
+            SlotByObject[Obj] = Slot;
+            return Slot;
+        }
+
+        void Release(int32 Slot)
+        {
+            SlotPawn[Slot].Reset();
+            Alloc.Release(Slot);
+            SlotPawn.SetNum(Alloc.Num());
+            SeenStamp.SetNum(Alloc.Num());
+        }
+    };
+    FSnapshotUnitSlots GUnitSlots;
 
     // FProperty ÷ ƿ
     static bool TryGetInt(const UObject* Obj, FName Name, int32& Out)
@@ -34,21 +81,167 @@ namespace {
         return false;
     }
 
-    static bool TryGetFIntPoint(const UObject* Obj, FName Name, FIntPoint& Out)
+    static bool TryGetBool(const UObject* Obj, FName Name, bool& Out)
     {
         if (!Obj) return false;
-        if (const FProperty* Prop = Obj->GetClass()->FindPropertyByName(Name))
+        if (const FBoolProperty* BP = CastField<FBoolProperty>(Obj->GetClass()->FindPropertyByName(Name)))
         {
-            if (const FStructProperty* SP = CastField<FStructProperty>(Prop))
+            Out = BP->GetPropertyValue_InContainer(Obj);
+            return true;
+        }
+        return false;
+    }
+
+    // enum value name (FEnumProperty or enum-backed FByteProperty), e.g. "Manhattan"
+    static bool TryGetEnumName(const UObject* Obj, FName Name, FString& Out)
+    {
+        if (!Obj) return false;
+        const FProperty* Prop = Obj->GetClass()->FindPropertyByName(Name);
+        if (const FEnumProperty* EP = CastField<FEnumProperty>(Prop))
+        {
+            const int64 Raw = EP->GetUnderlyingProperty()->GetSignedIntPropertyValue(EP->ContainerPtrToValuePtr<void>(Obj));
+            if (UEnum* E = EP->GetEnum()) { Out = E->GetNameStringByValue(Raw); return true; }
+        }
+        if (const FByteProperty* BP = CastField<FByteProperty>(Prop))
+        {
+            if (BP->Enum) { Out = BP->Enum->GetNameStringByValue(*BP->ContainerPtrToValuePtr<uint8>(Obj)); return true; }
+        }
+        return false;
+    }
+
+    // USkillData -> SkillSlot. Only unit-targeted damage skills are modeled; false for the rest.
+    static bool ReadSkillSlot(const UObject* Data, SkillSlot& Out)
+    {
+        if (!Data) return false;
+
+        FString Mode;
+        if (TryGetEnumName(Data, TEXT("TargetMode"), Mode) && !Mode.EndsWith(TEXT("Unit"))) return false;
+
+        float Damage = 0.f;
+        const FArrayProperty* EffectsProp = CastField<FArrayProperty>(Data->GetClass()->FindPropertyByName(TEXT("Effects")));
+        const FStructProperty* EffectProp = EffectsProp ? CastField<FStructProperty>(EffectsProp->Inner) : nullptr;
+        if (EffectProp)
+        {
+            const FBoolProperty* DealsProp = CastField<FBoolProperty>(EffectProp->Struct->FindPropertyByName(TEXT("bDealsDamage")));
+            const FNumericProperty* DmgProp = CastField<FNumericProperty>(EffectProp->Struct->FindPropertyByName(TEXT("DamageBase")));
+            FScriptArrayHelper Arr(EffectsProp, EffectsProp->ContainerPtrToValuePtr<void>(Data));
+            for (int32 i = 0; i < Arr.Num(); ++i)
+            {
+                const uint8* Elem = Arr.GetRawPtr(i);
+                if (!DealsProp || !DmgProp || !DealsProp->GetPropertyValue_InContainer(Elem)) continue;
+                Damage += (float)DmgProp->GetFloatingPointPropertyValue(DmgProp->ContainerPtrToValuePtr<void>(Elem));
+            }
+        }
+        if (Damage <= 0.f) return false;
+
+        int32 APCost = 1, Cooldown = 0, Range = 1;
+        TryGetInt(Data, TEXT("APCost"), APCost);
+        TryGetInt(Data, TEXT("CooldownTurns"), Cooldown);
+        TryGetInt(Data, TEXT("Range"), Range);
+        bool bEndsTurn = false;
+        TryGetBool(Data, TEXT("bEndsTurn"), bEndsTurn);
+
+        FString Metric, Filter;
+        TryGetEnumName(Data, TEXT("RangeMetric"), Metric);
+        TryGetEnumName(Data, TEXT("TeamFilter"), Filter);
+
+        Out.apCost   = (uint8)FMath::Clamp(APCost, 0, 255);
+        Out.cooldown = (uint8)FMath::Clamp(Cooldown, 0, 255);
+        Out.range    = (uint8)FMath::Clamp(Range, 0, 255);
+        Out.metric   = Metric.EndsWith(TEXT("Manhattan")) ? RangeMetric::Manhattan : RangeMetric::Chebyshev;
+        Out.targets  = Filter.EndsWith(TEXT("Ally")) ? SkillTargets::Ally
+                     : Filter.EndsWith(TEXT("Any")) ? SkillTargets::Any : SkillTargets::Enemy;
+        Out.endsTurn = bEndsTurn;
+        Out.damage   = (int16)FMath::Clamp(FMath::RoundToInt(Damage), 1, 32767);
+        return true;
+    }
+
+    // Skills/Cooldowns of the pawn's skills component (UUnitSkillsComponent), found by reflection.
+    // Cooldowns tick at the owner's turn start, so a remaining CD of c is usable again after
+    // 2c side flips for the side to act and 2c-1 for the other side.
+    static void ReadUnitSkills(const APawn* P, Unit& U, int32 SideToAct)
+    {
+        for (const UActorComponent* C : P->GetComponents())
+        {
+            if (!C) continue;
+            const FArrayProperty* SkillsProp = CastField<FArrayProperty>(C->GetClass()->FindPropertyByName(TEXT("Skills")));
+            const FObjectPropertyBase* SkillObj = SkillsProp ? CastField<FObjectPropertyBase>(SkillsProp->Inner) : nullptr;
+            if (!SkillObj) continue;
+
+            const FArrayProperty* CDProp = CastField<FArrayProperty>(C->GetClass()->FindPropertyByName(TEXT("Cooldowns")));
+            const FIntProperty* CDInt = CDProp ? CastField<FIntProperty>(CDProp->Inner) : nullptr;
+
+            FScriptArrayHelper Skills(SkillsProp, SkillsProp->ContainerPtrToValuePtr<void>(C));
+            for (int32 i = 0; i < Skills.Num() && U.numSkills < kMaxUnitSkills; ++i)
             {
-                if (SP->Struct == TBaseStructure<FIntPoint>::Get())
+                SkillSlot Slot;
+                if (!ReadSkillSlot(SkillObj->GetObjectPropertyValue(Skills.GetRawPtr(i)), Slot)) continue;
+                Slot.dataIndex = (uint8)i;
+
+                int32 CD = 0;
+                if (CDInt)
                 {
-                    Out = *SP->ContainerPtrToValuePtr<FIntPoint>(Obj);
-                    return true;
+                    FScriptArrayHelper CDs(CDProp, CDProp->ContainerPtrToValuePtr<void>(C));
+                    if (i < CDs.Num()) CD = CDInt->GetPropertyValue(CDs.GetRawPtr(i));
                 }
+
+                U.skills[U.numSkills] = Slot;
+                U.readyTurn[U.numSkills] = (CD <= 0) ? 0 : (U.team == SideToAct ? 2 * CD : 2 * CD - 1);
+                ++U.numSkills;
             }
+            return;
         }
-        return false;
+    }
+
+    // Per-class property lookups for the reflection path, resolved once per UClass
+    // (FindPropertyByName and enum-name matching are kept out of the per-pawn loop).
+    struct FPawnPropCache
+    {
+        const FStructProperty* Grid = nullptr;
+        const FProperty* Team = nullptr;
+        const FIntProperty* CurHP = nullptr;
+        const FIntProperty* MaxHP = nullptr;
+        const FIntProperty* Attack = nullptr;
+        const FIntProperty* MoveRange = nullptr;
+        const FIntProperty* AttackRange = nullptr;
+        const FIntProperty* AttackCost = nullptr;
+        const FBoolProperty* King = nullptr;
+        int8 TeamByValue[256];      // team enum value -> 0/1, -1 = NoTeam, kTeamUnresolved = not looked up yet
+    };
+    constexpr int8 kTeamUnresolved = 127;
+
+    TMap<TWeakObjectPtr<const UClass>, FPawnPropCache> GPawnPropCache;
+    TFunction<bool(UWorld*, const FSnapshotBuildConfig&, GameState&, FString*)> GSnapshotProvider;
+    Zobrist GSnapshotZobrist;
+
+    static const FIntProperty* FindIntProp(const UClass* C, FName Name)
+    {
+        return CastField<FIntProperty>(C->FindPropertyByName(Name));
+    }
+
+    static FPawnPropCache& GetPawnProps(const UClass* C)
+    {
+        if (FPawnPropCache* Found = GPawnPropCache.Find(C)) return *Found;
+
+        FPawnPropCache P;
+        if (const FStructProperty* SP = CastField<FStructProperty>(C->FindPropertyByName(TEXT("GridCoord"))))
+            if (SP->Struct == TBaseStructure<FIntPoint>::Get()) P.Grid = SP;
+        P.Team = C->FindPropertyByName(TEXT("Team"));
+        P.CurHP = FindIntProp(C, TEXT("CurrentHP"));
+        P.MaxHP = FindIntProp(C, TEXT("MaxHP"));
+        for (const TCHAR* Name : { TEXT("AttackPower"), TEXT("Attack"), TEXT("BaseAttack"), TEXT("Damage") })
+            if ((P.Attack = FindIntProp(C, Name)) != nullptr) break;
+        P.MoveRange = FindIntProp(C, TEXT("MoveRange"));
+        P.AttackRange = FindIntProp(C, TEXT("AttackRange"));
+        P.AttackCost = FindIntProp(C, TEXT("AttackCost"));
+        P.King = CastField<FBoolProperty>(C->FindPropertyByName(TEXT("bIsKing")));
+        FMemory::Memset(P.TeamByValue, kTeamUnresolved, sizeof(P.TeamByValue));
+        return GPawnPropCache.Add(C, P);
+    }
+
+    static FORCEINLINE int32 ReadInt(const FIntProperty* Prop, const UObject* Obj, int32 Default)
+    {
+        return Prop ? Prop->GetPropertyValue_InContainer(Obj) : Default;
     }
 
     static bool TryGetTeamFromEnum(const UObject* Obj, int& OutTeamIdx, bool& OutNoTeam)
@@ -86,19 +279,63 @@ namespace {
         }
         return false;
     }
+
+    // TryGetTeamFromEnum through the per-class value table (enum names matched once per value)
+    static bool ResolveTeam(FPawnPropCache& P, const UObject* Obj, int& OutTeamIdx, bool& OutNoTeam)
+    {
+        int64 Raw = -1;
+        if (const FEnumProperty* EP = CastField<FEnumProperty>(P.Team))
+            Raw = EP->GetUnderlyingProperty()->GetSignedIntPropertyValue(EP->ContainerPtrToValuePtr<void>(Obj));
+        else if (const FByteProperty* BP = CastField<FByteProperty>(P.Team))
+            Raw = *BP->ContainerPtrToValuePtr<uint8>(Obj);
+        else
+            return false;
+
+        if (Raw < 0 || Raw > 255) return TryGetTeamFromEnum(Obj, OutTeamIdx, OutNoTeam);
+
+        int8& Slot = P.TeamByValue[Raw];
+        if (Slot == kTeamUnresolved)
+        {
+            int Team = 0; bool bNoTeam = false;
+            if (!TryGetTeamFromEnum(Obj, Team, bNoTeam)) return false;
+            Slot = bNoTeam ? -1 : (int8)Team;
+        }
+        OutNoTeam = (Slot < 0);
+        OutTeamIdx = FMath::Max<int>(Slot, 0);
+        return true;
+    }
 }
 
 void AICore::ResetSnapshotUnitIds()
 {
-    GUnitIdMap.Reset();
-    GNextUnitId = 0;
+    GUnitSlots.Reset(nullptr);
+}
+
+void AICore::SetSnapshotProvider(FSnapshotProvider Provider)
+{
+    GSnapshotProvider = MoveTemp(Provider);
+}
+
+void AICore::InitSnapshotZobrist(GameState& S, uint64 Seed)
+{
+    if (S.Z.sideToAct.empty()) S.Z = GSnapshotZobrist;
+    S.initZobrist(Seed, (int)S.units.size());   // regenerates only if the cached tables fall short
+    const Zobrist& Z = S.Z;
+    if (!GSnapshotZobrist.covers(Seed, Z.maxUnits, Z.boardSize, Z.maxAP, Z.maxHP, Z.maxCD)) GSnapshotZobrist = Z;
 }
 
 bool AICore::BuildSnapshotFromWorld(UWorld* World, const FSnapshotBuildConfig& Cfg,
     GameState& Out, FString* OutDebugInfo)
 {
+    SCOPE_CYCLE_COUNTER(STAT_AICore_Snapshot);
     if (!World) return false;
 
+    if (GSnapshotProvider && CVarAICore_TypedSnapshot.GetValueOnGameThread() != 0
+        && GSnapshotProvider(World, Cfg, Out, OutDebugInfo))
+    {
+        return true;
+    }
+
     Out = GameState{};
     Out.width = Cfg.Width;
     Out.height = Cfg.Height;
@@ -107,52 +344,94 @@ bool AICore::BuildSnapshotFromWorld(UWorld* World, const FSnapshotBuildConfig& C
 
     int32 Count = 0;
 
+    // new world = new match: slots start over
+    if (GUnitSlots.World.Get() != World) GUnitSlots.Reset(World);
+    const uint32 Stamp = ++GUnitSlots.Stamp;
+
+    struct FScannedUnit { APawn* Pawn; int32 Slot; Unit U; };
+    TArray<FScannedUnit, TInlineAllocator<32>> Scanned;
+
     //   Pawn  ĵ(Ʈ PawnBase )
     for (TActorIterator<APawn> It(World); It; ++It)
     {
         APawn* P = *It;
         if (!IsValid(P)) continue;
+        FPawnPropCache& Props = GetPawnProps(P->GetClass());
 
         // 1) GridCoord ־ ""  (ī޶  )
-        FIntPoint Grid(-1, -1);
-        if (!TryGetFIntPoint(P, TEXT("GridCoord"), Grid)) continue;
+        if (!Props.Grid) continue;
+        const FIntPoint Grid = *Props.Grid->ContainerPtrToValuePtr<FIntPoint>(P);
         if (Grid.X < 0 || Grid.Y < 0) continue;
 
         // 2) Team enum б (NoTeam̸ )
         int teamIdx = 0; bool bNoTeam = false;
-        if (!TryGetTeamFromEnum(P, teamIdx, bNoTeam)) {
+        if (!ResolveTeam(Props, P, teamIdx, bNoTeam)) {
             continue; //  Ӽ ٸ  ()
         }
         if (bNoTeam) continue; // ET_NoTeam  ŵ
 
         // 3) HP
-        int32 CurHP = 0, MaxHP = 0;
-        const bool bHasHP = TryGetInt(P, TEXT("CurrentHP"), CurHP);
-        const bool bHasMaxHP = TryGetInt(P, TEXT("MaxHP"), MaxHP);
+        const bool bHasHP = (Props.CurHP != nullptr);
+        const bool bHasMaxHP = (Props.MaxHP != nullptr);
+        const int32 CurHP = ReadInt(Props.CurHP, P, 0);
+        const int32 MaxHP = ReadInt(Props.MaxHP, P, 0);
         const bool bAlive = !bHasHP ? true : (CurHP > 0);
         if (Cfg.bOnlyLiving && !bAlive) continue;
 
         // 4) Ÿ ε
         const int tile = Grid.Y * Cfg.Width + Grid.X;
 
-        // 5) ID / HP / (ӽ AP )
-        const uint16 id = GetOrAssignUnitId(P);
+        // 5) HP / (ӽ AP )
         const int hpForSnapshot = bHasHP ? CurHP : (bHasMaxHP ? MaxHP : 10);
         const int apStub = Cfg.FallbackUnitAP; // S2  
 
         // 6) Attack
-        int32 Attack = 0;
-        bool bHasAttack =
-            TryGetInt(P, TEXT("AttackPower"), Attack)   ||
-            TryGetInt(P, TEXT("Attack"), Attack)        ||
-            TryGetInt(P, TEXT("BaseAttack"), Attack);
+        int32 Attack = ReadInt(Props.Attack, P, 0);
+        if (Attack <= 0) Attack = 5;
+
+        Unit U{ -1, teamIdx, tile, hpForSnapshot, apStub, bAlive, Attack };
 
-        if (!bHasAttack || Attack <= 0) Attack = 5;
+        // 7) Ranges / attack cost (APawnBase::MoveRange, AttackRange, AttackCost)
+        const int32 MoveRange = ReadInt(Props.MoveRange, P, 1);
+        const int32 AttackRange = ReadInt(Props.AttackRange, P, 1);
+        const int32 AttackCost = ReadInt(Props.AttackCost, P, 0);
+        U.moveRange = FMath::Clamp(MoveRange, 0, 255);
+        U.attackRange = FMath::Clamp(AttackRange, 0, 255);
+        U.attackCost = FMath::Clamp(AttackCost, 0, 255);
+        U.king = Props.King && Props.King->GetPropertyValue_InContainer(P);
 
-        Out.units.push_back(Unit{ id, teamIdx, tile, hpForSnapshot, apStub, bAlive, Attack });
+        ReadUnitSkills(P, U, Cfg.SideToAct);
+
+        const int32 Slot = GUnitSlots.Find(P);
+        if (Slot != INDEX_NONE) GUnitSlots.SeenStamp[Slot] = Stamp;
+        Scanned.Add(FScannedUnit{ P, Slot, U });
         ++Count;
     }
 
+    // 8) Slots: units that left the match free theirs first so newcomers reuse them,
+    //    then units[id] is laid out by slot (unused slots stay dead placeholders)
+    for (int32 s = GUnitSlots.Alloc.Num() - 1; s >= 0; --s)
+    {
+        if (GUnitSlots.Alloc.IsLive(s) && GUnitSlots.SeenStamp[s] != Stamp) GUnitSlots.Release(s);
+    }
+    for (FScannedUnit& E : Scanned)
+    {
+        if (E.Slot == INDEX_NONE) E.Slot = GUnitSlots.Add(E.Pawn);
+    }
+
+    Out.units.resize(GUnitSlots.Alloc.Num());
+    for (int32 s = 0; s < (int32)Out.units.size(); ++s)
+    {
+        Unit& Placeholder = Out.units[s];
+        Placeholder.id = s; Placeholder.tile = -1; Placeholder.hp = 0; Placeholder.ap = 0; Placeholder.alive = false;
+        Placeholder.king = false;     // a freed king slot must not read as a dead king
+    }
+    for (FScannedUnit& E : Scanned)
+    {
+        E.U.id = E.Slot;
+        Out.units[E.Slot] = E.U;
+    }
+
     //  AP Ǯ(   )
     Out.teamAP[0] = 0;
     Out.teamAP[1] = 0;
@@ -160,12 +439,12 @@ bool AICore::BuildSnapshotFromWorld(UWorld* World, const FSnapshotBuildConfig& C
     Out.maxAP = std::max(Out.teamAP[0], Out.teamAP[1]);
 
     // Zobrist ̺ غ
-    Out.initZobrist(Cfg.ZobristSeed, (int)Out.units.size());
+    InitSnapshotZobrist(Out, Cfg.ZobristSeed);
 
     if (OutDebugInfo)
     {
-        *OutDebugInfo = FString::Printf(TEXT("units=%d WxH=%dx%d side=%d teamAP=[%d,%d]"),
-            Count, Cfg.Width, Cfg.Height, Cfg.SideToAct, Out.teamAP[0], Out.teamAP[1]);
+        *OutDebugInfo = FString::Printf(TEXT("units=%d slots=%d WxH=%dx%d side=%d teamAP=[%d,%d]"),
+            Count, (int32)Out.units.size(), Cfg.Width, Cfg.Height, Cfg.SideToAct, Out.teamAP[0], Out.teamAP[1]);
     }
     return true;
 }
\ No newline at end of file
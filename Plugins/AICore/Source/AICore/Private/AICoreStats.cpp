@@ -0,0 +1,41 @@
+#include "AICoreStats.h"
+
+DEFINE_STAT(STAT_AICore_Snapshot);
+DEFINE_STAT(STAT_AICore_Search);
+DEFINE_STAT(STAT_AICore_MoveGen);
+DEFINE_STAT(STAT_AICore_MakeUnmake);
+DEFINE_STAT(STAT_AICore_Eval);
+DEFINE_STAT(STAT_AICore_QSearch);
+DEFINE_STAT(STAT_AICore_TTProbe);
+DEFINE_STAT(STAT_AICore_TTStore);
+DEFINE_STAT(STAT_AICore_LogWrite);
+
+DEFINE_STAT(STAT_AICore_Nodes);
+DEFINE_STAT(STAT_AICore_TTHitExact);
+DEFINE_STAT(STAT_AICore_TTHitLower);
+DEFINE_STAT(STAT_AICore_TTHitUpper);
+DEFINE_STAT(STAT_AICore_Cutoffs);
+DEFINE_STAT(STAT_AICore_Iterations);
+
+UE_TRACE_CHANNEL_DEFINE(AICoreChannel);
+
+namespace AICore
+{
+    void FDepthTraceEvent::Begin(int32 Depth)
+    {
+#if CPUPROFILERTRACE_ENABLED
+        if (bOpen || !UE_TRACE_CHANNELEXPR_IS_ENABLED(AICoreChannel)) return;
+        FCpuProfilerTrace::OutputBeginDynamicEvent(*FString::Printf(TEXT("AICore Depth %d"), Depth));
+        bOpen = true;
+#endif
+    }
+
+    void FDepthTraceEvent::End()
+    {
+#if CPUPROFILERTRACE_ENABLED
+        if (!bOpen) return;
+        FCpuProfilerTrace::OutputEndEvent();
+        bOpen = false;
+#endif
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Profiling: `stat AICore` and Unreal Insights
+//
+// Cycle stats cover the pipeline stages (snapshot, move generation, make/unmake,
+// eval, quiescence, TT probe/store, log write); with the cpu channel on they
+// also show up as Insights timing events. Counters (nodes, TT hits by bound,
+// cutoffs, iterations) are published once per search slice, not per node.
+// AICoreChannel carries the per-search and per-depth Insights events:
+//   -trace=cpu,AICore   (or Trace.Enable AICore at runtime)
+//
+// The per-node scopes (movegen, make/unmake, eval, TT) go through
+// AICORE_SCOPE_CYCLE; build with AICORE_STATS_DETAIL=0 to compile them out
+// while keeping the rest.
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef AICORE_STATS_DETAIL
+#define AICORE_STATS_DETAIL STATS
+#endif
+
+#if AICORE_STATS_DETAIL
+#define AICORE_SCOPE_CYCLE(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define AICORE_SCOPE_CYCLE(Stat)
+#endif
+
+DECLARE_STATS_GROUP(TEXT("AICore"), STATGROUP_AICore, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Snapshot"), STAT_AICore_Snapshot, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search"), STAT_AICore_Search, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Move generation"), STAT_AICore_MoveGen, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Make/unmake"), STAT_AICore_MakeUnmake, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Eval"), STAT_AICore_Eval, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Quiescence node"), STAT_AICore_QSearch, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TT probe"), STAT_AICore_TTProbe, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TT store"), STAT_AICore_TTStore, STATGROUP_AICore, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Log write"), STAT_AICore_LogWrite, STATGROUP_AICore, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes"), STAT_AICore_Nodes, STATGROUP_AICore, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("TT hits (exact)"), STAT_AICore_TTHitExact, STATGROUP_AICore, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("TT hits (lower)"), STAT_AICore_TTHitLower, STATGROUP_AICore, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("TT hits (upper)"), STAT_AICore_TTHitUpper, STATGROUP_AICore, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Beta cutoffs"), STAT_AICore_Cutoffs, STATGROUP_AICore, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Root iterations"), STAT_AICore_Iterations, STATGROUP_AICore, );
+
+UE_TRACE_CHANNEL_EXTERN(AICoreChannel);
+
+namespace AICore
+{
+    // Insights event for one iterative-deepening depth. A sliced search closes it when a slice
+    // ends and reopens it in the next one, so events stay nested inside the slice's scope.
+    struct FDepthTraceEvent
+    {
+        void Begin(int32 Depth);
+        void End();
+
+    private:
+        bool bOpen = false;
+    };
+}
@@ -0,0 +1,256 @@
+#include "CoreMinimal.h"
+#include "AICoreLog.h"
+#include "AICoreSearchInternal.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "rules_utbg.h"
+#include "AICoreArena.h"
+#include "AICoreKeySet.h"
+#include "AICoreStats.h"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////
+// Whole-turn planner (UTBGRules)
+//
+// One ply = one full team turn (actions until EndTurn or teamAP == 0).
+// Per turn, all distinct end-of-turn positions are enumerated once
+// (intermediate and final positions deduplicated by key), the best K by
+// static eval become the children of a turn-level negamax alpha-beta.
+//////////////////////////////////////////////////////////////////////////
+
+static TAutoConsoleVariable<int32> CVarAICore_TurnPlies(TEXT("AICore.TurnPlies"), 3, TEXT("Turn planner: max lookahead in whole turns"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_TurnK(TEXT("AICore.TurnK"), 16, TEXT("Turn planner: end-of-turn positions kept per node (best by eval)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarAICore_TurnMaxEnds(TEXT("AICore.TurnMaxEnds"), 4000, TEXT("Turn planner: cap on distinct end-of-turn positions per enumeration"), ECVF_Default);
+
+namespace
+{
+    constexpr int kTurnInf = 1000000000;
+
+    struct FTurnEnd
+    {
+        int32 First = 0;            // actions of the turn in the node's sequence buffer,
+        int32 Num = 0;              // last one flips the side
+        int Score = 0;              // static eval for the side that played the turn
+    };
+
+    struct FTurnPlannerCtx
+    {
+        const UTBGRules* R = nullptr;
+        FTimeManager* TM = nullptr;
+        AICore::EvalWeights E{};
+        AICore::OrderWeights O{};
+        int32 K = 16;
+        int32 MaxEnds = 4000;
+        int64 Nodes = 0;            // make() calls
+        int64 TurnNodes = 0;        // turn-level nodes
+        int64 DupPruned = 0;        // intermediate transpositions skipped
+        bool  bAborted = false;
+    };
+
+    static FORCEINLINE bool TeamHasUnits(const GameState& S, int team)
+    {
+        for (const auto& u : S.units) if (u.alive && u.team == team) return true;
+        return false;
+    }
+
+    static FORCEINLINE bool IsTerminal(const GameState& S)
+    {
+        return !TeamHasUnits(S, 0) || !TeamHasUnits(S, 1) || UTBGRules::outcome(S) != UTBGRules::kOngoing;
+    }
+
+    // DFS over the side's actions; every distinct position reached at turn end is recorded once.
+    static void EnumerateTurn(GameState& S, int Side, FTurnPlannerCtx& Ctx,
+        std::vector<Action>& Seq, FKeySetView& Visited, FKeySetView& EndSeen,
+        std::vector<FTurnEnd>& Out, std::vector<Action>& OutSeqs)
+    {
+        if (S.sideToAct != Side || IsTerminal(S))
+        {
+            if (EndSeen.Insert(S.key)) {
+                const int ev = AICore::EvalCached(S, Ctx.E);
+                Out.push_back(FTurnEnd{ (int32)OutSeqs.size(), (int32)Seq.size(), (S.sideToAct == Side) ? ev : -ev });
+                OutSeqs.insert(OutSeqs.end(), Seq.begin(), Seq.end());
+            }
+            return;
+        }
+        if ((int32)Out.size() >= Ctx.MaxEnds) return;
+        if ((++Ctx.Nodes & 1023) == 0 && Ctx.TM->HardExpired()) { Ctx.bAborted = true; return; }
+        if (Ctx.bAborted) return;
+
+        if (!Visited.Insert(S.key)) { ++Ctx.DupPruned; return; }
+
+        AICore::TScratch<Action> mvBuf;
+        std::vector<Action>& mv = *mvBuf;
+        Ctx.R->generateLegal(S, mv);
+        AICore::SortActionsDeterministic(S, mv, Ctx.O, /*attackDamage*/5);
+
+        for (const Action& a : mv)
+        {
+            UTBGDelta d{};
+            Ctx.R->make(S, a, d);
+            Seq.push_back(a);
+            EnumerateTurn(S, Side, Ctx, Seq, Visited, EndSeen, Out, OutSeqs);
+            Seq.pop_back();
+            Ctx.R->unmake(S, d);
+            if (Ctx.bAborted || (int32)Out.size() >= Ctx.MaxEnds) break;
+        }
+    }
+
+    // Distinct end-of-turn positions for S.sideToAct, best first, capped to K. Their action
+    // sequences are appended to OutSeqs.
+    static void GenerateTurnEnds(GameState& S, FTurnPlannerCtx& Ctx, std::vector<FTurnEnd>& Out, std::vector<Action>& OutSeqs)
+    {
+        Out.clear(); OutSeqs.clear();
+        AICore::TScratch<uint64> visitedSlots, endSeenSlots;
+        FKeySetView visited(*visitedSlots), endSeen(*endSeenSlots);
+        visited.Clear(1024); endSeen.Clear(1024);
+        AICore::TScratch<Action> seq;
+        EnumerateTurn(S, S.sideToAct, Ctx, *seq, visited, endSeen, Out, OutSeqs);
+
+        std::stable_sort(Out.begin(), Out.end(), [](const FTurnEnd& A, const FTurnEnd& B) { return A.Score > B.Score; });
+        if (Ctx.K > 0 && (int32)Out.size() > Ctx.K) Out.resize(Ctx.K);
+    }
+
+    struct FScopedTurn
+    {
+        const UTBGRules& R;
+        GameState& S;
+        AICore::TScratch<UTBGDelta> D;
+
+        FScopedTurn(const UTBGRules& InR, GameState& InS, const Action* Seq, int32 Num) : R(InR), S(InS) {
+            D->resize(Num);
+            for (int32 i = 0; i < Num; ++i) R.make(S, Seq[i], (*D)[i]);
+        }
+        ~FScopedTurn() {
+            for (size_t i = D->size(); i-- > 0; ) R.unmake(S, (*D)[i]);
+        }
+    };
+
+    // Negamax over whole turns; value for S.sideToAct at turn start.
+    static int TurnAlphaBeta(GameState& S, int Turns, int Alpha, int Beta, FTurnPlannerCtx& Ctx, std::vector<Action>& OutPV)
+    {
+        OutPV.clear();
+        ++Ctx.TurnNodes;
+        if (Ctx.TM->HardExpired()) Ctx.bAborted = true;
+        if (Turns == 0 || IsTerminal(S) || Ctx.bAborted)
+            return AICore::EvalCached(S, Ctx.E);
+
+        AICore::TScratch<FTurnEnd> endsBuf;
+        AICore::TScratch<Action> seqsBuf, childPVBuf;
+        std::vector<FTurnEnd>& ends = *endsBuf;
+        std::vector<Action>& seqs = *seqsBuf;
+        std::vector<Action>& childPV = *childPVBuf;
+        GenerateTurnEnds(S, Ctx, ends, seqs);
+        if (ends.empty()) return AICore::EvalCached(S, Ctx.E);
+
+        const int side = S.sideToAct;
+        int best = std::numeric_limits<int>::min();
+        for (const FTurnEnd& e : ends)
+        {
+            const Action* seq = seqs.data() + e.First;
+            FScopedTurn turn(*Ctx.R, S, seq, e.Num);
+
+            // a turn that ends the game (king kill) leaves the same side to act: no negation
+            childPV.clear();
+            int sc;
+            if (Turns == 1 || IsTerminal(S)) sc = e.Score;
+            else if (S.sideToAct != side) sc = -TurnAlphaBeta(S, Turns - 1, -Beta, -Alpha, Ctx, childPV);
+            else sc = TurnAlphaBeta(S, Turns - 1, Alpha, Beta, Ctx, childPV);
+
+            if (sc > best) {
+                best = sc;
+                OutPV.assign(seq, seq + e.Num);
+                OutPV.insert(OutPV.end(), childPV.begin(), childPV.end());
+            }
+            if (best > Alpha) Alpha = best;
+            if (Alpha >= Beta || Ctx.bAborted) break;
+        }
+        return best;
+    }
+}
+
+namespace AICore
+{
+    void SearchUTBG_TurnPlanner(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out)
+    {
+        UTBGRules R; R.TurnAP = Req.TurnAP;
+        FTimeManager TM; TM.Start(FTimeBudget{ Req.SoftMs, Req.HardMs, Req.MaxNodes });
+
+        FTurnPlannerCtx Ctx;
+        Ctx.R = &R; Ctx.TM = &TM;
+        TM.CountNodes(&Ctx.Nodes);
+        Ctx.E = EvalWeightsFromCVars();
+        Ctx.O = OrderWeightsFromCVars();
+        Ctx.K = CVarAICore_TurnK.GetValueOnAnyThread();
+        Ctx.MaxEnds = FMath::Max(1, CVarAICore_TurnMaxEnds.GetValueOnAnyThread());
+
+        const int32 MaxTurns = FMath::Max(1, CVarAICore_TurnPlies.GetValueOnAnyThread());
+
+        // iterative deepening in whole turns; an aborted iteration is discarded
+        int completed = 0;
+        for (int turns = 1; turns <= MaxTurns; ++turns)
+        {
+            if (turns > 1 && TM.SoftExpired()) break;
+
+            AICore::TScratch<Action> pv;
+            const int sc = TurnAlphaBeta(S, turns, -kTurnInf, +kTurnInf, Ctx, *pv);
+            if (Ctx.bAborted && !Out.PV.empty()) break;
+
+            Out.PV = *pv;
+            Out.Score = sc;
+            completed = turns;
+            if (Ctx.bAborted) break;
+        }
+
+        Out.Engine = ESearchEngine::TurnPlanner;
+        Out.Nodes = Ctx.Nodes;
+        INC_DWORD_STAT_BY(STAT_AICore_Nodes, (uint32)Out.Nodes);
+        Out.DedupPruned = Ctx.DupPruned;
+        Out.Ms = TM.ElapsedMs();
+
+        UE_LOG(LogAICore, Verbose, TEXT("[TurnPlanner] turns=%d turnNodes=%lld nodes=%lld dupPruned=%lld"),
+            completed, (long long)Ctx.TurnNodes, (long long)Ctx.Nodes, (long long)Ctx.DupPruned);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console
+//////////////////////////////////////////////////////////////////////////
+
+// A king that dies to one hit this turn: at 3 turns of lookahead the kill must be the plan's
+// first action and score as a win (a turn that ends the game keeps the side to act).
+static void RunAICoreTurnPlannerCheck(const TArray<FString>& /*Args*/, UWorld* /*World*/)
+{
+    GameState S;
+    S.width = 5; S.height = 5; S.sideToAct = 0;
+    S.units = { Unit{0,0,12,10,2,true,5}, Unit{1,0,24,10,2,true,5}, Unit{2,1,13,5,2,true,5}, Unit{3,1,0,10,2,true,5} };
+    S.units[2].king = true;
+    S.teamAP[0] = 5; S.teamAP[1] = 5; S.maxAP = 5;
+    S.initZobrist(0xC0FFEEULL, (int)S.units.size());
+
+    UTBGRules R; R.TurnAP = 5;
+    FTimeManager TM; TM.Start(FTimeBudget{ 5000, 10000, 0 });
+    FTurnPlannerCtx Ctx;
+    Ctx.R = &R; Ctx.TM = &TM;
+    Ctx.E = AICore::EvalWeightsFromCVars();
+    Ctx.O = AICore::OrderWeightsFromCVars();
+
+    std::vector<Action> PV;
+    const int Score = TurnAlphaBeta(S, 3, -kTurnInf, +kTurnInf, Ctx, PV);
+    const bool bKill = !PV.empty() && PV[0].type == ActionType::Attack && PV[0].targetId == 2;
+    if (!bKill || Score < AICore::KingWinScore / 2)
+    {
+        UE_LOG(LogAICore, Error, TEXT("[TurnPlannerCheck] FAIL: first type=%d actor=%d target=%d score=%d (expected Attack(0->2), win)"),
+            PV.empty() ? -1 : (int32)PV[0].type, PV.empty() ? -1 : PV[0].actorId, PV.empty() ? -1 : PV[0].targetId, Score);
+        return;
+    }
+    UE_LOG(LogAICore, Log, TEXT("[TurnPlannerCheck] OK score=%d turnNodes=%lld"), Score, (long long)Ctx.TurnNodes);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreTurnPlannerCheck(
+    TEXT("AICore.TurnPlannerCheck"),
+    TEXT("Usage: AICore.TurnPlannerCheck  // a one-turn king kill must be the planner's best move at 3 turns"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreTurnPlannerCheck)
+);
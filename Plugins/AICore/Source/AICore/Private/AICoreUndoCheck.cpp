@@ -4,6 +4,7 @@
 #include "String/LexFromString.h"
 #include "Engine/World.h"  
 #include "rules.h"
+#include "rules_utbg.h"
 #include "rng.h"
 #include <algorithm>
 #include <vector>
@@ -44,4 +45,63 @@ static FAutoConsoleCommandWithWorldAndArgs CmdAICoreUndoCheck(
     TEXT("AICore.UndoCheck"),
     TEXT("Usage: AICore.UndoCheck <steps=100>  // random make/unmake and verify hash"),
     FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreUndoCheck)
-);
\ No newline at end of file
+);
+
+// Random UTBGRules walk: the incremental key must match GameState::computeKey()
+// after every make and after every unmake (HP/alive/teamAP/side included).
+static void RunAICoreHashCheck(const TArray<FString>& Args, UWorld* /*World*/)
+{
+    int32 Steps = 1000;
+    if (Args.Num() >= 1) LexFromString(Steps, *Args[0]);
+
+    GameState S;
+    S.width = 6; S.height = 6; S.sideToAct = 0;
+    S.units = { Unit{0,0,14,10,2,true,3}, Unit{1,0,15,10,2,true,4}, Unit{2,1,20,10,2,true,5}, Unit{3,1,21,10,2,true,3} };
+    // ranged skills with cooldowns so the cooldown tokens/turn clock are exercised too
+    S.units[0].numSkills = 1; S.units[0].skills[0] = SkillSlot{ 2, 1, 3, RangeMetric::Chebyshev, SkillTargets::Enemy, false, 3 };
+    S.units[3].numSkills = 2; S.units[3].skills[0] = SkillSlot{ 1, 2, 2, RangeMetric::Manhattan, SkillTargets::Enemy, true, 4 };
+    S.units[3].skills[1] = SkillSlot{ 1, 0, 4, RangeMetric::Chebyshev, SkillTargets::Any, false, 1 };
+    S.teamAP[0] = 5; S.teamAP[1] = 0; S.maxAP = 5;
+    S.initZobrist(0xC0FFEEULL, (int)S.units.size());
+
+    UTBGRules R; R.TurnAP = 5;
+    XorShift64Star prng(0xABCDEF1234567890ULL);
+    std::vector<UTBGDelta> line;
+
+    for (int iter = 0; iter < Steps; ++iter) {
+        std::vector<Action> moves; R.generateLegal(S, moves);
+        int alive[2] = { 0, 0 };
+        for (const auto& u : S.units) if (u.alive) ++alive[u.team];
+
+        // unwind a few plies at dead ends and every so often, checking each unmake
+        const bool bUnwind = !line.empty() && (alive[0] == 0 || alive[1] == 0 || (prng.next() % 4) == 0);
+        if (bUnwind) {
+            R.unmake(S, line.back()); line.pop_back();
+            if (S.key != S.computeKey()) {
+                UE_LOG(LogAICore, Error, TEXT("[HashCheck] unmake mismatch at iter=%d key=0x%016llX full=0x%016llX"),
+                    iter, (unsigned long long)S.key, (unsigned long long)S.computeKey());
+                return;
+            }
+            continue;
+        }
+        if (moves.empty()) break;
+
+        const Action& a = moves[(size_t)(prng.next() % moves.size())];
+        line.emplace_back();
+        R.make(S, a, line.back());
+        if (S.key != S.computeKey()) {
+            UE_LOG(LogAICore, Error, TEXT("[HashCheck] make mismatch at iter=%d type=%d key=0x%016llX full=0x%016llX"),
+                iter, (int)a.type, (unsigned long long)S.key, (unsigned long long)S.computeKey());
+            return;
+        }
+    }
+    while (!line.empty()) { R.unmake(S, line.back()); line.pop_back(); }
+    UE_LOG(LogAICore, Log, TEXT("[HashCheck] OK for %d iterations (root key %s)"), Steps,
+        S.key == S.computeKey() ? TEXT("restored") : TEXT("MISMATCH"));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAICoreHashCheck(
+    TEXT("AICore.HashCheck"),
+    TEXT("Usage: AICore.HashCheck <steps=1000>  // random UTBG make/unmake, verify incremental key == full recompute"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAICoreHashCheck)
+);
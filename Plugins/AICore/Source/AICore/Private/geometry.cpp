@@ -0,0 +1,51 @@
+#include "geometry.h"
+#include "CoreMinimal.h"
+#include "Misc/ScopeLock.h"
+
+void BoardGeometry::build(int W, int H)
+{
+    width = W; height = H; tiles = W * H;
+    x.resize(tiles); y.resize(tiles);
+    nbrCount.assign(tiles, 0);
+    nbrList.assign((size_t)tiles * 4, -1);
+    for (int t = 0; t < tiles; ++t)
+    {
+        const int tx = t % W, ty = t / W;
+        x[t] = (int16_t)tx; y[t] = (int16_t)ty;
+        // same order as ABoard::ComputeMovables' directions
+        const int nb[4] = { tx + 1 < W ? t + 1 : -1, tx > 0 ? t - 1 : -1, ty + 1 < H ? t + W : -1, ty > 0 ? t - W : -1 };
+        for (int n : nb)
+            if (n >= 0) nbrList[(size_t)t * 4 + nbrCount[t]++] = (int16_t)n;
+    }
+
+    dist.clear();
+    if (tiles <= kMaxTableTiles)
+    {
+        dist.resize(2ull * tiles * tiles);
+        for (int m = 0; m < 2; ++m)
+            for (int a = 0; a < tiles; ++a)
+                for (int b = 0; b < tiles; ++b)
+                    dist[((size_t)m * tiles + a) * tiles + b] = (uint8_t)GridDistance((RangeMetric)m, x[a] - x[b], y[a] - y[b]);
+    }
+
+    masks = RangeMasks{};
+    if (RangeMasks::fits(W, H)) masks.build(W, H);
+}
+
+std::shared_ptr<const BoardGeometry> BoardGeometry::get(int W, int H)
+{
+    if (W <= 0 || H <= 0) return nullptr;
+
+    // a game sees one or two board sizes; kept for the lifetime of the module
+    static FCriticalSection Lock;
+    static std::vector<std::shared_ptr<const BoardGeometry>> Built;
+
+    FScopeLock Guard(&Lock);
+    for (const auto& G : Built)
+        if (G->width == W && G->height == H) return G;
+
+    auto G = std::make_shared<BoardGeometry>();
+    G->build(W, H);
+    Built.push_back(G);
+    return G;
+}
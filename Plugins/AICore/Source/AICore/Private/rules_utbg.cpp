@@ -1,59 +1,221 @@
 #include "rules_utbg.h"
 #include "state.h"
+#include "AICoreArena.h"
+#include "AICoreStats.h"
+
+namespace
+{
+    // Scalar 4-neighbour BFS for boards over 64 tiles (ABoard::ComputeMovables/ComputeAttackables):
+    // OutEmpty = empty tiles within Range steps, OutHit = occupied tiles entered on a step <= Range.
+    void FloodFillScalar(const BoardGeometry& G, const std::vector<int>& TileUnit, int Start, int Range,
+        std::vector<int>& OutEmpty, std::vector<int>& OutHit)
+    {
+        OutEmpty.clear(); OutHit.clear();
+        AICore::TScratch<int> distBuf, queueBuf;
+        std::vector<int>& dist = *distBuf;
+        std::vector<int>& queue = *queueBuf;
+        dist.assign(TileUnit.size(), -1);
+        queue.reserve(TileUnit.size());
+        dist[Start] = 0; queue.push_back(Start);
+        for (size_t qi = 0; qi < queue.size(); ++qi)
+        {
+            const int cur = queue[qi];
+            if (dist[cur] >= Range) continue;
+            const int16* nb = G.neighbors(cur);
+            for (int k = 0, nk = G.neighborCount(cur); k < nk; ++k)
+            {
+                const int n = nb[k];
+                if (dist[n] >= 0) continue;
+                dist[n] = dist[cur] + 1;
+                if (TileUnit[n] >= 0) { OutHit.push_back(n); continue; }   // units block further movement/line
+                OutEmpty.push_back(n);
+                queue.push_back(n);
+            }
+        }
+    }
+}
 
 void UTBGRules::generateLegal(const GameState& S, std::vector<Action>& out) const
 {
     out.clear();
+    generateKinds(S, GenAll, out);
+}
+
+bool UTBGRules::findLegal(const GameState& S, Move m, Action& out) const
+{
+    const ActionType type = m.type();
+    if (type == ActionType::EndTurn) { out = Action{}; out.type = ActionType::EndTurn; out.apCost = 0; return true; }
+    const int actor = m.actorId();
+    if (actor < 0 || actor >= (int)S.units.size()) return false;
+    const Unit& u = S.units[actor];
+    if (!u.alive || u.team != S.sideToAct) return false;
+
+    const uint8 kinds = (type == ActionType::Move) ? GenMoves
+        : (type == ActionType::Attack || type == ActionType::Skill) ? GenAttacks : 0;
+    if (!kinds) return false;
+
+    static thread_local std::vector<Action> mv;
+    mv.clear();
+    generateKinds(S, kinds, mv, actor);
+    for (const Action& a : mv) if (Move::fromAction(a) == m) { out = a; return true; }
+    return false;
+}
+
+int UTBGRules::outcome(const GameState& S)
+{
+    bool hasKing[2] = { false, false }, kingAlive[2] = { false, false };
+    for (const Unit& u : S.units)
+    {
+        if (!u.king || u.team < 0 || u.team > 1) continue;
+        hasKing[u.team] = true;
+        kingAlive[u.team] |= u.alive;
+    }
+    const bool lost0 = hasKing[0] && !kingAlive[0];
+    const bool lost1 = hasKing[1] && !kingAlive[1];
+    if (lost0 && lost1) return kDraw;
+    if (lost0) return 1;
+    if (lost1) return 0;
+    return kOngoing;
+}
+
+void UTBGRules::generateKinds(const GameState& S, uint8 Kinds, std::vector<Action>& out, int OnlyActor) const
+{
+    AICORE_SCOPE_CYCLE(STAT_AICore_MoveGen);
     const int side = S.sideToAct;
     const int pool = S.teamAP[side];
-    const int W = S.width, H = S.height;
+    const BoardGeometry& G = *S.grid;
 
-    auto inBounds = [&](int x, int y) { return x >= 0 && y >= 0 && x < W && y < H; };
-    auto occupied = [&](int tile)->bool {
-        for (const auto& u : S.units) if (u.alive && u.tile == tile) return true;
-        return false;
-        };
+    // Occupancy: bitboards when the board fits in 64 tiles (S.ranges), tile -> unit map otherwise
+    const RangeMasks* B = S.ranges.get();
+    uint64 occ[2] = { 0, 0 };
+    int tileUnit[64];
+    AICore::TScratch<int> tileUnitBuf, floodEmptyBuf, floodHitBuf;     // scalar path (boards over 64 tiles)
+    std::vector<int>& tileUnitVec = *tileUnitBuf;
+    std::vector<int>& floodEmpty = *floodEmptyBuf;
+    std::vector<int>& floodHit = *floodHitBuf;
+    if (B) {
+        for (const auto& v : S.units) {
+            if (!v.alive || v.tile < 0) continue;
+            occ[v.team & 1] |= (1ull << v.tile);
+            tileUnit[v.tile] = v.id;
+        }
+    }
+    else {
+        tileUnitVec.assign((size_t)S.boardSize(), -1);
+        for (const auto& v : S.units) if (v.alive && v.tile >= 0) tileUnitVec[v.tile] = v.id;
+    }
+    const uint64 empty = B ? (B->board & ~(occ[0] | occ[1])) : 0;
 
     for (const auto& u : S.units)
     {
         if (!u.alive || u.team != side) continue;
+        if (OnlyActor >= 0 && u.id != OnlyActor) continue;
 
-        const int x = u.tile % W, y = u.tile / W;
-
-        // Move (ڽƮ üũ)
-        if (pool >= MoveCost)
+        // Move: every empty tile reachable in moveRange steps; AP = MoveCost * Manhattan (ABoard::TryMoveUnit)
+        if ((Kinds & GenMoves) && pool >= MoveCost && u.moveRange > 0)
         {
-            const int dx[4] = { +1,-1,0,0 }, dy[4] = { 0,0,+1,-1 };
-            for (int d = 0; d < 4; ++d)
+            auto pushMove = [&](int nt) {
+                const int cost = MoveCost * FMath::Max(1, G.manhattan(u.tile, nt));
+                if (cost > pool) return;
+                Action a; a.actorId = u.id; a.type = ActionType::Move; a.tileIndex = nt; a.apCost = (uint8)cost;
+                out.push_back(a);
+                };
+
+            if (B)
+            {
+                uint64 reach = 0, frontier = (1ull << u.tile);
+                for (int step = 0; step < u.moveRange && frontier; ++step) {
+                    frontier = B->neighbors(frontier) & empty & ~reach;
+                    reach |= frontier;
+                }
+                while (reach) {
+                    const int nt = (int)FMath::CountTrailingZeros64(reach);
+                    reach &= reach - 1;
+                    pushMove(nt);
+                }
+            }
+            else
             {
-                const int nx = x + dx[d], ny = y + dy[d];
-                if (!inBounds(nx, ny)) continue;
-                const int nt = ny * W + nx;
-                if (occupied(nt)) continue;
+                FloodFillScalar(G, tileUnitVec, u.tile, u.moveRange, floodEmpty, floodHit);
+                for (int nt : floodEmpty) pushMove(nt);
+            }
+        }
 
-                Action a; a.actorId = u.id; a.type = ActionType::Move; a.tileIndex = nt; a.apCost = MoveCost;
+        // Attack: enemies reached by a line of empty tiles within attackRange (ABoard::ComputeAttackables)
+        const int attackCost = (u.attackCost > 0) ? u.attackCost : AttackCost;
+        if ((Kinds & GenAttacks) && pool >= attackCost && u.attackRange > 0)
+        {
+            auto pushAttack = [&](int targetId) {
+                Action a; a.actorId = u.id; a.type = ActionType::Attack; a.targetId = targetId; a.apCost = (uint8)attackCost;
                 out.push_back(a);
+                };
+
+            if (B)
+            {
+                // distance mask first: no enemy within Manhattan range -> no flood fill
+                const uint64 enemies = occ[side ^ 1] & B->get(RangeMetric::Manhattan, u.attackRange, u.tile);
+                uint64 targets = 0;
+                if (enemies) {
+                    uint64 seen = (1ull << u.tile), frontier = seen;
+                    for (int step = 0; step < u.attackRange && frontier; ++step) {
+                        const uint64 nb = B->neighbors(frontier) & ~seen;
+                        targets |= nb & enemies;
+                        seen |= nb;
+                        frontier = nb & empty;
+                    }
+                }
+                while (targets) {
+                    const int t = (int)FMath::CountTrailingZeros64(targets);
+                    targets &= targets - 1;
+                    pushAttack(tileUnit[t]);
+                }
+            }
+            else
+            {
+                FloodFillScalar(G, tileUnitVec, u.tile, u.attackRange, floodEmpty, floodHit);
+                for (int t : floodHit)
+                    if (S.units[tileUnitVec[t]].team != u.team) pushAttack(tileUnitVec[t]);
             }
         }
 
-        // Attack (, ڽƮ üũ)
-        if (pool >= AttackCost)
+        // Skill (range bitboard & target occupancy; distance check on boards > 64 tiles)
+        for (int s = 0; (Kinds & GenAttacks) && s < u.numSkills; ++s)
         {
-            for (const auto& v : S.units)
+            const SkillSlot& sk = u.skills[s];
+            if (sk.damage <= 0 || pool < sk.apCost || S.turn < u.readyTurn[s]) continue;
+
+            auto push = [&](int targetId, int targetTile) {
+                Action a; a.actorId = u.id; a.type = ActionType::Skill; a.skillId = (uint8)s;
+                a.targetId = targetId; a.tileIndex = targetTile; a.apCost = sk.apCost;
+                out.push_back(a);
+                };
+
+            if (B)
             {
-                if (!v.alive || v.team == u.team) continue;
-                const int vx = v.tile % W, vy = v.tile / W;
-                const int manhattan = FMath::Abs(x - vx) + FMath::Abs(y - vy);
-                if (manhattan == 1)
+                uint64 cand = B->get(sk.metric, sk.range, u.tile) & ~(1ull << u.tile);
+                cand &= (sk.targets == SkillTargets::Enemy) ? occ[side ^ 1]
+                    : (sk.targets == SkillTargets::Ally) ? occ[side] : (occ[0] | occ[1]);
+                while (cand) {
+                    const int t = (int)FMath::CountTrailingZeros64(cand);
+                    cand &= cand - 1;
+                    push(tileUnit[t], t);
+                }
+            }
+            else
+            {
+                for (const auto& v : S.units)
                 {
-                    Action a; a.actorId = u.id; a.type = ActionType::Attack; a.targetId = v.id; a.apCost = AttackCost;
-                    out.push_back(a);
+                    if (!v.alive || v.tile < 0 || v.id == u.id) continue;
+                    if (sk.targets == SkillTargets::Enemy && v.team == u.team) continue;
+                    if (sk.targets == SkillTargets::Ally && v.team != u.team) continue;
+                    if (G.distance(sk.metric, u.tile, v.tile) <= sk.range) push(v.id, v.tile);
                 }
             }
         }
     }
 
     // ׻ EndTurn 1 ߰ (actorId  )
+    if (Kinds & GenEndTurn)
     {
         Action e; e.actorId = -1; e.type = ActionType::EndTurn; e.apCost = 0;
         out.push_back(e);
@@ -62,13 +224,14 @@ void UTBGRules::generateLegal(const GameState& S, std::vector<Action>& out) cons
 
 void UTBGRules::FlipSideInPlace(GameState& S)
 {
-    S.key ^= S.Z.sideToAct[S.sideToAct];
+    S.xorSideToAct(S.sideToAct);
     S.sideToAct ^= 1;
-    S.key ^= S.Z.sideToAct[S.sideToAct];
+    S.xorSideToAct(S.sideToAct);
 }
 
 void UTBGRules::make(GameState& S, const Action& a, Delta& d) const
 {
+    AICORE_SCOPE_CYCLE(STAT_AICore_MakeUnmake);
     UTBGDelta& dx = static_cast<UTBGDelta&>(d);
     dx.SideBefore = (uint8)S.sideToAct;
     dx.APBefore[0] = (int16)S.teamAP[0];
@@ -85,6 +248,7 @@ void UTBGRules::make(GameState& S, const Action& a, Delta& d) const
     {
         dx.bFlippedTurn = 1;
         FlipSideInPlace(S);
+        S.advanceTurn();
 
         if (S.Z.maxAP > 0)
         {
@@ -110,10 +274,13 @@ void UTBGRules::make(GameState& S, const Action& a, Delta& d) const
             S.teamAP[side] = FMath::Max(0, S.teamAP[side] - a.apCost);
         }
 
-        if (S.teamAP[side] == 0)
+        const bool bSkillEndsTurn = (a.type == ActionType::Skill && a.actorId >= 0
+            && a.skillId < S.units[a.actorId].numSkills && S.units[a.actorId].skills[a.skillId].endsTurn);
+        if (S.teamAP[side] == 0 || bSkillEndsTurn)
         {
             dx.bFlippedTurn = 1;
             FlipSideInPlace(S);
+            S.advanceTurn();
 
             if (S.Z.maxAP > 0)
             {
@@ -131,11 +298,15 @@ void UTBGRules::make(GameState& S, const Action& a, Delta& d) const
 
 void UTBGRules::unmake(GameState& S, const Delta& d) const
 {
+    AICORE_SCOPE_CYCLE(STAT_AICore_MakeUnmake);
     const UTBGDelta& dx = static_cast<const UTBGDelta&>(d);
 
     // 1)  ȯ ߾ٸ  sideToAct 
     if (dx.bFlippedTurn)
+    {
         FlipSideInPlace(S);
+        --S.turn;
+    }
 
     // 2)  AP () + Ű 
     if (S.Z.maxAP > 0)
@@ -0,0 +1,18 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "nnue.h"
+#include <memory>
+
+namespace AICore
+{
+    // Load a quantized network file (relative paths resolve under Content/). false on failure.
+    // The new net replaces the current one for later searches; running searches keep theirs.
+    bool LoadNNUENetwork(const FString& Path, FString* OutError = nullptr);
+
+    // Currently published network, nullptr if none. On the game thread the first call loads
+    // AICore.NNUEPath; other threads only read what is published.
+    std::shared_ptr<const NNUENetwork> GetNNUENetwork();
+
+    // Bumped on every successful load (used to invalidate the TT).
+    uint32 GetNNUENetworkVersion();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "AICoreSearch.h"
+#include "state.h"
+
+// Process-wide search scheduler for servers hosting several matches.
+//
+//  - fixed worker pool (AICore.SchedWorkers), searches never run on the caller's thread
+//  - per-match jobs: one running job per match; every match owns a TT partition of
+//    AICore.SchedTTMB (the per-job memory budget) instead of sharing GAICoreTT
+//  - fair share: the next job comes from the match that has used the least search time
+//  - time slicing: alpha-beta jobs run in AICore.SchedSliceMs slices while other matches
+//    wait; the job keeps its paused search (FIncrementalSearchUTBG) and the next slice resumes
+//    it where it stopped, its clock stopped in between.
+//    MCTS / turn planner jobs are not resumable and run to completion on one worker, and so do
+//    node-budgeted jobs (Req.MaxNodes), whose result must not depend on the slicing.
+namespace AICore
+{
+    using FSearchMatchId = uint64;
+
+    struct FScheduledSearchResult
+    {
+        FUTBGSearchResult Result;   // the job's search, however many slices it took
+        double QueueWaitMs = 0.0;   // submit -> first slice, plus every wait between slices
+        int32  Slices = 0;
+        bool   bCancelled = false;
+    };
+
+    struct FSchedulerStats
+    {
+        int32  Workers = 0;
+        int32  Matches = 0;
+        int32  Queued = 0;
+        int32  Running = 0;
+        int64  JobsDone = 0;
+        int64  Slices = 0;
+        double WaitAvgMs = 0.0;     // queue-wait per slice over the recent window
+        double WaitP95Ms = 0.0;
+        double WaitMaxMs = 0.0;
+    };
+
+    class AICORE_API FSearchScheduler
+    {
+    public:
+        static FSearchScheduler& Get();
+
+        // Queue a search of S for a match. S should already have its eval backend attached
+        // (AttachEvalBackend, game thread). Req.TT and Req.Threads are set by the scheduler.
+        TFuture<FScheduledSearchResult> Submit(FSearchMatchId Match, GameState&& S, const FUTBGSearchRequest& Req);
+
+        // Drop the match's queued jobs (their futures complete with bCancelled). A running slice finishes.
+        void Cancel(FSearchMatchId Match);
+
+        // Cancel and free the match's TT partition once it is idle.
+        void ReleaseMatch(FSearchMatchId Match);
+
+        FSchedulerStats GetStats() const;
+
+        // Module shutdown: stop the workers, cancel everything still queued.
+        static void Shutdown();
+
+        ~FSearchScheduler();
+
+    private:
+        FSearchScheduler() = default;
+        struct FImpl;
+        TUniquePtr<FImpl> Impl;
+    };
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "state.h"
+#include <vector>
+
+class TTable;
+
+namespace AICore
+{
+    // Score of a decided match (UTBGRules::outcome) for the winner; alpha-beta subtracts the plies
+    // to the king kill, so nearer kills score higher.
+    constexpr int32 KingWinScore = 1000000;
+
+    enum class ESearchEngine : uint8
+    {
+        AlphaBeta = 0,
+        MCTS = 1,
+        TurnPlanner = 2,
+    };
+
+    struct FUTBGSearchRequest
+    {
+        int32 SoftMs = 300;
+        int32 HardMs = 350;
+        int32 MaxDepth = 5;         // AlphaBeta plies / MCTS PV length
+        int32 TurnAP = 5;           // UTBGRules::TurnAP
+        ESearchEngine Engine = ESearchEngine::AlphaBeta;
+        int32 Threads = 0;          // MCTS workers (0 = auto)
+        TTable* TT = nullptr;       // AlphaBeta TT (nullptr = the process-wide table; not thread-safe)
+        int32 MultiPV = 1;          // AlphaBeta: root moves returned with a score of their own (Lines)
+        int64 MaxNodes = 0;         // AlphaBeta/TurnPlanner: > 0 = node budget instead of SoftMs/HardMs,
+                                    // identical PV on every run for the same TT contents (MCTS ignores it)
+        int32 KingProofTurns = 0;   // > 0: first try to prove a forced king kill within this many own turns
+        int64 KingProofNodes = 5000;    // proof-number search budget (positions made)
+        int32 Difficulty = -1;      // AICore.Difficulty preset the defaults came from (0 easy, 1 normal, 2 hard, -1 none); logged only
+    };
+
+    // One root move and its line, scored for the side to act at the root
+    struct FRootLine
+    {
+        std::vector<Action> PV;
+        int32 Score = 0;
+    };
+
+    struct FUTBGSearchResult
+    {
+        ESearchEngine Engine = ESearchEngine::AlphaBeta;
+        std::vector<Action> PV;
+        int32  Score = 0;
+        int64  Nodes = 0;           // AlphaBeta/TurnPlanner nodes, MCTS tree nodes
+        int64  Playouts = 0;        // MCTS only
+        int64  DedupPruned = 0;     // children skipped by child-key dedup
+        int64  CommutePruned = 0;   // children skipped as non-canonical orderings of commuting actions
+        int64  SeePruned = 0;       // AlphaBeta quiescence attacks skipped as losing exchanges (AICore.QSee)
+        int64  EvalCacheProbes = 0; // AlphaBeta static evals through the eval hash
+        int64  EvalCacheHits = 0;
+        int64  TTProbes = 0;        // AlphaBeta TT lookups (through the mirror-image key with AICore.Symmetry)
+        int64  TTHits = 0;          // entries deep enough to use
+        double Ms = 0.0;
+        std::vector<double> DepthMs;    // AlphaBeta: Ms at which each iteration (depth 1, 2, ..) completed
+        bool   bKingProof = false;  // PV is this turn's part of a proven king kill; the engine did not run
+        int64  ProofNodes = 0;      // proof-number search positions (KingProofTurns > 0)
+        int64  ArenaMisses = 0;     // scratch leases/state clones the search arena had to create or grow
+        std::vector<FRootLine> Lines;   // best first, Lines[0] is PV/Score (AlphaBeta: up to MultiPV; others: the PV)
+
+        double PlayoutsPerSec() const { return (Ms > 0.0) ? (double)Playouts / (Ms / 1000.0) : 0.0; }
+    };
+
+    // UTBGRules search for S.sideToAct. S is restored on return.
+    AICORE_API bool SearchUTBG(GameState& S, const FUTBGSearchRequest& Req, FUTBGSearchResult& Out);
+
+    // Alpha-beta search that runs in slices on the caller's thread (listen servers: the game
+    // thread, a few ms per frame) and resumes where it stopped. Searches a private copy of the
+    // root; only time spent inside Step() counts against SoftMs/HardMs, so the result is the one
+    // SearchUTBG (AlphaBeta) returns for the same budget. Uses Req.TT or the process-wide table.
+    class AICORE_API FIncrementalSearchUTBG
+    {
+    public:
+        FIncrementalSearchUTBG();
+        ~FIncrementalSearchUTBG();
+
+        // bLog: write the finished search to the search log (FSearchScheduler logs its own, with the queue wait)
+        void Start(const GameState& S, const FUTBGSearchRequest& Req, bool bLog = true);
+
+        // Run for SliceUs microseconds and/or SliceSteps search steps (<= 0: unlimited).
+        // True once the search has finished (or there was nothing to search).
+        bool Step(int32 SliceUs, int32 SliceSteps = 0);
+
+        bool IsRunning() const;
+        const FUTBGSearchResult& GetResult() const;     // valid after Step() returned true
+
+        // Drop the search in progress.
+        void Reset();
+
+    private:
+        struct FImpl;
+        TUniquePtr<FImpl> Impl;
+    };
+
+    // AICore.Engine CVar, or the AICore.Difficulty preset when it is -1
+    AICORE_API ESearchEngine GetDefaultSearchEngine();
+
+    // AICore.MultiPV / AICore.PickMargin, or the AICore.Difficulty preset when they are -1
+    AICORE_API int32 GetDefaultMultiPV();
+    AICORE_API int32 GetDefaultPickMargin();
+
+    // AICore.NodeBudget, or the AICore.Difficulty preset's node budget when it is -1 (0 = wall clock)
+    AICORE_API int64 GetDefaultNodeBudget();
+
+    // AICore.Difficulty preset in effect (0 easy, 1 normal, 2 hard, -1 none), for FUTBGSearchRequest::Difficulty
+    AICORE_API int32 GetDefaultDifficulty();
+
+    // AICore.KingProofTurns / AICore.KingProofNodes (0 turns = no proof search)
+    AICORE_API int32 GetDefaultKingProofTurns();
+    AICORE_API int64 GetDefaultKingProofNodes();
+
+    // Index into Res.Lines of the line to play: a seeded pick among the lines scoring within
+    // Margin of the best (0 when Margin <= 0 or there is a single line).
+    AICORE_API int32 PickRootLine(const FUTBGSearchResult& Res, int32 Margin, uint64 Seed);
+
+    // Search arena misses (scratch vectors, pooled GameState clones) since startup, all threads:
+    // leases that had to create or grow a buffer. A miss may be several heap allocations, and
+    // allocations outside the arenas are not counted. Flat once the buffers have grown to the
+    // positions being searched.
+    AICORE_API int64 GetSearchArenaMisses();
+
+    // AICore.EvalBackend for S (NNUE accumulator). Game thread, before handing S to SearchUTBG.
+    AICORE_API void AttachEvalBackend(GameState& S);
+}
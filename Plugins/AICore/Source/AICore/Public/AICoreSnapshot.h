@@ -22,11 +22,20 @@ struct FSnapshotBuildConfig
 namespace AICore
 {
     // 忡 FGameState  .   false.
-    bool BuildSnapshotFromWorld(UWorld* World, const FSnapshotBuildConfig& Cfg,
+    AICORE_API bool BuildSnapshotFromWorld(UWorld* World, const FSnapshotBuildConfig& Cfg,
         GameState& Out, FString* OutDebugInfo = nullptr);
 
     //   ӽ UnitId  ʱȭ
-    void ResetSnapshotUnitIds();
+    AICORE_API void ResetSnapshotUnitIds();
+
+    // Typed snapshot source registered by the game module (AICore cannot see its types).
+    // BuildSnapshotFromWorld asks it first; returning false falls back to the reflection scan.
+    using FSnapshotProvider = TFunction<bool(UWorld*, const FSnapshotBuildConfig&, GameState&, FString*)>;
+    AICORE_API void SetSnapshotProvider(FSnapshotProvider Provider);     // empty function unregisters
+
+    // Zobrist tables kept across snapshots: copies them into S when they cover its units/board,
+    // regenerates (and keeps) them otherwise, then sets S.key. Replaces S.initZobrist(seed, n).
+    AICORE_API void InitSnapshotZobrist(GameState& S, uint64 Seed);
 }
 
 const TArray<TWeakObjectPtr<APawnBase>>& GetLastUnitLUT();
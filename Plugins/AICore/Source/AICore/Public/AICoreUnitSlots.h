@@ -0,0 +1,51 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Dense, stable unit ids (GameState::units indices) for one match.
+// A unit keeps its slot while it lives. Released slots are reused lowest-first and free
+// slots at the tail are trimmed, so Num() == highest live slot + 1 and the per-unit tables
+// (GameState::units, Zobrist unitPos/unitHP/unitCD) are sized tightly by it.
+// Slots in [0, Num()) that are not live become dead placeholder units in a snapshot.
+class FUnitSlotAllocator
+{
+public:
+    void Reset() { Live.Reset(); FreeHeap.Reset(); NumLive = 0; }
+
+    int32 Acquire()
+    {
+        ++NumLive;
+        if (FreeHeap.Num() > 0)
+        {
+            int32 Slot = INDEX_NONE;
+            FreeHeap.HeapPop(Slot, TLess<int32>());
+            Live[Slot] = true;
+            return Slot;
+        }
+        return Live.Add(true);
+    }
+
+    void Release(int32 Slot)
+    {
+        if (!IsLive(Slot)) return;
+        Live[Slot] = false;
+        --NumLive;
+
+        if (Slot != Live.Num() - 1)
+        {
+            FreeHeap.HeapPush(Slot, TLess<int32>());
+            return;
+        }
+        while (Live.Num() > 0 && !Live.Last()) Live.Pop(EAllowShrinking::No);
+        FreeHeap.RemoveAll([this](int32 S) { return S >= Live.Num(); });
+        FreeHeap.Heapify(TLess<int32>());
+    }
+
+    FORCEINLINE bool  IsLive(int32 Slot) const { return Live.IsValidIndex(Slot) && Live[Slot]; }
+    FORCEINLINE int32 Num() const { return Live.Num(); }
+    FORCEINLINE int32 NumLiveSlots() const { return NumLive; }
+
+private:
+    TArray<bool>  Live;         // slot -> in use
+    TArray<int32> FreeHeap;     // min-heap of released slots below Num()
+    int32 NumLive = 0;
+};
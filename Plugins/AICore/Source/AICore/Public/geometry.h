@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "skill.h"
+
+// Distance of a (dx, dy) offset in tiles under a skill metric
+inline int GridDistance(RangeMetric m, int dx, int dy) {
+    dx = std::abs(dx); dy = std::abs(dy);
+    return (m == RangeMetric::Chebyshev) ? std::max(dx, dy) : dx + dy;
+}
+
+inline int SkillDistance(RangeMetric m, int a, int b, int W) {
+    return GridDistance(m, a % W - b % W, a / W - b / W);
+}
+
+// Per-tile "within range r" bitboards for both metrics (boards up to 64 tiles),
+// plus the edge masks for 4-neighbour flood fills (unit moves / blocked attacks).
+struct RangeMasks {
+    int width = 0, height = 0, maxRange = 0;
+    std::vector<uint64_t> mask;     // [(metric * (maxRange+1) + r) * N + tile]
+    uint64_t board = 0;             // all tiles
+    uint64_t notFirstCol = 0;       // x != 0
+    uint64_t notLastCol = 0;        // x != W-1
+
+    static bool fits(int W, int H) { return W > 0 && H > 0 && W * H <= 64; }
+
+    void build(int W, int H) {
+        width = W; height = H;
+        maxRange = std::max(0, W + H - 2);          // covers the whole board in both metrics
+        const int N = W * H;
+        mask.assign(2ull * (maxRange + 1) * N, 0);
+        board = notFirstCol = notLastCol = 0;
+        for (int t = 0; t < N; ++t) {
+            board |= (1ull << t);
+            if (t % W != 0) notFirstCol |= (1ull << t);
+            if (t % W != W - 1) notLastCol |= (1ull << t);
+        }
+        for (int m = 0; m < 2; ++m)
+            for (int t = 0; t < N; ++t)
+                for (int o = 0; o < N; ++o) {
+                    const int dist = SkillDistance((RangeMetric)m, t, o, W);
+                    // a tile within dist is within every larger range too
+                    for (int r = dist; r <= maxRange; ++r)
+                        mask[((size_t)m * (maxRange + 1) + r) * N + t] |= (1ull << o);
+                }
+    }
+
+    // tiles 4-adjacent to any tile of b
+    inline uint64_t neighbors(uint64_t b) const {
+        return (((b << 1) & notFirstCol) | ((b >> 1) & notLastCol) | (b << width) | (b >> width)) & board;
+    }
+
+    inline uint64_t get(RangeMetric m, int r, int tile) const {
+        if (r < 0) return 0;
+        if (r > maxRange) r = maxRange;
+        return mask[((size_t)m * (maxRange + 1) + r) * (size_t)(width * height) + tile];
+    }
+};
+
+// Tile geometry of one board size: coordinates, 4-neighbour lists and distance tables,
+// built once per size (BoardGeometry::get) and shared read-only by every state, search
+// thread and ABoard. Tiles are indexed y * width + x as everywhere else.
+struct AICORE_API BoardGeometry {
+    static constexpr int kMaxTableTiles = 256;  // distance tables up to 16x16; larger boards use the coordinates
+
+    int width = 0, height = 0, tiles = 0;
+    std::vector<int16_t> x, y;          // [tile]
+    std::vector<uint8_t> nbrCount;      // [tile]: 4-neighbours on the board
+    std::vector<int16_t> nbrList;       // [tile * 4 + k], k < nbrCount: in +x, -x, +y, -y order
+    std::vector<uint8_t> dist;          // [(metric * tiles + a) * tiles + b] (empty above kMaxTableTiles)
+    RangeMasks masks;                   // empty (width 0) when the board exceeds 64 tiles
+
+    // Shared geometry of a W x H board (nullptr for an empty board). Thread-safe; the first
+    // call for a size builds it, later calls return the same instance.
+    static std::shared_ptr<const BoardGeometry> get(int W, int H);
+
+    void build(int W, int H);
+
+    inline int distance(RangeMetric m, int a, int b) const {
+        if (!dist.empty()) return dist[((size_t)m * tiles + a) * tiles + b];
+        return GridDistance(m, x[a] - x[b], y[a] - y[b]);
+    }
+    inline int manhattan(int a, int b) const { return distance(RangeMetric::Manhattan, a, b); }
+    inline int chebyshev(int a, int b) const { return distance(RangeMetric::Chebyshev, a, b); }
+
+    inline int neighborCount(int tile) const { return nbrCount[tile]; }
+    inline const int16_t* neighbors(int tile) const { return &nbrList[(size_t)tile * 4]; }
+
+    inline bool hasMasks() const { return masks.width != 0; }
+};
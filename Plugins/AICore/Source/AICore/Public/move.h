@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include "action.h"
+
+// Packed 32-bit action for the search hot path (TT, killers, move picker bookkeeping).
+// Holds what identifies an action within a position; the AP cost of moves/attacks/skills and a
+// skill's target tile follow from the position, so turning a Move back into an Action means
+// matching it against generated actions (UTBGRules::findLegal, AICore::FindAction).
+// Codes compare and hash directly; the type sits in the top bits, like Action::signature().
+//  bits  0..13  operand + 1: tile (Move), target unit (Attack/Skill), AP cost (Pass); 0 = none
+//  bits 14..24  actor + 1 (0 = none)
+//  bits 25..27  skill slot
+//  bits 28..30  ActionType
+struct Move {
+    static constexpr uint32_t kOperandBits = 14, kActorBits = 11;
+    static constexpr uint32_t kOperandMask = (1u << kOperandBits) - 1;
+    static constexpr uint32_t kActorMask = (1u << kActorBits) - 1;
+    static constexpr uint32_t kNone = (uint32_t)ActionType::Pass << 28;
+
+    uint32_t code = kNone;      // default: Pass by no unit, i.e. "no move"
+
+    static Move pack(ActionType type, int actorId, int operand, uint8_t skillId) {
+        Move m;
+        m.code = ((uint32_t)type << 28)
+            | (((uint32_t)skillId & 7u) << 25)
+            | (((uint32_t)(actorId + 1) & kActorMask) << kOperandBits)
+            | ((uint32_t)(operand + 1) & kOperandMask);
+        return m;
+    }
+
+    static Move fromAction(const Action& a) {
+        const int operand = (a.type == ActionType::Move) ? a.tileIndex
+            : (a.type == ActionType::Attack || a.type == ActionType::Skill) ? a.targetId
+            : (a.type == ActionType::Pass) ? (int)a.apCost : -1;
+        return pack(a.type, a.actorId, operand, a.skillId);
+    }
+
+    ActionType type() const { return (ActionType)((code >> 28) & 7u); }
+    int actorId() const { return (int)((code >> kOperandBits) & kActorMask) - 1; }
+    int operand() const { return (int)(code & kOperandMask) - 1; }
+    uint8_t skillId() const { return (uint8_t)((code >> 25) & 7u); }
+    bool isNone() const { return code == kNone; }
+
+    bool operator==(Move o) const { return code == o.code; }
+    bool operator!=(Move o) const { return code != o.code; }
+    bool operator<(Move o) const { return code < o.code; }
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AICORE_NNUE_AVX2 1
+#else
+#define AICORE_NNUE_AVX2 0
+#endif
+
+// NNUE-style evaluator: (relative team, HP bucket, tile) one-hot features
+// -> int16 accumulator per perspective -> int8 affine -> int8 output.
+constexpr int kNNUEHPBuckets = 4;
+constexpr int kNNUEHidden = 64;      // accumulator width per perspective
+constexpr int kNNUEL1 = 32;          // first dense layer
+constexpr int kNNUEL1Shift = 6;      // int32 -> [0,127] activation scale
+
+inline int NNUEHPBucket(int hp) {
+    return (hp <= 3) ? 0 : (hp <= 6) ? 1 : (hp <= 9) ? 2 : 3;
+}
+
+struct NNUENetwork {
+    int boardSize = 0;
+    int numFeatures = 0;                        // 2 * kNNUEHPBuckets * boardSize
+    std::vector<int16_t> featureWeights;        // [numFeatures][kNNUEHidden]
+    int16_t featureBias[kNNUEHidden] = {};
+    int8_t  l1Weights[kNNUEL1][2 * kNNUEHidden] = {};
+    int32_t l1Bias[kNNUEL1] = {};
+    int8_t  outWeights[kNNUEL1] = {};
+    int32_t outBias = 0;
+    int32_t outScale = 16;                      // raw output / outScale -> eval units
+    uint32_t version = 0;                       // AICore::GetNNUENetworkVersion() when it was loaded
+
+    inline int featureIndex(int relTeam, int hp, int tile) const {
+        return (relTeam * kNNUEHPBuckets + NNUEHPBucket(hp)) * boardSize + tile;
+    }
+};
+
+// Accumulator lives inside GameState and is updated in make/unmake.
+// Net == nullptr means the classic Eval is used and no updates are done.
+struct NNUEAccumulator {
+    const NNUENetwork* Net = nullptr;
+    alignas(32) int16_t v[2][kNNUEHidden];     // [perspective][hidden]
+
+    inline void reset() {
+        for (int p = 0; p < 2; ++p)
+            std::memcpy(v[p], Net->featureBias, sizeof(v[p]));
+    }
+
+    // sign = +1 (add) / -1 (sub); applied for both perspectives
+    inline void update(int team, int hp, int tile, int sign) {
+        if (!Net || tile < 0 || tile >= Net->boardSize) return;
+        for (int p = 0; p < 2; ++p) {
+            const int f = Net->featureIndex(team == p ? 0 : 1, hp, tile);
+            const int16_t* w = &Net->featureWeights[(size_t)f * kNNUEHidden];
+            int16_t* acc = v[p];
+#if AICORE_NNUE_AVX2
+            for (int i = 0; i < kNNUEHidden; i += 16) {
+                const __m256i a = _mm256_load_si256((const __m256i*)(acc + i));
+                const __m256i b = _mm256_loadu_si256((const __m256i*)(w + i));
+                _mm256_store_si256((__m256i*)(acc + i), sign > 0 ? _mm256_add_epi16(a, b) : _mm256_sub_epi16(a, b));
+            }
+#else
+            if (sign > 0) { for (int i = 0; i < kNNUEHidden; ++i) acc[i] += w[i]; }
+            else          { for (int i = 0; i < kNNUEHidden; ++i) acc[i] -= w[i]; }
+#endif
+        }
+    }
+    inline void add(int team, int hp, int tile) { update(team, hp, tile, +1); }
+    inline void sub(int team, int hp, int tile) { update(team, hp, tile, -1); }
+};
+
+// side-to-act relative score (AICoreNNUE.cpp)
+int32_t NNUEEvaluate(const NNUEAccumulator& acc, int sideToAct);
@@ -1,6 +1,7 @@
 #pragma once
 #include "rules.h"
 #include "state.h"
+#include "move.h"
 // UTBG Ÿ: team AP/side  
 struct UTBGDelta : public Delta
 {
@@ -19,7 +20,7 @@ struct UTBGDelta : public Delta
 };
 
 //  AP Ǯ  Ģ
-struct UTBGRules
+struct AICORE_API UTBGRules
 {
     // ڽƮ &    AP (UTBG ⺻ 5)
     int MoveCost = 1;
@@ -30,6 +31,20 @@ struct UTBGRules
     // չ   (teamAP )
     void generateLegal(const GameState& S, std::vector<Action>& out) const;
 
+    // Staged generation (move picker): appends the legal actions of the given kinds, in
+    // generateLegal order; OnlyActor >= 0 restricts it to one unit (EndTurn is never restricted).
+    enum EGenKinds : uint8 { GenAttacks = 1, GenMoves = 2, GenEndTurn = 4, GenAll = 7 };   // GenAttacks: attacks + skills
+    void generateKinds(const GameState& S, uint8 Kinds, std::vector<Action>& out, int OnlyActor = -1) const;
+
+    // The action generateLegal would produce for m, if any (TT/killer moves); generates only the actor's actions.
+    bool findLegal(const GameState& S, Move m, Action& out) const;
+
+    // Match result as AUTBGGameMode::ResolveEndCheck decides it: a team that has kings loses once
+    // all of them are dead. The winning team (0/1), kDraw when both lost, kOngoing otherwise.
+    static constexpr int kOngoing = -1;
+    static constexpr int kDraw = 2;
+    static int outcome(const GameState& S);
+
     //  /ǵ (teamAP /ȯ )
     void make(GameState& S, const Action& a, Delta& d) const;
     void unmake(GameState& S, const Delta& d) const;
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+// Unit-targeted damage skills as seen by the search (loaded from USkillData at snapshot time).
+// Action::skillId is the slot index on the acting unit.
+
+constexpr int kMaxUnitSkills = 4;
+
+enum class RangeMetric : uint8_t { Chebyshev, Manhattan };
+enum class SkillTargets : uint8_t { Enemy, Ally, Any };
+
+struct SkillSlot {
+    uint8_t      apCost = 1;
+    uint8_t      cooldown = 0;      // owner turns (UUnitSkillsComponent::StartCooldown)
+    uint8_t      range = 1;
+    RangeMetric  metric = RangeMetric::Chebyshev;
+    SkillTargets targets = SkillTargets::Enemy;
+    bool         endsTurn = false;
+    int16_t      damage = 0;
+    uint8_t      dataIndex = 0;     // index into UUnitSkillsComponent::Skills (execution)
+};
@@ -2,8 +2,13 @@
 #include <vector>
 #include <cstdint>
 #include <algorithm>
+#include <memory>
 #include "zobrist.h"
+#include "skill.h"
+#include "geometry.h"
 #include "action.h"
+#include "nnue.h"
+#include "symmetry.h"
 
 struct Unit {
     int  id = -1;
@@ -13,6 +18,15 @@ struct Unit {
     int  ap = 2;        //  AP -> team ap  
     bool alive = true;
     int  attack = 5;
+    int  moveRange = 1;     // flood-fill steps through empty tiles (APawnBase::MoveRange)
+    int  attackRange = 1;   // same, ending on an enemy (APawnBase::AttackRange)
+    int  attackCost = 0;    // 0 = UTBGRules::AttackCost
+    bool king = false;      // APawnBase::bIsKing: a team loses once all its kings are dead (UTBGRules::outcome)
+
+    // skill slots (Action::skillId); usable once GameState::turn >= readyTurn[slot]
+    int       numSkills = 0;
+    SkillSlot skills[kMaxUnitSkills];
+    int       readyTurn[kMaxUnitSkills] = {};
 };
 
 
@@ -33,6 +47,9 @@ struct Delta {
     bool  changedAP = false;    //  AP -> team ap  
     bool  targetChangedHP = false;
     bool  targetChangedAlive = false;
+
+    int   skillSlot = -1;       // Skill: actor slot whose cooldown was started
+    int   prevReadyTurn = 0;
 };
 
 struct GameState {
@@ -42,19 +59,108 @@ struct GameState {
     std::vector<Unit> units;
 
     int teamAP[2] = { 0, 0 };
+    int turn = 0;          // side flips since the snapshot (skill cooldown clock)
 
     Zobrist Z;
     uint64_t key = 0;
     std::vector<Delta> stack;
 
+    NNUEAccumulator nnue;   // NNUE backend (nnue.Net == nullptr -> classic Eval)
+    std::shared_ptr<const NNUENetwork> nnueNet;     // owns nnue.Net for as long as the state (and its copies) use it
+
+    std::shared_ptr<const BoardGeometry> grid;  // shared per board size (initZobrist)
+    std::shared_ptr<const RangeMasks> ranges;   // grid->masks, nullptr if the board exceeds 64 tiles
+
+    std::shared_ptr<const SymmetryMap> sym;     // mirror images tracked by make/unmake (initSymmetry; nullptr = none)
+    uint64_t symKey[SymmetryMap::kMax] = {};    // key of each mirror image
+    std::vector<uint64_t> symStack;             // symKey before each make, sym->count per entry
+
     int boardSize() const { return width * height; }
 
+    // Tile distance (geometry tables; coordinates before initZobrist)
+    int distance(RangeMetric m, int a, int b) const {
+        return grid ? grid->distance(m, a, b) : SkillDistance(m, a, b, width);
+    }
+    int manhattan(int a, int b) const { return distance(RangeMetric::Manhattan, a, b); }
+
+    // NNUE: attach (or detach with nullptr) and rebuild the accumulator from scratch
+    inline void refreshNNUE(std::shared_ptr<const NNUENetwork> net) {
+        if (net && net->boardSize != boardSize()) net.reset();
+        nnueNet = std::move(net);
+        nnue.Net = nnueNet.get();
+        if (!nnue.Net) return;
+        nnue.reset();
+        for (const auto& u : units)
+            if (u.alive && u.tile >= 0) nnue.add(u.team, u.hp, u.tile);
+    }
+
+    // HP + alive + static stats token of one unit (position is keyed separately), keyed as unit id
+    inline uint64_t unitStateKey(const Unit& u, int id) const {
+        if (Z.unitHP.empty() || u.id < 0) return 0;
+        const uint64_t stats = (uint64_t)(uint16_t)u.attack | ((uint64_t)(uint8_t)u.moveRange << 16)
+            | ((uint64_t)(uint8_t)u.attackRange << 24) | ((uint64_t)(uint8_t)u.attackCost << 32);
+        uint64_t k = Z.unitHP[Z.idxUnitHP(id, u.alive ? u.hp : 0)] ^ Z.unitStats(id, stats);
+        if (u.alive) k ^= Z.unitAlive[id];
+        return k;
+    }
+    inline uint64_t unitStateKey(const Unit& u) const { return unitStateKey(u, u.id); }
+
+    // Incremental key tokens; each also updates the mirror images' keys (relabelled unit,
+    // mirrored tile, swapped side).
+    inline void xorUnitPos(int id, int tile) {
+        key ^= Z.unitPos[Z.idxUnitPos(id, tile)];
+        if (sym) for (int s = 0; s < sym->count; ++s)
+            symKey[s] ^= Z.unitPos[Z.idxUnitPos(sym->t[s].unit[id], sym->t[s].tile[tile])];
+    }
+    inline void xorUnitHP(int id, int hp) {
+        key ^= Z.unitHP[Z.idxUnitHP(id, hp)];
+        if (sym) for (int s = 0; s < sym->count; ++s) symKey[s] ^= Z.unitHP[Z.idxUnitHP(sym->t[s].unit[id], hp)];
+    }
+    inline void xorUnitAlive(int id) {
+        key ^= Z.unitAlive[id];
+        if (sym) for (int s = 0; s < sym->count; ++s) symKey[s] ^= Z.unitAlive[sym->t[s].unit[id]];
+    }
+    inline void xorSideToAct(int side) {
+        key ^= Z.sideToAct[side];
+        if (sym) for (int s = 0; s < sym->count; ++s) symKey[s] ^= Z.sideToAct[sym->t[s].swapSides ? side ^ 1 : side];
+    }
+
+    // remaining cooldown (in side turns) of a skill slot; keyed while > 0
+    inline int cooldownLeft(const Unit& u, int slot) const { return std::max(0, u.readyTurn[slot] - turn); }
+    inline void xorCooldown(const Unit& u, int slot) {
+        const int rem = cooldownLeft(u, slot);
+        if (rem <= 0 || Z.unitCD.empty()) return;
+        key ^= Z.unitCD[Z.idxUnitCD(u.id, slot, rem)];
+        if (sym) for (int s = 0; s < sym->count; ++s) symKey[s] ^= Z.unitCD[Z.idxUnitCD(sym->t[s].unit[u.id], slot, rem)];
+    }
+
+    // damage dealt by an Attack/Skill (0 for other actions)
+    inline int damageOf(const Action& a) const {
+        if (a.actorId < 0 || a.actorId >= (int)units.size()) return 0;
+        const Unit& A = units[a.actorId];
+        if (a.type == ActionType::Attack) return A.attack > 0 ? A.attack : 5;
+        if (a.type == ActionType::Skill && a.skillId < A.numSkills) return A.skills[a.skillId].damage;
+        return 0;
+    }
+
+    // Side flip: tick the cooldown clock (UUnitSkillsComponent::OnTurnStarted equivalent).
+    // Undone by --turn; the key comes back with Delta::prevZ.
+    inline void advanceTurn() {
+        for (const auto& u : units)
+            for (int s = 0; s < u.numSkills; ++s) xorCooldown(u, s);
+        ++turn;
+        for (const auto& u : units)
+            for (int s = 0; s < u.numSkills; ++s) xorCooldown(u, s);
+    }
+
     // ߿: teamAP ū XOR 
     inline void xorTeamAP(int side, int ap) {
         if (Z.maxAP > 0) {
             if (ap < 0) ap = 0;
             if (ap > Z.maxAP) ap = Z.maxAP;
             key ^= Z.teamAP[Z.idxTeamAP(side, ap)];
+            if (sym) for (int s = 0; s < sym->count; ++s)
+                symKey[s] ^= Z.teamAP[Z.idxTeamAP(sym->t[s].swapSides ? side ^ 1 : side, ap)];
         }
     }
 
@@ -63,22 +169,140 @@ struct GameState {
         // teamAP[]  ä · ȣǾ (  )
         const int inferredMaxAP = std::max(teamAP[0], teamAP[1]);  //   
         const int zMaxAP = std::max(inferredMaxAP, maxAP);         //   ū 
-        Z.init(seed, maxUnits, boardSize(), zMaxAP);
+        int zMaxHP = 0, zMaxCD = 0;
+        for (const auto& u : units) {
+            zMaxHP = std::max(zMaxHP, u.hp);
+            for (int s = 0; s < u.numSkills; ++s)
+                zMaxCD = std::max({ zMaxCD, 2 * (int)u.skills[s].cooldown, cooldownLeft(u, s) });
+        }
+        Z.init(seed, maxUnits, boardSize(), zMaxAP, zMaxHP, zMaxCD);
+
+        key = computeKey();
+        refreshSymmetryKeys();
+
+        // per-board tables are rebuilt together with the Zobrist tables
+        if (!grid || grid->width != width || grid->height != height) {
+            grid = BoardGeometry::get(width, height);
+            if (grid && grid->hasMasks()) ranges = std::shared_ptr<const RangeMasks>(grid, &grid->masks);
+            else ranges.reset();
+        }
+    }
 
-        key = 0;
+    // Full key from scratch; make/unmake keep `key` equal to this incrementally.
+    // With a transform: the key of that mirror image (symKey).
+    uint64_t computeKey(const SymmetryMap::Transform* T = nullptr) const {
+        const int swap = (T && T->swapSides) ? 1 : 0;
+        uint64_t k = 0;
         // side
-        key ^= Z.sideToAct[sideToAct];
+        k ^= Z.sideToAct[sideToAct ^ swap];
 
-        // unit positions
+        // unit positions / HP / alive / attack
         for (const auto& u : units) {
+            const int id = T ? T->unit[u.id] : u.id;
             if (u.alive && u.tile >= 0) {
-                key ^= Z.unitPos[Z.idxUnitPos(u.id, u.tile)];
+                k ^= Z.unitPos[Z.idxUnitPos(id, T ? T->tile[u.tile] : u.tile)];
+            }
+            k ^= unitStateKey(u, id);
+            for (int s = 0; s < u.numSkills; ++s) {
+                const int rem = cooldownLeft(u, s);
+                if (rem > 0 && !Z.unitCD.empty()) k ^= Z.unitCD[Z.idxUnitCD(id, s, rem)];
             }
         }
 
         // teamAP (  XOR)
-        xorTeamAP(0, teamAP[0]);
-        xorTeamAP(1, teamAP[1]);
+        if (Z.maxAP > 0) {
+            k ^= Z.teamAP[Z.idxTeamAP(swap, teamAP[0])];
+            k ^= Z.teamAP[Z.idxTeamAP(swap ^ 1, teamAP[1])];
+        }
+        return k;
+    }
+
+    // Finds the mirror images the position maps onto itself under (interchangeable units on
+    // mirrored tiles, in the same state) and starts tracking their keys. Flips are tried
+    // left/right first, then with the sides swapped; at most SymmetryMap::kMax are kept.
+    void initSymmetry() {
+        clearSymmetry();
+        const int N = boardSize();
+        const int U = (int)units.size();
+        if (N <= 0 || U == 0 || Z.unitPos.empty()) return;
+
+        std::vector<int> at(N, -1);
+        for (const auto& u : units)
+            if (u.alive && u.tile >= 0 && u.tile < N) at[u.tile] = u.id;
+
+        auto interchangeable = [&](const Unit& a, const Unit& b) {
+            if (a.alive != b.alive || a.king != b.king) return false;
+            if (!a.alive || a.tile < 0) return true;      // off the board only the team and king flag matter
+            if (a.hp != b.hp || a.attack != b.attack || a.moveRange != b.moveRange || a.attackRange != b.attackRange
+                || a.attackCost != b.attackCost || a.numSkills != b.numSkills) return false;
+            for (int s = 0; s < a.numSkills; ++s) {
+                const SkillSlot& x = a.skills[s];
+                const SkillSlot& y = b.skills[s];
+                if (x.apCost != y.apCost || x.cooldown != y.cooldown || x.range != y.range || x.metric != y.metric
+                    || x.targets != y.targets || x.endsTurn != y.endsTurn || x.damage != y.damage
+                    || cooldownLeft(a, s) != cooldownLeft(b, s)) return false;
+            }
+            return true;
+        };
+
+        struct Candidate { bool flipX, flipY, swapSides; };
+        static const Candidate kCandidates[] = {
+            { true, false, false }, { false, true, true }, { true, true, true },
+            { false, true, false }, { true, true, false }, { true, false, true },
+        };
+
+        auto m = std::make_shared<SymmetryMap>();
+        for (const Candidate& c : kCandidates) {
+            if (m->count == SymmetryMap::kMax) break;
+            SymmetryMap::Transform T;
+            T.swapSides = c.swapSides;
+            T.tile.resize(N);
+            for (int t = 0; t < N; ++t) {
+                const int x = t % width, y = t / width;
+                T.tile[t] = (c.flipX ? width - 1 - x : x) + (c.flipY ? height - 1 - y : y) * width;
+            }
+            T.unit.assign(U, -1);
+            T.unitInv.assign(U, -1);
+
+            bool ok = true;
+            for (const auto& u : units) {
+                if (!u.alive || u.tile < 0 || u.tile >= N) continue;
+                const int j = at[T.tile[u.tile]];
+                if (j < 0 || units[j].team != (u.team ^ (int)c.swapSides) || !interchangeable(u, units[j])) { ok = false; break; }
+                T.unit[u.id] = j;
+                T.unitInv[j] = u.id;
+            }
+            for (int i = 0; ok && i < U; ++i) {
+                if (T.unit[i] >= 0) continue;
+                const Unit& u = units[i];
+                int j = 0;
+                for (; j < U; ++j)
+                    if (T.unitInv[j] < 0 && units[j].team == (u.team ^ (int)c.swapSides) && interchangeable(u, units[j])) break;
+                if (j == U) ok = false;
+                else { T.unit[i] = j; T.unitInv[j] = i; }
+            }
+            if (ok) m->t[m->count++] = std::move(T);
+        }
+        if (m->count == 0) return;
+        sym = std::move(m);
+        refreshSymmetryKeys();
+    }
+
+    void clearSymmetry() { sym.reset(); symStack.clear(); }
+
+    void refreshSymmetryKeys() {
+        if (!sym) return;
+        for (int s = 0; s < sym->count; ++s) symKey[s] = computeKey(&sym->t[s]);
+    }
+
+    // Smallest of the keys of the position and its mirror images (the TT key); image = index
+    // into sym->t of the image it belongs to, -1 for the position itself.
+    inline uint64_t canonicalKey(int& image) const {
+        image = -1;
+        uint64_t k = key;
+        if (sym) for (int s = 0; s < sym->count; ++s)
+            if (symKey[s] < k) { k = symKey[s]; image = s; }
+        return k;
     }
 
     //  : ġ/HP/(/AP/̵  꿡!)
@@ -86,6 +310,7 @@ struct GameState {
         d = {};
         d.prevZ = key;
         d.actorId = a.actorId;
+        if (sym) symStack.insert(symStack.end(), symKey, symKey + sym->count);
         
         if (a.actorId >= 0) {
             auto& A = units[a.actorId];
@@ -101,29 +326,46 @@ struct GameState {
         if (a.type == ActionType::Move && d.actorId >= 0) {
             auto& A = units[d.actorId];
             if (A.alive && A.tile >= 0) {
-                key ^= Z.unitPos[Z.idxUnitPos(A.id, A.tile)];
+                xorUnitPos(A.id, A.tile);
+                nnue.sub(A.team, A.hp, A.tile);
                 A.tile = a.tileIndex;
                 d.changedPos = true;
-                key ^= Z.unitPos[Z.idxUnitPos(A.id, A.tile)];
+                xorUnitPos(A.id, A.tile);
+                nnue.add(A.team, A.hp, A.tile);
             }
         }
-        else if (a.type == ActionType::Attack && a.targetId >= 0) {
+        else if ((a.type == ActionType::Attack || a.type == ActionType::Skill) && a.targetId >= 0) {
+            if (a.type == ActionType::Skill && a.actorId >= 0 && a.skillId < units[a.actorId].numSkills) {
+                auto& A = units[a.actorId];
+                d.skillSlot = a.skillId;
+                d.prevReadyTurn = A.readyTurn[a.skillId];
+                xorCooldown(A, a.skillId);
+                A.readyTurn[a.skillId] = turn + 2 * A.skills[a.skillId].cooldown;   // back at the owner's turn start
+                xorCooldown(A, a.skillId);
+            }
+
             auto& T = units[a.targetId];
             d.targetId = a.targetId;
             d.prevTargetHP = T.hp;
             d.prevTargetAlive = T.alive;
 
-            const int dmg = (a.actorId >= 0 && a.actorId < (int)units.size() && units[a.actorId].attack > 0) ? units[a.actorId].attack : 5;
+            const int dmg = (a.type == ActionType::Attack && a.actorId < 0) ? 5 : damageOf(a);
+            if (T.alive) nnue.sub(T.team, T.hp, T.tile);
+            const bool bHashHP = !Z.unitHP.empty() && T.alive;
+            if (bHashHP) xorUnitHP(T.id, T.hp);
             T.hp -= dmg;
             d.targetChangedHP = true;
+            if (T.alive && T.hp > 0) nnue.add(T.team, T.hp, T.tile);
 
             if (T.hp <= 0 && T.alive) {
                 T.alive = false;
                 d.targetChangedAlive = true;
                 if (T.tile >= 0) {
-                    key ^= Z.unitPos[Z.idxUnitPos(T.id, T.tile)];
+                    xorUnitPos(T.id, T.tile);
                 }
+                if (bHashHP) xorUnitAlive(T.id);
             }
+            if (bHashHP) xorUnitHP(T.id, T.alive ? T.hp : 0);
         }
         // EndTurn/Pass ⼭  ó  ( ȯ/ AP Rules ó)
         stack.push_back(d);
@@ -132,6 +374,16 @@ struct GameState {
     inline void unmake(const Delta& d) {
         // NOTE: teamAP/ ȯ UTBGRules::unmake()  ǵ ,
         // ⿡ /HP/Ǹ ǵϴ. (Ű prevZ )
+        if (d.targetId >= 0) {
+            auto& T = units[d.targetId];
+            if (T.alive) nnue.sub(T.team, T.hp, T.tile);
+            if (d.prevTargetAlive) nnue.add(T.team, d.prevTargetHP, T.tile);
+        }
+        if (d.actorId >= 0 && d.changedPos) {
+            auto& A = units[d.actorId];
+            nnue.sub(A.team, A.hp, A.tile);
+            nnue.add(A.team, d.prevActorHP, d.prevActorTile);
+        }
         if (d.actorId >= 0) {
             auto& A = units[d.actorId];
             A.tile = d.prevActorTile;
@@ -139,11 +391,18 @@ struct GameState {
             A.hp = d.prevActorHP;
             A.alive = d.prevActorAlive;
         }
+        if (d.skillSlot >= 0) units[d.actorId].readyTurn[d.skillSlot] = d.prevReadyTurn;
         if (d.targetId >= 0) {
             auto& T = units[d.targetId];
             T.hp = d.prevTargetHP;
             T.alive = d.prevTargetAlive;
         }
+        if (!stack.empty()) stack.pop_back();
+        if (sym && symStack.size() >= (size_t)sym->count) {
+            const size_t base = symStack.size() - sym->count;
+            std::copy(symStack.begin() + base, symStack.end(), symKey);
+            symStack.resize(base);
+        }
         key = d.prevZ; // ü Ű 
     }
 };
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "move.h"
+
+// Mirror images of a position: the board flipped left/right, up/down or both, optionally with
+// the two sides swapped, and every unit relabelled onto an interchangeable one (same stats; the
+// other team when the sides swap). A mirror image plays exactly like the original, so both can
+// share one TT entry. GameState::initSymmetry keeps the images under which the root maps onto
+// itself; make/unmake then maintain each image's Zobrist key next to GameState::key.
+struct SymmetryMap {
+    static constexpr int kMax = 3;
+
+    struct Transform {
+        bool swapSides = false;
+        std::vector<int> tile;      // tile -> mirrored tile (each flip is its own inverse)
+        std::vector<int> unit;      // unit id -> id in the image
+        std::vector<int> unitInv;   // id in the image -> unit id
+    };
+
+    int count = 0;
+    Transform t[kMax];
+
+    // A move of the position as the same move in image s, and back. Out-of-range ids (a TT
+    // entry from a key collision) come back as Move{}.
+    Move toImage(Move m, int s) const { return map(m, t[s].unit, t[s].tile); }
+    Move fromImage(Move m, int s) const { return map(m, t[s].unitInv, t[s].tile); }
+
+private:
+    static Move map(Move m, const std::vector<int>& units, const std::vector<int>& tiles) {
+        if (m.isNone()) return m;
+        const ActionType type = m.type();
+        int actor = m.actorId();
+        int operand = m.operand();
+        if (actor >= (int)units.size()) return Move{};
+        if (actor >= 0) actor = units[actor];
+        if (type == ActionType::Move && operand >= 0) {
+            if (operand >= (int)tiles.size()) return Move{};
+            operand = tiles[operand];
+        }
+        else if ((type == ActionType::Attack || type == ActionType::Skill) && operand >= 0) {
+            if (operand >= (int)units.size()) return Move{};
+            operand = units[operand];
+        }
+        return Move::pack(type, actor, operand, m.skillId());
+    }
+};
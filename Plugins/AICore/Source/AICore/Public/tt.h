@@ -2,18 +2,19 @@
 #include <cstdint>
 #include <vector>
 #include <climits>
-#include "action.h"
+#include "move.h"
 
 enum class ETTBound : uint8_t { Exact = 0, Lower = 1, Upper = 2 };
 
 struct TTEntry {
     uint64_t  Key = 0;
-    int16_t   Depth = INT16_MIN;       // INT16_MIN̸ " " 
     int32_t   Score = 0;
-    ETTBound  Bound = ETTBound::Exact;
-    Action    BestMove{};              // PV / 
+    Move      BestMove{};              // PV / 
+    int16_t   Depth = INT16_MIN;       // INT16_MIN̸ " " 
     uint16_t  Age = 0;                 // ü å
+    ETTBound  Bound = ETTBound::Exact;
 };
+static_assert(sizeof(TTEntry) == 24, "TTEntry: keep the fields ordered by size (two entries per 48-byte bucket)");
 
 struct TTBucket { TTEntry E[2]; };
 
@@ -51,7 +52,7 @@ public:
         return false;
     }
 
-    void Store(uint64_t key, int16_t depth, int32_t score, ETTBound bound, const Action& best, uint16_t age) {
+    void Store(uint64_t key, int16_t depth, int32_t score, ETTBound bound, Move best, uint16_t age) {
         if (Table.empty()) return;
         TTBucket& B = Table[Index(key)];
 
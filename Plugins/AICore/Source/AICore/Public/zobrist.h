@@ -2,23 +2,46 @@
 #include <vector>
 #include <cstdint>
 #include "rng.h"
+#include "skill.h"
 
 struct Zobrist {
-    int maxUnits = 0, boardSize = 0, maxAP = 0;
+    int maxUnits = 0, boardSize = 0, maxAP = 0, maxHP = 0, maxCD = 0;
     std::vector<uint64_t> sideToAct;  // [2]
     std::vector<uint64_t> unitPos;    // [maxUnits * boardSize]
     std::vector<uint64_t> teamAP;     // [2 * (maxAP+1)]
+    std::vector<uint64_t> unitHP;     // [maxUnits * (maxHP+1)], 0 = dead/0 HP
+    std::vector<uint64_t> unitAlive;  // [maxUnits]
+    std::vector<uint64_t> unitCD;     // [maxUnits * kMaxUnitSkills * (maxCD+1)], remaining side-turns
+    uint64_t statSeed = 0;            // static per-unit stats (attack, ranges, costs) are mixed, not tabled
+    uint64_t seedUsed = 0;
 
-    void init(uint64_t seed, int maxUnits_, int boardSize_, int maxAP_) {
-        maxUnits = maxUnits_; boardSize = boardSize_; maxAP = maxAP_;
+    // Tables that already cover the request (same seed and board, capacities not smaller)
+    // are kept as they are: nothing is regenerated and keys stay stable across snapshots.
+    bool covers(uint64_t seed, int maxUnits_, int boardSize_, int maxAP_, int maxHP_, int maxCD_) const {
+        return !sideToAct.empty() && seedUsed == seed && boardSize == boardSize_
+            && maxUnits_ <= maxUnits && maxAP_ <= maxAP && maxHP_ <= maxHP && maxCD_ <= maxCD;
+    }
+
+    void init(uint64_t seed, int maxUnits_, int boardSize_, int maxAP_, int maxHP_ = 0, int maxCD_ = 0) {
+        if (covers(seed, maxUnits_, boardSize_, maxAP_, maxHP_ > 0 ? maxHP_ : 0, maxCD_ > 0 ? maxCD_ : 0)) return;
+        seedUsed = seed;
+        maxUnits = maxUnits_; boardSize = boardSize_; maxAP = maxAP_; maxHP = maxHP_ > 0 ? maxHP_ : 0;
+        maxCD = maxCD_ > 0 ? maxCD_ : 0;
         sideToAct.resize(2);
         unitPos.resize((size_t)maxUnits * boardSize);
         teamAP.resize(2ull * (maxAP + 1));
+        unitHP.resize((size_t)maxUnits * (maxHP + 1));
+        unitAlive.resize((size_t)maxUnits);
+        unitCD.resize((size_t)maxUnits * kMaxUnitSkills * (maxCD + 1));
 
         SplitMix64 rng(seed);
         for (int i = 0; i < 2; ++i) sideToAct[i] = rng.next();
         for (size_t i = 0; i < unitPos.size(); ++i) unitPos[i] = rng.next();
         for (size_t i = 0; i < teamAP.size(); ++i) teamAP[i] = rng.next();
+        for (size_t i = 0; i < unitHP.size(); ++i) unitHP[i] = rng.next();
+        for (size_t i = 0; i < unitAlive.size(); ++i) unitAlive[i] = rng.next();
+        statSeed = rng.next();
+        for (size_t i = 0; i < unitCD.size(); ++i) unitCD[i] = rng.next();
     }
     inline size_t idxUnitPos(int unitId, int tile) const {
         return (size_t)unitId * boardSize + tile;
@@ -27,4 +50,17 @@ struct Zobrist {
         if (ap < 0) ap = 0; if (ap > maxAP) ap = maxAP;
         return (size_t)side * (maxAP + 1) + (size_t)ap;
     }
+    // HP above the init-time maximum shares the top bucket (HP only goes down in search)
+    inline size_t idxUnitHP(int unitId, int hp) const {
+        if (hp < 0) hp = 0; if (hp > maxHP) hp = maxHP;
+        return (size_t)unitId * (maxHP + 1) + (size_t)hp;
+    }
+    inline size_t idxUnitCD(int unitId, int slot, int remaining) const {
+        if (remaining > maxCD) remaining = maxCD;
+        return ((size_t)unitId * kMaxUnitSkills + slot) * (maxCD + 1) + (size_t)remaining;
+    }
+    inline uint64_t unitStats(int unitId, uint64_t packedStats) const {
+        SplitMix64 m(statSeed ^ ((uint64_t)(uint32_t)unitId * 0xD6E8FEB86659FD93ULL) ^ packedStats);
+        return m.next();
+    }
 };
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include "Kismet/GameplayStatics.h"
 #include "PlayerController/UTBGPlayerController.h"
 #include "GameState/UTBGGameState.h"
+#include "Subsystem/AISnapshotSubsystem.h"
+#include "geometry.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/Engine.h" 
 
@@ -28,6 +30,12 @@ static const TCHAR* ToStr(EHighlightType T)
 static FString Pt(const FIntPoint& P) { return FString::Printf(TEXT("(%d,%d)"), P.X, P.Y); }
 static FString Obj(const UObject* O) { return FString::Printf(TEXT("%s[%p]"), *GetNameSafe(O), O); }
 
+static UAISnapshotSubsystem* AISnapshot(const UObject* O)
+{
+	const UWorld* World = O ? O->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAISnapshotSubsystem>() : nullptr;
+}
+
 static FString JoinPoints(const TSet<FIntPoint>& S)
 {
 	TArray<FString> A; A.Reserve(S.Num());
@@ -147,6 +155,8 @@ void ABoard::RegisterPawn(APawnBase* Pawn)
 	PawnGrid[Index] = Pawn; //   ׸忡  ֱ
 
 	Pawn->SetActorLocation(GridToWorld(GridCoord) + Pawn->PawnOffset);
+
+	if (UAISnapshotSubsystem* Snapshot = AISnapshot(this)) Snapshot->NotifyPawnRegistered(this, Pawn);
 }
 
 void ABoard::UnRegisterPawn(APawnBase* Pawn)
@@ -161,6 +171,7 @@ void ABoard::UnRegisterPawn(APawnBase* Pawn)
 			if (bDebugBoardLogs) UE_LOG(LogBoard, Warning, TEXT("UnRegisterPawn: %s @ %s idx=%d"),
 				*GetNameSafe(Pawn), *Pt(Coordinate), Index);
 			PawnGrid[Index] = nullptr;
+			if (UAISnapshotSubsystem* Snapshot = AISnapshot(this)) Snapshot->NotifyPawnUnregistered(Pawn);
 			return;
 		}
 	}
@@ -209,6 +220,8 @@ void ABoard::MulticastUnitMoved_Implementation(APawnBase* Unit, FIntPoint From,
 		if (PawnGrid.IsValidIndex(NewIdx))
 			PawnGrid[NewIdx] = Unit;
 
+		if (UAISnapshotSubsystem* Snapshot = AISnapshot(this)) Snapshot->NotifyPawnMoved(Unit, To);
+
 		const FIntPoint Before = Unit->GetGridCoord();
 		if (bDebugBoardLogs)
 			UE_LOG(LogBoard, Warning, TEXT("[HL]   ClientUnitCoord: before=%s"), *Pt(Before));
@@ -240,6 +253,7 @@ void ABoard::UpdatePawnCell(APawnBase* Pawn, const FIntPoint& Prev, const FIntPo
 		if (PawnGrid.IsValidIndex(NewIdx))
 			PawnGrid[NewIdx] = Pawn;
 	}
+	if (UAISnapshotSubsystem* Snapshot = AISnapshot(this)) Snapshot->NotifyPawnMoved(Pawn, New);
 }
 
 void ABoard::HighlightTile(const FIntPoint& T, EHighlightType Type)
@@ -543,45 +557,45 @@ void ABoard::ComputeAttackables(APawnBase* Unit, TSet<FIntPoint>& Out) const
 	const FIntPoint CurrentCoord	= Unit->GetGridCoord();
 	const int32		Range			= Unit->AttackRange;
 
-	TQueue<TPair<FIntPoint, int32>> Q;
-	TSet<FIntPoint> Visited;
-	
-	Q.Enqueue({ CurrentCoord, 0 });
-	Visited.Add(CurrentCoord);
+	const std::shared_ptr<const BoardGeometry> Geo = BoardGeometry::get(Cols, Rows);
+	if (!Geo || !IsValidCoord(CurrentCoord)) return;
 
-	const FIntPoint Directions[4] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+	// BFS over tile indices with the shared neighbour lists (AICore generates attacks the same way)
+	TArray<int32, TInlineAllocator<64>> Queue;
+	TArray<int32, TInlineAllocator<64>> Cost;
+	Cost.Init(-1, Geo->tiles);
 
-	while (!Q.IsEmpty())
+	const int32 Start = ToIndex(CurrentCoord);
+	Cost[Start] = 0;
+	Queue.Add(Start);
+
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
 	{
-		TPair<FIntPoint, int32> Cur; Q.Dequeue(Cur);
-		const FIntPoint			Coord = Cur.Key;
-		const int32				Cost = Cur.Value;
+		const int32 Cur = Queue[Head];
+		if (Cost[Cur] + 1 > Range) continue;
 
-		for (const FIntPoint& Dir : Directions)
+		const int16* Nbr = Geo->neighbors(Cur);
+		for (int32 k = 0; k < Geo->neighborCount(Cur); ++k)
 		{
-			FIntPoint Next(Coord.X + Dir.X, Coord.Y + Dir.Y);
-
-			if (!IsValidCoord(Next) || Visited.Contains(Next))	continue;
-			if (Cost + 1 > Range)								continue;
-
-			Visited.Add(Next);
+			const int32 Next = Nbr[k];
+			if (Cost[Next] >= 0) continue;
+			Cost[Next] = Cost[Cur] + 1;
 
-			const int32 index = ToIndex(Next);
-			if (!PawnGrid.IsValidIndex(index)) continue;
-			APawnBase* PawnAtNext = PawnGrid[index].Get();
+			if (!PawnGrid.IsValidIndex(Next)) continue;
+			APawnBase* PawnAtNext = PawnGrid[Next].Get();
 			if (PawnAtNext)
 			{
 				//  ִ Ÿ
 				if (UTeamUtils::AreEnemyTeam(PawnAtNext, Unit))
 				{
-					Out.Add(Next); // ̸  
+					Out.Add(FIntPoint(Geo->x[Next], Geo->y[Next])); // ̸  
 				}
 				//   þ  -  ̻  
 			}
 			else
 			{
 				//  Ÿ̸  
-				Q.Enqueue({ Next, Cost + 1 });
+				Queue.Add(Next);
 			}
 		}
 	}
@@ -598,33 +612,34 @@ void ABoard::ComputeMovables(APawnBase* Unit, TSet<FIntPoint>& Out)
 	if (bDebugBoardLogs) UE_LOG(LogBoard, Warning, TEXT("ComputeMovables: Start=%s Range=%d"),
 		*Pt(CurrentCoord), Range);
 
-	TQueue<TPair<FIntPoint, int32>> Q;
-	TSet<FIntPoint> Visited;
-	
-	Q.Enqueue({ CurrentCoord, 0 });
-	Visited.Add(CurrentCoord);
+	const std::shared_ptr<const BoardGeometry> Geo = BoardGeometry::get(Cols, Rows);
+	if (!Geo || !IsValidCoord(CurrentCoord)) return;
+
+	TArray<int32, TInlineAllocator<64>> Queue;
+	TArray<int32, TInlineAllocator<64>> Cost;
+	Cost.Init(-1, Geo->tiles);
 
-	const FIntPoint Directions[4] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+	const int32 Start = ToIndex(CurrentCoord);
+	Cost[Start] = 0;
+	Queue.Add(Start);
 
-	while (!Q.IsEmpty())
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
 	{
-		TPair<FIntPoint, int32> Cur; Q.Dequeue(Cur);
-		const FIntPoint			Coord	= Cur.Key;
-		const int32				Cost	= Cur.Value;
+		const int32 Cur = Queue[Head];
+		if (Cost[Cur] + 1 > Range) continue;
 
-		for (const FIntPoint& Dir : Directions)
+		const int16* Nbr = Geo->neighbors(Cur);
+		for (int32 k = 0; k < Geo->neighborCount(Cur); ++k)
 		{
-			FIntPoint Next(Coord.X + Dir.X, Coord.Y + Dir.Y);
-			if (!IsValidCoord(Next) || Visited.Contains(Next))	continue;
-			if (Cost + 1 > Range)								continue;
+			const int32 Next = Nbr[k];
+			if (Cost[Next] >= 0) continue;
+			Cost[Next] = Cost[Cur] + 1;		// occupied tiles are final too: nothing passes through them
 
-			const int32 index = ToIndex(Next);
-			if (!PawnGrid.IsValidIndex(index)) continue;
-			if (PawnGrid[index] == nullptr)
+			if (!PawnGrid.IsValidIndex(Next)) continue;
+			if (PawnGrid[Next] == nullptr)
 			{
-				Out.Add(Next);
-				Visited.Add(Next);
-				Q.Enqueue({ Next, Cost + 1 });
+				Out.Add(FIntPoint(Geo->x[Next], Geo->y[Next]));
+				Queue.Add(Next);
 			}
 		}
 	}
@@ -702,7 +717,7 @@ bool ABoard::TryAttackUnit(APawnBase* Attacker, APawnBase* Target)
 		return false;
 	}
 	
-	const int32 Cost = Attacker->AttackCost;
+	const int32 Cost = FMath::Max(1, Attacker->AttackCost);		// 0 would be a free attack; AICore charges 1
 	if (!UTBGGamesState->TrySpendAPForActor(Attacker, Cost))
 	{
 		if (bDebugBoardLogs) UE_LOG(LogBoard, Warning, TEXT("[ATTACK] FAIL: Cannot spend AP cost=%d"), Cost);
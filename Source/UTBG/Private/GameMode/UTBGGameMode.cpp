@@ -13,6 +13,7 @@
 #include "TimerManager.h"
 #include "Pawn/PawnBase.h"
 #include "GamePlay/Team/Team.h" 
+#include "GamePlay/AI/UTBGAITeamController.h"
 
 AUTBGGameMode::AUTBGGameMode()
 {
@@ -91,6 +92,22 @@ void AUTBGGameMode::HandleMatchHasStarted()
 	}
 
 	BindExistingPawns();
+	SpawnAIOpponent();
+}
+
+void AUTBGGameMode::SpawnAIOpponent()
+{
+	if (!HasAuthority() || AIOpponentTeam == ETeam::ET_NoTeam || IsValid(AIOpponent)) return;
+
+	UClass* Class = AIControllerClass ? AIControllerClass.Get() : AUTBGAITeamController::StaticClass();
+	FActorSpawnParameters Params;
+	Params.Owner = this;
+	AIOpponent = GetWorld()->SpawnActor<AUTBGAITeamController>(Class, Params);
+	if (AIOpponent)
+	{
+		AIOpponent->AITeam = AIOpponentTeam;
+		UE_LOG(LogTemp, Log, TEXT("[GM] AI opponent spawned for team %d"), static_cast<int32>(AIOpponentTeam));
+	}
 }
 
 void AUTBGGameMode::BeginPlay()
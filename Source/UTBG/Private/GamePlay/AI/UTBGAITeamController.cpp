@@ -0,0 +1,353 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GamePlay/AI/UTBGAITeamController.h"
+#include "Board/Board.h"
+#include "Pawn/PawnBase.h"
+#include "Data/SkillData.h"
+#include "GameState/UTBGGameState.h"
+#include "Subsystem/AISnapshotSubsystem.h"
+#include "UTBGComponents/UnitSkillsComponent.h"
+#include "rules_utbg.h"
+
+#include "Animation/AnimMontage.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUTBGAI, Log, All);
+
+namespace
+{
+	FString ActionToString(const Action& A)
+	{
+		switch (A.type)
+		{
+		case ActionType::Move:    return FString::Printf(TEXT("Move(u=%d->%d)"), A.actorId, A.tileIndex);
+		case ActionType::Attack:  return FString::Printf(TEXT("Attack(u=%d->t=%d)"), A.actorId, A.targetId);
+		case ActionType::Skill:   return FString::Printf(TEXT("Skill(u=%d#%d->t=%d)"), A.actorId, (int32)A.skillId, A.targetId);
+		case ActionType::EndTurn: return TEXT("EndTurn");
+		default:                  return FString::Printf(TEXT("Pass(u=%d)"), A.actorId);
+		}
+	}
+
+	// Does the live board still match the state the PV predicts?
+	// Compared per unit (alive/tile/HP/cooldowns) rather than by key: a unit that died on the board
+	// loses its slot (and the tail is trimmed) while the predicted state keeps it as a dead unit.
+	bool MatchesExpected(const GameState& Expected, const GameState& Live)
+	{
+		if (Expected.width != Live.width || Expected.height != Live.height) return false;
+		if (Expected.sideToAct != Live.sideToAct) return false;
+		if (Expected.teamAP[Expected.sideToAct] != Live.teamAP[Live.sideToAct]) return false;
+
+		const int32 N = FMath::Max((int32)Expected.units.size(), (int32)Live.units.size());
+		for (int32 i = 0; i < N; ++i)
+		{
+			const Unit* E = (i < (int32)Expected.units.size() && Expected.units[i].alive) ? &Expected.units[i] : nullptr;
+			const Unit* L = (i < (int32)Live.units.size() && Live.units[i].alive) ? &Live.units[i] : nullptr;
+			if (!E && !L) continue;
+			if (!E || !L) return false;
+			if (E->team != L->team || E->tile != L->tile || E->hp != L->hp || E->numSkills != L->numSkills) return false;
+			for (int32 s = 0; s < E->numSkills; ++s)
+			{
+				if (Expected.cooldownLeft(*E, s) != Live.cooldownLeft(*L, s)) return false;
+			}
+		}
+		return true;
+	}
+}
+
+AUTBGAITeamController::AUTBGAITeamController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickInterval = 0.1f;
+	bReplicates = false;
+}
+
+void AUTBGAITeamController::BeginPlay()
+{
+	Super::BeginPlay();
+	SetActorTickEnabled(HasAuthority());
+}
+
+void AUTBGAITeamController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ResetPlan();
+	if (HasAuthority()) AICore::FSearchScheduler::Get().ReleaseMatch(GetMatchId());
+	Super::EndPlay(EndPlayReason);
+}
+
+void AUTBGAITeamController::ResetPlan()
+{
+	++Generation;
+	if (Phase == EAIPhase::Searching && PendingSearch.IsValid()) AICore::FSearchScheduler::Get().Cancel(GetMatchId());
+	Phase = EAIPhase::Idle;
+	PendingSearch = TFuture<AICore::FScheduledSearchResult>();
+	SlicedSearch.Reset();
+	SetSearchTicking(false);
+	Plan.Reset();
+	PlanStep = 0;
+	FruitlessSearches = 0;
+	PlanTurnIndex = INDEX_NONE;
+}
+
+void AUTBGAITeamController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UWorld* World = GetWorld();
+	AUTBGGameState* GS = World ? World->GetGameState<AUTBGGameState>() : nullptr;
+	if (!GS || GS->IsGameOver() || !GS->IsTeamTurn(AITeam))
+	{
+		if (Phase != EAIPhase::Idle || PlanTurnIndex != INDEX_NONE) ResetPlan();
+		return;
+	}
+
+	if (PlanTurnIndex != GS->TurnIndex)
+	{
+		ResetPlan();
+		PlanTurnIndex = GS->TurnIndex;
+		NextActionTime = World->GetTimeSeconds() + TurnStartDelay;
+	}
+
+	if (Phase == EAIPhase::Done) return;
+	if (Phase == EAIPhase::Searching)
+	{
+		PollSearch();
+		return;
+	}
+
+	// skills resolve over several frames (cast -> impact -> end); animations get a fixed delay
+	if (GS->bResolving || World->GetTimeSeconds() < NextActionTime) return;
+
+	StepPlan(GS);
+}
+
+bool AUTBGAITeamController::BuildSnapshot(UAISnapshotSubsystem* Snap, const AUTBGGameState* GS, GameState& Out) const
+{
+	const int32 Side = UAISnapshotSubsystem::GetSnapshotSide(AITeam);
+	if (!Snap || Side < 0) return false;
+
+	FSnapshotBuildConfig Cfg;
+	Cfg.SideToAct = Side;
+	Cfg.TeamAPStart = GS->GetCurrentAP();
+	return Snap->BuildSnapshot(Cfg, Out);
+}
+
+void AUTBGAITeamController::StepPlan(AUTBGGameState* GS)
+{
+	UAISnapshotSubsystem* Snap = GetWorld()->GetSubsystem<UAISnapshotSubsystem>();
+	GameState Live;
+	if (!BuildSnapshot(Snap, GS, Live))
+	{
+		EndAITurn(GS, TEXT("no snapshot"));
+		return;
+	}
+
+	if (Phase == EAIPhase::Acting)
+	{
+		if (PlanStep >= Plan.Num())
+		{
+			// PV ran out before the turn did (depth limit): search the rest of the turn
+			UE_LOG(LogUTBGAI, Verbose, TEXT("[AI] PV exhausted at step %d, searching on"), PlanStep);
+			StartSearch(MoveTemp(Live));
+			return;
+		}
+		if (!MatchesExpected(Expected, Live))
+		{
+			UE_LOG(LogUTBGAI, Log, TEXT("[AI] board diverged from PV at step %d/%d, re-searching"), PlanStep, Plan.Num());
+			StartSearch(MoveTemp(Live));
+			return;
+		}
+
+		const Action A = Plan[PlanStep++];
+		float Delay = 0.f;
+		if (!ExecuteAction(A, GS, Snap, Snap->GetBoard(), Delay))
+		{
+			UE_LOG(LogUTBGAI, Warning, TEXT("[AI] %s rejected by the board, re-searching"), *ActionToString(A));
+			StartSearch(MoveTemp(Live));
+			return;
+		}
+
+		FruitlessSearches = 0;
+		UTBGRules R;
+		R.TurnAP = GS->MaxAPPerTurn;
+		UTBGDelta D;
+		R.make(Expected, A, D);
+		NextActionTime = GetWorld()->GetTimeSeconds() + Delay;
+		return;
+	}
+
+	StartSearch(MoveTemp(Live));
+}
+
+void AUTBGAITeamController::StartSearch(GameState&& Root)
+{
+	AUTBGGameState* GS = GetWorld()->GetGameState<AUTBGGameState>();
+	if (++FruitlessSearches > MaxFruitlessSearches)
+	{
+		EndAITurn(GS, TEXT("no playable PV"));
+		return;
+	}
+
+	AICore::AttachEvalBackend(Root);
+	Expected = Root;
+	Plan.Reset();
+	PlanStep = 0;
+
+	AICore::FUTBGSearchRequest Req;
+	Req.SoftMs = SoftMs;
+	Req.HardMs = FMath::Max(HardMs, SoftMs);
+	Req.MaxDepth = MaxDepth;
+	Req.MaxNodes = (MaxNodes >= 0) ? MaxNodes : AICore::GetDefaultNodeBudget();
+	Req.TurnAP = GS ? GS->MaxAPPerTurn : Req.TurnAP;
+	Req.Engine = AICore::GetDefaultSearchEngine();
+	Req.MultiPV = AICore::GetDefaultMultiPV();
+	Req.KingProofTurns = AICore::GetDefaultKingProofTurns();
+	Req.KingProofNodes = AICore::GetDefaultKingProofNodes();
+	Req.Difficulty = AICore::GetDefaultDifficulty();
+
+	Phase = EAIPhase::Searching;
+	SearchGeneration = Generation;
+
+	if (UseTimeSlicedSearch())
+	{
+		// game thread only, so the process-wide TT is safe; the other engines cannot be resumed
+		Req.Engine = AICore::ESearchEngine::AlphaBeta;
+		SlicedSearch.Start(Root, Req);
+		SlicedSearchSlices = 0;
+		SetSearchTicking(true);
+		return;
+	}
+
+	PendingSearch = AICore::FSearchScheduler::Get().Submit(GetMatchId(), MoveTemp(Root), Req);
+}
+
+bool AUTBGAITeamController::UseTimeSlicedSearch() const
+{
+	return bTimeSlicedOnListenServer && GetNetMode() == NM_ListenServer;
+}
+
+void AUTBGAITeamController::SetSearchTicking(bool bEveryFrame)
+{
+	// a slice per frame while searching; pacing checks are fine at the default interval
+	const float Interval = bEveryFrame ? 0.f : GetClass()->GetDefaultObject<AUTBGAITeamController>()->PrimaryActorTick.TickInterval;
+	if (GetActorTickInterval() != Interval) SetActorTickInterval(Interval);
+}
+
+AICore::FSearchMatchId AUTBGAITeamController::GetMatchId() const
+{
+	// one match per world: both AI teams of a world share its TT partition
+	const UWorld* World = GetWorld();
+	return World ? (AICore::FSearchMatchId)World->GetUniqueID() : 0;
+}
+
+void AUTBGAITeamController::PollSearch()
+{
+	if (!PendingSearch.IsValid())
+	{
+		// time-sliced search (Step() is done at once when Start() had nothing to search)
+		++SlicedSearchSlices;
+		if (!SlicedSearch.Step(SearchSliceUs)) return;
+		SetSearchTicking(false);
+		ApplySearchResult(SlicedSearch.GetResult(), 0.0, SlicedSearchSlices);
+		return;
+	}
+
+	if (!PendingSearch.IsReady()) return;
+
+	const AICore::FScheduledSearchResult Scheduled = PendingSearch.Get();
+	PendingSearch = TFuture<AICore::FScheduledSearchResult>();
+	if (SearchGeneration != Generation) return;
+	if (Scheduled.bCancelled)
+	{
+		// the match's queue was cancelled (other team's turn reset or shutdown): search again next step
+		Phase = EAIPhase::Idle;
+		--FruitlessSearches;
+		return;
+	}
+	ApplySearchResult(Scheduled.Result, Scheduled.QueueWaitMs, Scheduled.Slices);
+}
+
+void AUTBGAITeamController::ApplySearchResult(const AICore::FUTBGSearchResult& Res, double QueueWaitMs, int32 Slices)
+{
+	// easier difficulties play one of the Multi-PV lines within AICore.PickMargin of the best
+	const int32 Line = AICore::PickRootLine(Res, AICore::GetDefaultPickMargin(), Expected.key ^ (uint64)PlanTurnIndex);
+	const std::vector<Action>& PV = Res.Lines.empty() ? Res.PV : Res.Lines[Line].PV;
+	const int32 Score = Res.Lines.empty() ? Res.Score : Res.Lines[Line].Score;
+
+	Plan.Reset();
+	for (const Action& A : PV)
+	{
+		// the plan covers this turn only; the reply after EndTurn is the opponent's
+		Plan.Add(A);
+		if (A.type == ActionType::EndTurn) break;
+	}
+	PlanStep = 0;
+	Phase = EAIPhase::Acting;
+
+	FString PVText;
+	for (const Action& A : Plan) PVText += ActionToString(A) + TEXT(" ");
+	UE_LOG(LogUTBGAI, Log, TEXT("[AI] team=%d score=%d (line %d/%d, best %d) nodes=%lld %.1fms (queued %.1fms, %d slices)%s PV: %s"),
+		(int32)AITeam, Score, Line + 1, FMath::Max(1, (int32)Res.Lines.size()), Res.Score, (long long)Res.Nodes, Res.Ms, QueueWaitMs, Slices,
+		Res.bKingProof ? TEXT(" king kill proved") : TEXT(""), *PVText);
+}
+
+bool AUTBGAITeamController::ExecuteAction(const Action& A, AUTBGGameState* GS, UAISnapshotSubsystem* Snap, ABoard* Board, float& OutDelay)
+{
+	if (A.type == ActionType::EndTurn)
+	{
+		EndAITurn(GS, TEXT("PV"));
+		return true;
+	}
+	if (A.type == ActionType::Pass) return true;
+
+	APawnBase* Actor = Snap->GetSnapshotPawn(A.actorId);
+	if (!Board || !IsValid(Actor)) return false;
+
+	switch (A.type)
+	{
+	case ActionType::Move:
+	{
+		const FIntPoint To(A.tileIndex % Expected.width, A.tileIndex / Expected.width);
+		OutDelay = MoveDelay;
+		return Board->TryMoveUnit(Actor, To);
+	}
+	case ActionType::Attack:
+	{
+		APawnBase* Target = Snap->GetSnapshotPawn(A.targetId);
+		// the board validates (turn, AP) and applies the hit; animate only an accepted attack
+		if (!IsValid(Target) || !Board->TryAttackUnit(Actor, Target)) return false;
+		Actor->PlayAttackMontage();
+		const float MontageLen = (Actor->AttackMontage && Actor->AttackMontagePlayRate > 0.f)
+			? Actor->AttackMontage->GetPlayLength() / Actor->AttackMontagePlayRate : 0.f;
+		OutDelay = FMath::Max(AttackDelay, MontageLen);
+		return true;
+	}
+	case ActionType::Skill:
+	{
+		APawnBase* Target = Snap->GetSnapshotPawn(A.targetId);
+		if (!IsValid(Target) || A.actorId < 0 || A.actorId >= (int32)Expected.units.size()) return false;
+		const Unit& U = Expected.units[A.actorId];
+		if (A.skillId >= U.numSkills || !Actor->Skills) return false;
+		const int32 DataIndex = U.skills[A.skillId].dataIndex;
+		if (!Actor->Skills->Skills.IsValidIndex(DataIndex)) return false;
+
+		// StartSkill_NotifyDriven sets bResolving until cast end; Tick waits on it, then SkillDelay.
+		// A blocked cast (turn, resolving, AP) must not advance Expected past the board.
+		if (!Actor->StartSkill_NotifyDriven(Actor->Skills->Skills[DataIndex], Target)) return false;
+		OutDelay = SkillDelay;
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+void AUTBGAITeamController::EndAITurn(AUTBGGameState* GS, const TCHAR* Why)
+{
+	UE_LOG(LogUTBGAI, Log, TEXT("[AI] team=%d ends turn (%s)"), (int32)AITeam, Why);
+	const int32 Turn = PlanTurnIndex;
+	ResetPlan();
+	PlanTurnIndex = Turn;
+	Phase = EAIPhase::Done;
+	if (GS && GS->IsTeamTurn(AITeam)) GS->EndTurn();
+}
@@ -9,6 +9,7 @@
 #include "GameState/UTBGGameState.h"
 #include "GamePlay/Team/TeamUtils.h"
 #include "UTBGComponents/UnitSkillsComponent.h"
+#include "Subsystem/AISnapshotSubsystem.h"
 
 #include "Components/StaticMeshComponent.h"
 #include "Components/SkeletalMeshComponent.h"
@@ -150,6 +151,11 @@ void APawnBase::HandleHPChanged()
 	UpdateHealthWidget();
 	UE_LOG(LogTemp, Warning, TEXT("[OnRep_CurrentHP] %s: %d / %d"), *GetName(), CurrentHP, MaxHP);
 	OnHPChanged.Broadcast(this, CurrentHP);
+
+	if (const UWorld* World = GetWorld())
+	{
+		if (UAISnapshotSubsystem* Snapshot = World->GetSubsystem<UAISnapshotSubsystem>()) Snapshot->NotifyPawnHPChanged(this);
+	}
 }
 
 void APawnBase::HandleShieldChanged()
@@ -164,6 +170,19 @@ void APawnBase::OnRep_CurrentHP()
 	HandleHPChanged();
 }
 
+void APawnBase::NotifyStatsChanged()
+{
+	if (const UWorld* World = GetWorld())
+	{
+		if (UAISnapshotSubsystem* Snapshot = World->GetSubsystem<UAISnapshotSubsystem>()) Snapshot->MarkDirty();
+	}
+}
+
+void APawnBase::OnRep_IsKing()
+{
+	NotifyStatsChanged();
+}
+
 void APawnBase::OnRep_Shield()
 {
 	HandleShieldChanged();
@@ -208,14 +227,14 @@ void APawnBase::SetGridCoord(FIntPoint NewCoord)
 	ForceNetUpdate();
 }
 
-void APawnBase::StartSkill_NotifyDriven(USkillData* InData, AActor* InTarget)
+bool APawnBase::StartSkill_NotifyDriven(USkillData* InData, AActor* InTarget)
 {
-	if (!InData) return;
+	if (!InData) return false;
 
 	if (!HasAuthority())
 	{
 		Server_StartSkill_NotifyDriven(InData, InTarget);
-		return;
+		return true;
 	}
 
 	if (AUTBGGameState* GS = GetWorld() ? GetWorld()->GetGameState<AUTBGGameState>() : nullptr)
@@ -224,17 +243,17 @@ void APawnBase::StartSkill_NotifyDriven(USkillData* InData, AActor* InTarget)
 		if (!GS->IsTeamTurn(MyTeam))
 		{
 			UE_LOG(LogTemp, Verbose, TEXT("[Skill] BLOCK: Not your turn"));
-			return;
+			return false;
 		}
 		if (GS->bResolving)
 		{
 			UE_LOG(LogTemp, Verbose, TEXT("[Skill] BLOCK: Resolving in progress"));
-			return;
+			return false;
 		}
 		if (!GS->HasAPForActor(this, InData->APCost))
 		{
 			UE_LOG(LogTemp, Verbose, TEXT("[Skill] BLOCK: Not enough AP"));
-			return;
+			return false;
 		}
 		GS->SetResolving(true);
 	}
@@ -297,7 +316,7 @@ void APawnBase::StartSkill_NotifyDriven(USkillData* InData, AActor* InTarget)
 				}),
 			Dur + 0.1f, false);
 
-		return;
+		return true;
 	}
 
 	if (UUnitSkillsComponent* Comp = Skills)
@@ -331,6 +350,7 @@ void APawnBase::StartSkill_NotifyDriven(USkillData* InData, AActor* InTarget)
 				}),
 			Delay + 0.1f, false);
 	}
+	return true;
 }
 
 void APawnBase::Server_StartSkill_NotifyDriven_Implementation(USkillData* InData, AActor* InTarget)
@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystem/AISnapshotSubsystem.h"
+#include "Board/Board.h"
+#include "Pawn/PawnBase.h"
+#include "Data/SkillData.h"
+#include "UTBGComponents/UnitSkillsComponent.h"
+
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAISnapshot, Log, All);
+
+static TAutoConsoleVariable<int32> CVarUTBG_AISnapshotVerify(TEXT("UTBG.AISnapshotVerify"), 0, TEXT("Compare every mirrored AI snapshot against a full board rebuild and log mismatches"), ECVF_Default);
+
+namespace
+{
+	int32 GLiveSnapshotSubsystems = 0;
+
+	// same side mapping as the AICore reflection scan (Blue = 0, Red = 1)
+	int32 TeamIndex(ETeam Team)
+	{
+		switch (Team)
+		{
+		case ETeam::ET_BlueTeam: return 0;
+		case ETeam::ET_RedTeam:  return 1;
+		default:                 return -1;
+		}
+	}
+
+	// USkillData -> SkillSlot. Only unit-targeted damage skills are modeled.
+	bool ReadSkillSlot(const USkillData* Data, SkillSlot& Out)
+	{
+		if (!Data || Data->TargetMode != ESkillTargetMode::Unit) return false;
+
+		float Damage = 0.f;
+		for (const FSkillEffect& Effect : Data->Effects)
+		{
+			if (Effect.bDealsDamage) Damage += Effect.DamageBase;
+		}
+		if (Damage <= 0.f) return false;
+
+		Out.apCost   = (uint8)FMath::Clamp(Data->APCost, 0, 255);
+		Out.cooldown = (uint8)FMath::Clamp(Data->CooldownTurns, 0, 255);
+		Out.range    = (uint8)FMath::Clamp(Data->Range, 0, 255);
+		Out.metric   = (Data->RangeMetric == EGridDistanceMetric::Manhattan) ? RangeMetric::Manhattan : RangeMetric::Chebyshev;
+		Out.targets  = (Data->TeamFilter == ETeamFilter::Ally) ? SkillTargets::Ally
+		             : (Data->TeamFilter == ETeamFilter::Any) ? SkillTargets::Any : SkillTargets::Enemy;
+		Out.endsTurn = Data->bEndsTurn;
+		Out.damage   = (int16)FMath::Clamp(FMath::RoundToInt(Damage), 1, 32767);
+		return true;
+	}
+}
+
+void UAISnapshotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	if (GLiveSnapshotSubsystems++ == 0)
+	{
+		AICore::SetSnapshotProvider(&UAISnapshotSubsystem::ProvideSnapshot);
+	}
+}
+
+void UAISnapshotSubsystem::Deinitialize()
+{
+	if (--GLiveSnapshotSubsystems == 0)
+	{
+		AICore::SetSnapshotProvider(AICore::FSnapshotProvider());
+	}
+	Super::Deinitialize();
+}
+
+bool UAISnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UAISnapshotSubsystem::ProvideSnapshot(UWorld* World, const FSnapshotBuildConfig& Cfg, GameState& Out, FString* OutDebugInfo)
+{
+	UAISnapshotSubsystem* Subsystem = World ? World->GetSubsystem<UAISnapshotSubsystem>() : nullptr;
+	return Subsystem && Subsystem->BuildSnapshot(Cfg, Out, OutDebugInfo);
+}
+
+int32 UAISnapshotSubsystem::TileOf(const FIntPoint& Coord) const
+{
+	if (Coord.X < 0 || Coord.Y < 0 || Coord.X >= Mirror.width || Coord.Y >= Mirror.height) return -1;
+	return Coord.Y * Mirror.width + Coord.X;
+}
+
+void UAISnapshotSubsystem::WriteUnit(const APawnBase* Pawn, Unit& U) const
+{
+	U.team        = TeamIndex(Pawn->Team);
+	U.tile        = TileOf(Pawn->GetGridCoord());
+	U.hp          = Pawn->GetCurrentHP();
+	U.alive       = !Pawn->IsDead();
+	U.attack      = (Pawn->Damage > 0) ? Pawn->Damage : 5;
+	U.moveRange   = FMath::Clamp(Pawn->MoveRange, 0, 255);
+	U.attackRange = FMath::Clamp(Pawn->AttackRange, 0, 255);
+	U.attackCost  = FMath::Clamp(Pawn->AttackCost, 0, 255);
+	U.king        = Pawn->bIsKing;
+
+	U.numSkills = 0;
+	if (const UUnitSkillsComponent* SkillComp = Pawn->Skills)
+	{
+		for (int32 i = 0; i < SkillComp->Skills.Num() && U.numSkills < kMaxUnitSkills; ++i)
+		{
+			SkillSlot Slot;
+			if (!ReadSkillSlot(SkillComp->Skills[i], Slot)) continue;
+			Slot.dataIndex = (uint8)i;
+			U.skills[U.numSkills++] = Slot;
+		}
+	}
+}
+
+void UAISnapshotSubsystem::RebuildMirror()
+{
+	ABoard* B = Board.Get();
+	if (!B)
+	{
+		for (TActorIterator<ABoard> It(GetWorld()); It; ++It)
+		{
+			if (IsValid(*It)) { B = *It; break; }
+		}
+	}
+
+	Mirror = GameState{};
+	MirrorPawns.Reset();
+	Slots.Reset();
+	Board = B;
+	if (!B || !B->IsGridReady()) return;
+
+	Mirror.width = B->GetCols();
+	Mirror.height = B->GetRows();
+	for (const TObjectPtr<APawnBase>& Cell : B->GetPawnGrid())
+	{
+		APawnBase* Pawn = Cell.Get();
+		if (IsValid(Pawn) && !Pawn->IsDead() && TeamIndex(Pawn->Team) >= 0) AddPawn(Pawn);
+	}
+
+	bDirty = false;
+	++Rebuilds;
+}
+
+int32 UAISnapshotSubsystem::SlotOf(const APawnBase* Pawn) const
+{
+	const int32 Slot = Pawn ? Pawn->AISnapshotSlot : INDEX_NONE;
+	return (Slots.IsLive(Slot) && MirrorPawns[Slot].Get() == Pawn) ? Slot : INDEX_NONE;
+}
+
+void UAISnapshotSubsystem::AddPawn(APawnBase* Pawn)
+{
+	const int32 Slot = Slots.Acquire();
+	if ((int32)Mirror.units.size() < Slots.Num())
+	{
+		Mirror.units.resize(Slots.Num());
+		MirrorPawns.SetNum(Slots.Num());
+	}
+
+	Unit& U = Mirror.units[Slot];
+	U = Unit{};
+	U.id = Slot;
+	WriteUnit(Pawn, U);
+	MirrorPawns[Slot] = Pawn;
+	Pawn->AISnapshotSlot = Slot;
+}
+
+void UAISnapshotSubsystem::RemoveSlot(int32 Slot)
+{
+	if (APawnBase* Pawn = MirrorPawns[Slot].Get()) Pawn->AISnapshotSlot = INDEX_NONE;
+	MirrorPawns[Slot].Reset();
+	Slots.Release(Slot);
+
+	Unit& U = Mirror.units[Slot];
+	U = Unit{};
+	U.id = Slot; U.tile = -1; U.hp = 0; U.ap = 0; U.alive = false;
+
+	Mirror.units.resize(Slots.Num());
+	MirrorPawns.SetNum(Slots.Num());
+}
+
+void UAISnapshotSubsystem::NotifyPawnRegistered(ABoard* InBoard, APawnBase* Pawn)
+{
+	if (bDirty || !Pawn) return;                        // picked up by the next rebuild
+	if (Board.Get() != InBoard) { bDirty = true; return; }
+	if (Pawn->IsDead() || TeamIndex(Pawn->Team) < 0) return;
+
+	const int32 Slot = SlotOf(Pawn);
+	if (Slot != INDEX_NONE) WriteUnit(Pawn, Mirror.units[Slot]);
+	else AddPawn(Pawn);
+	++Updates;
+}
+
+void UAISnapshotSubsystem::NotifyPawnUnregistered(APawnBase* Pawn)
+{
+	if (bDirty) return;
+	const int32 Slot = SlotOf(Pawn);
+	if (Slot != INDEX_NONE)
+	{
+		RemoveSlot(Slot);
+		++Updates;
+	}
+}
+
+void UAISnapshotSubsystem::NotifyPawnMoved(APawnBase* Pawn, const FIntPoint& NewCoord)
+{
+	if (bDirty) return;
+	const int32 Slot = SlotOf(Pawn);
+	if (Slot != INDEX_NONE)
+	{
+		Mirror.units[Slot].tile = TileOf(NewCoord);
+		++Updates;
+	}
+}
+
+void UAISnapshotSubsystem::NotifyPawnHPChanged(APawnBase* Pawn)
+{
+	if (bDirty) return;
+	const int32 Slot = SlotOf(Pawn);
+	if (Slot == INDEX_NONE) return;
+
+	// a unit's id lives as long as the unit: death frees it for later arrivals
+	if (Pawn->IsDead()) RemoveSlot(Slot);
+	else Mirror.units[Slot].hp = Pawn->GetCurrentHP();
+	++Updates;
+}
+
+bool UAISnapshotSubsystem::BuildSnapshot(const FSnapshotBuildConfig& Cfg, GameState& Out, FString* OutDebugInfo)
+{
+	// dead pawns leave the board grid, so only the living-units snapshot can be mirrored
+	if (!Cfg.bOnlyLiving) return false;
+
+	if (bDirty || !Board.IsValid()) RebuildMirror();
+	if (bDirty) return false;
+
+	if (CVarUTBG_AISnapshotVerify.GetValueOnGameThread() != 0) VerifyMirror();
+
+	Out = GameState{};
+	Out.width = Mirror.width;
+	Out.height = Mirror.height;
+	Out.sideToAct = Cfg.SideToAct;
+	Out.units = Mirror.units;
+
+	for (int32 Slot = 0; Slot < (int32)Out.units.size(); ++Slot)
+	{
+		Unit& U = Out.units[Slot];
+		if (U.alive && U.tile < 0) U.alive = false;     // registered but not placed on the grid
+		if (!U.alive) continue;
+		U.ap = Cfg.FallbackUnitAP;
+
+		// cooldowns tick at the owner's turn start: c turns left = 2c side flips for the side to act, 2c-1 otherwise
+		const APawnBase* Pawn = MirrorPawns[Slot].Get();
+		const UUnitSkillsComponent* SkillComp = Pawn ? Pawn->Skills : nullptr;
+		for (int32 s = 0; s < U.numSkills; ++s)
+		{
+			const int32 DataIndex = U.skills[s].dataIndex;
+			const int32 CD = (SkillComp && SkillComp->Skills.IsValidIndex(DataIndex))
+				? SkillComp->GetCooldownRemaining(SkillComp->Skills[DataIndex]) : 0;
+			U.readyTurn[s] = (CD <= 0) ? 0 : (U.team == Cfg.SideToAct ? 2 * CD : 2 * CD - 1);
+		}
+	}
+
+	Out.teamAP[0] = 0;
+	Out.teamAP[1] = 0;
+	Out.teamAP[Cfg.SideToAct] = Cfg.TeamAPStart;
+	Out.maxAP = FMath::Max(Out.teamAP[0], Out.teamAP[1]);
+
+	AICore::InitSnapshotZobrist(Out, Cfg.ZobristSeed);
+
+	if (OutDebugInfo)
+	{
+		*OutDebugInfo = FString::Printf(TEXT("units=%d slots=%d WxH=%dx%d side=%d teamAP=[%d,%d] (board mirror, rebuilds=%d updates=%lld)"),
+			Slots.NumLiveSlots(), Slots.Num(), Out.width, Out.height, Cfg.SideToAct, Out.teamAP[0], Out.teamAP[1],
+			Rebuilds, (long long)Updates);
+	}
+	return true;
+}
+
+APawnBase* UAISnapshotSubsystem::GetSnapshotPawn(int32 UnitId) const
+{
+	return Slots.IsLive(UnitId) ? MirrorPawns[UnitId].Get() : nullptr;
+}
+
+int32 UAISnapshotSubsystem::GetSnapshotSide(ETeam Team)
+{
+	return TeamIndex(Team);
+}
+
+void UAISnapshotSubsystem::VerifyMirror() const
+{
+	const ABoard* B = Board.Get();
+	if (!B) return;
+
+	int32 Bad = 0, OnBoard = 0;
+	for (const TObjectPtr<APawnBase>& Cell : B->GetPawnGrid())
+	{
+		const APawnBase* Pawn = Cell.Get();
+		if (!IsValid(Pawn) || Pawn->IsDead() || TeamIndex(Pawn->Team) < 0) continue;
+		++OnBoard;
+
+		Unit R;
+		WriteUnit(Pawn, R);
+		const int32 Slot = SlotOf(Pawn);
+		const Unit* M = (Slot != INDEX_NONE) ? &Mirror.units[Slot] : nullptr;
+		if (!M || M->team != R.team || M->tile != R.tile || M->hp != R.hp || M->alive != R.alive
+			|| M->attack != R.attack || M->moveRange != R.moveRange || M->attackRange != R.attackRange
+			|| M->attackCost != R.attackCost || M->numSkills != R.numSkills)
+		{
+			++Bad;
+			UE_LOG(LogAISnapshot, Warning, TEXT("[AISnapshot] mirror mismatch: %s slot=%d"), *GetNameSafe(Pawn), Slot);
+		}
+	}
+	if (Bad > 0 || OnBoard != Slots.NumLiveSlots())
+	{
+		UE_LOG(LogAISnapshot, Warning, TEXT("[AISnapshot] verify: %d mismatched, board=%d mirrored=%d"), Bad, OnBoard, Slots.NumLiveSlots());
+	}
+}
@@ -13,6 +13,7 @@
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
+#include "geometry.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogUTBGSkills, Log, All);
 
@@ -49,6 +50,8 @@ void UUnitSkillsComponent::EnsureCooldownSize()
         {
             Cooldowns[i] = 0;
         }
+        // the skill list changed: AI snapshot skill slots are stale
+        if (APawnBase* Pawn = Cast<APawnBase>(GetOwner())) Pawn->NotifyStatsChanged();
     }
 }
 
@@ -147,16 +150,11 @@ void UUnitSkillsComponent::GetSkillsCopy(TArray<USkillData*>& OutSkills) const
 
 int32 UUnitSkillsComponent::ComputeTilesDistance2D(const FVector& A, const FVector& B, EGridDistanceMetric Metric, float TileSizeUU)
 {
+    // world positions, not board tiles: round each axis to whole tiles, then the metric the search uses
     const float dx = FMath::Abs(A.X - B.X) / FMath::Max(1.f, TileSizeUU);
     const float dy = FMath::Abs(A.Y - B.Y) / FMath::Max(1.f, TileSizeUU);
-    const int32 ix = FMath::RoundToInt(dx);
-    const int32 iy = FMath::RoundToInt(dy);
-    switch (Metric)
-    {
-    default:
-    case EGridDistanceMetric::Chebyshev: return FMath::Max(ix, iy);
-    case EGridDistanceMetric::Manhattan: return ix + iy;
-    }
+    const RangeMetric M = (Metric == EGridDistanceMetric::Manhattan) ? RangeMetric::Manhattan : RangeMetric::Chebyshev;
+    return GridDistance(M, FMath::RoundToInt(dx), FMath::RoundToInt(dy));
 }
 
 bool UUnitSkillsComponent::CanUseByRangeOnly(const USkillData* Data, const AActor* Target, FText& OutReason) const
@@ -142,4 +142,8 @@ public:
 	FORCEINLINE int32 ToIndex(const FIntPoint& Grid) const { return Grid.Y * Cols + Grid.X; }
 	UFUNCTION(BlueprintPure, Category = "Board|Grid")
 	FORCEINLINE ATileActor* GetTile(const FIntPoint& Grid) const { return IsValidCoord(Grid) ? TileGrid[ToIndex(Grid)] : nullptr; }
+
+	FORCEINLINE int32 GetRows() const { return Rows; }
+	FORCEINLINE int32 GetCols() const { return Cols; }
+	FORCEINLINE const TArray<TObjectPtr<APawnBase>>& GetPawnGrid() const { return PawnGrid; }
 };
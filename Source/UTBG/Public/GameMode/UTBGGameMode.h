@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameMode.h"
+#include "GamePlay/Team/Team.h"
 #include "UTBGGameMode.generated.h"
 
 class APawnBase;
+class AUTBGAITeamController;
 
 UCLASS()
 class UTBG_API AUTBGGameMode : public AGameMode
@@ -17,6 +19,13 @@ public:
 	virtual void PostLogin(APlayerController* NewPlayer) override;
 	virtual void Logout(AController* Exiting) override;
 
+	// Team played by a server-side AI (ET_NoTeam = none)
+	UPROPERTY(EditDefaultsOnly, Category = "AI")
+	ETeam AIOpponentTeam = ETeam::ET_NoTeam;
+
+	UPROPERTY(EditDefaultsOnly, Category = "AI")
+	TSubclassOf<AUTBGAITeamController> AIControllerClass;
+
 protected:
 	virtual void HandleMatchHasStarted() override;
 	virtual void BeginPlay() override;
@@ -48,4 +57,9 @@ private:
 	FTimerHandle EndCheckTimerHandle;
 	bool bEndCheckScheduled = false;
 	FDelegateHandle ActorSpawnedHandle;
+
+	void SpawnAIOpponent();
+
+	UPROPERTY()
+	TObjectPtr<AUTBGAITeamController> AIOpponent;
 };
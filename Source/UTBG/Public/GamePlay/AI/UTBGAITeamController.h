@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Async/Future.h"
+#include "GamePlay/Team/Team.h"
+#include "AICoreScheduler.h"
+#include "state.h"
+#include "UTBGAITeamController.generated.h"
+
+class ABoard;
+class APawnBase;
+class AUTBGGameState;
+class UAISnapshotSubsystem;
+
+/**
+ * Server-side AI player for one team.
+ * On its team's turn it snapshots the board (UAISnapshotSubsystem), queues the search on the
+ * process-wide AICore::FSearchScheduler (one match per world) and plays the PV through ABoard::TryMoveUnit / TryAttackUnit and
+ * APawnBase::StartSkill_NotifyDriven, one action at a time, waiting for skill resolution and a
+ * per-action delay in between. Before each action the live snapshot is compared with the state
+ * the PV predicts; the remaining PV is kept while they agree and re-searched when they do not.
+ * The game thread only polls the search future, it never waits on it. On a listen server the
+ * search can instead run on the game thread in SearchSliceUs slices per frame
+ * (AICore::FIncrementalSearchUTBG, alpha-beta), keeping the host's frame time bounded.
+ */
+UCLASS()
+class UTBG_API AUTBGAITeamController : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AUTBGAITeamController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	ETeam AITeam = ETeam::ET_BlueTeam;
+
+	// Search budget per (re-)search
+	UPROPERTY(EditAnywhere, Category = "AI|Search", meta = (ClampMin = 1))
+	int32 SoftMs = 300;
+
+	UPROPERTY(EditAnywhere, Category = "AI|Search", meta = (ClampMin = 1))
+	int32 HardMs = 350;
+
+	UPROPERTY(EditAnywhere, Category = "AI|Search", meta = (ClampMin = 1))
+	int32 MaxDepth = 5;
+
+	// Node budget instead of SoftMs/HardMs: the same moves on every machine and load (replays).
+	// -1 = AICore.NodeBudget / difficulty preset, 0 = wall clock
+	UPROPERTY(EditAnywhere, Category = "AI|Search", meta = (ClampMin = -1))
+	int64 MaxNodes = -1;
+
+	// Pacing (seconds after the action before the next one)
+	UPROPERTY(EditAnywhere, Category = "AI|Pacing", meta = (ClampMin = 0.0))
+	float MoveDelay = 0.6f;
+
+	UPROPERTY(EditAnywhere, Category = "AI|Pacing", meta = (ClampMin = 0.0))
+	float AttackDelay = 0.8f;       // at least the attack montage length
+
+	UPROPERTY(EditAnywhere, Category = "AI|Pacing", meta = (ClampMin = 0.0))
+	float SkillDelay = 0.4f;        // after bResolving clears
+
+	UPROPERTY(EditAnywhere, Category = "AI|Pacing", meta = (ClampMin = 0.0))
+	float TurnStartDelay = 0.5f;
+
+	// Re-searches in one turn that end without an executed action before the AI gives up and ends the turn
+	UPROPERTY(EditAnywhere, Category = "AI|Search", meta = (ClampMin = 1))
+	int32 MaxFruitlessSearches = 3;
+
+	// Listen server: search on the game thread, a slice per frame, instead of on the scheduler
+	UPROPERTY(EditAnywhere, Category = "AI|Search")
+	bool bTimeSlicedOnListenServer = true;
+
+	UPROPERTY(EditAnywhere, Category = "AI|Search", meta = (ClampMin = 100, EditCondition = "bTimeSlicedOnListenServer"))
+	int32 SearchSliceUs = 4000;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	enum class EAIPhase : uint8 { Idle, Searching, Acting, Done };   // Done: turn ended, waiting for the turn change
+
+	void ResetPlan();
+	bool BuildSnapshot(UAISnapshotSubsystem* Snap, const AUTBGGameState* GS, GameState& Out) const;
+	void StartSearch(GameState&& Root);
+	void PollSearch();
+	void ApplySearchResult(const AICore::FUTBGSearchResult& Res, double QueueWaitMs, int32 Slices);
+	bool UseTimeSlicedSearch() const;
+	void SetSearchTicking(bool bEveryFrame);
+	void StepPlan(AUTBGGameState* GS);
+	bool ExecuteAction(const Action& A, AUTBGGameState* GS, UAISnapshotSubsystem* Snap, ABoard* Board, float& OutDelay);
+	void EndAITurn(AUTBGGameState* GS, const TCHAR* Why);
+	AICore::FSearchMatchId GetMatchId() const;
+
+	EAIPhase Phase = EAIPhase::Idle;
+	int32 PlanTurnIndex = INDEX_NONE;
+	uint32 Generation = 0;                      // bumped on reset; stale search results are dropped
+	uint32 SearchGeneration = 0;
+	TFuture<AICore::FScheduledSearchResult> PendingSearch;
+	AICore::FIncrementalSearchUTBG SlicedSearch;   // time-sliced mode
+	int32 SlicedSearchSlices = 0;
+
+	GameState Expected;                         // search root advanced by the executed PV actions
+	TArray<Action> Plan;
+	int32 PlanStep = 0;
+	int32 FruitlessSearches = 0;
+	double NextActionTime = 0.0;
+};
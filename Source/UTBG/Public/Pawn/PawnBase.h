@@ -65,8 +65,10 @@ public:
 	UFUNCTION(NetMulticast, Reliable)
 	void MulticastPlaySkillMontage(UAnimMontage* Montage, FName Section = NAME_None);
 
+	// True once the cast has started (on a client: once it is sent to the server);
+	// false when it is blocked (not this team's turn, a cast resolving, not enough AP)
 	UFUNCTION(BlueprintCallable, Category = "Skills")
-	void StartSkill_NotifyDriven(class USkillData* InData, AActor* InTarget);
+	bool StartSkill_NotifyDriven(class USkillData* InData, AActor* InTarget);
 
 	UFUNCTION(Server, Reliable)
 	void Server_StartSkill_NotifyDriven(class USkillData* InData, AActor* InTarget);
@@ -96,6 +98,7 @@ public:
 	UFUNCTION() void OnRep_GridCoord(FIntPoint PrevCoord);
 	UFUNCTION() void OnRep_Shield();
 	UFUNCTION() void OnRep_Board();
+	UFUNCTION() void OnRep_IsKing();
 
 	void HandleHPChanged();
 	void HandleShieldChanged();
@@ -122,6 +125,9 @@ public:
 	UPROPERTY(Replicated, EditInstanceOnly, BlueprintReadWrite, Category = "Board")
 	ABoard* Board = nullptr;
 
+	// AICore unit id while mirrored by UAISnapshotSubsystem (INDEX_NONE otherwise)
+	int32 AISnapshotSlot = INDEX_NONE;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid")
 	class ATileActor* CurrentTile = nullptr;
 
@@ -138,7 +144,8 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unit")
 	int32 Damage = 3;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unit")
+	// AP per attack, at least 1 (AICore's UTBGRules charges the same)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unit", meta = (ClampMin = 1))
 	int32 AttackCost = 1;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unit")
@@ -156,6 +163,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	class UUnitSkillsComponent* Skills;
 
+	// Call after changing Team/Damage/ranges/AttackCost/bIsKing/Skills at runtime: the AI snapshot mirror rebuilds
+	UFUNCTION(BlueprintCallable, Category = "Unit")
+	void NotifyStatsChanged();
+
 	UPROPERTY(BlueprintAssignable, Category = "Events|Attributes")
 	FOnHPChanged OnHPChanged;
 
@@ -184,7 +195,7 @@ public:
 	UPROPERTY()
 	class AUTBGPlayerState* UTBGPlayerState;
 
-	UPROPERTY(EditAnywhere, Replicated, BlueprintReadOnly, Category = "Unit")
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_IsKing, BlueprintReadOnly, Category = "Unit")
 	bool bIsKing = false;
 
 	// Death VFX / anim
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AICoreSnapshot.h"
+#include "AICoreUnitSlots.h"
+#include "state.h"
+#include "GamePlay/Team/Team.h"
+#include "AISnapshotSubsystem.generated.h"
+
+class ABoard;
+class APawnBase;
+
+/**
+ * Typed AICore snapshot source.
+ * Keeps a mirror of the board's units (tile/HP/alive/stats/skill slots) that ABoard and
+ * APawnBase update on register/move/HP events, so a snapshot is a copy of the mirror plus
+ * the per-call fields (side, team AP, cooldowns) instead of a reflection scan.
+ * Unit ids are match-stable slots (FUnitSlotAllocator): a pawn keeps its id until it dies
+ * or leaves the board, and freed ids are reused so units[] stays dense.
+ * Registered as AICore's snapshot provider while a game world is alive.
+ */
+UCLASS()
+class UTBG_API UAISnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// ----- Board / Pawn events -----
+	void NotifyPawnRegistered(ABoard* InBoard, APawnBase* Pawn);
+	void NotifyPawnUnregistered(APawnBase* Pawn);
+	void NotifyPawnMoved(APawnBase* Pawn, const FIntPoint& NewCoord);
+	void NotifyPawnHPChanged(APawnBase* Pawn);
+
+	// Stats/skills changed outside the events above (APawnBase::NotifyStatsChanged): rebuild on the next snapshot
+	void MarkDirty() { bDirty = true; }
+
+	// Living units of the board as seen by AICore. False when there is no board to mirror.
+	bool BuildSnapshot(const FSnapshotBuildConfig& Cfg, GameState& Out, FString* OutDebugInfo = nullptr);
+
+	// Unit id -> pawn (for executing a searched action)
+	APawnBase* GetSnapshotPawn(int32 UnitId) const;
+
+	ABoard* GetBoard() const { return Board.Get(); }
+
+	// AICore side index of a team (Blue = 0, Red = 1, -1 for no team)
+	static int32 GetSnapshotSide(ETeam Team);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	static bool ProvideSnapshot(UWorld* World, const FSnapshotBuildConfig& Cfg, GameState& Out, FString* OutDebugInfo);
+
+	void RebuildMirror();
+	void AddPawn(APawnBase* Pawn);
+	void RemoveSlot(int32 Slot);
+	int32 SlotOf(const APawnBase* Pawn) const;
+	void WriteUnit(const APawnBase* Pawn, Unit& U) const;
+	int32 TileOf(const FIntPoint& Coord) const;
+	void VerifyMirror() const;
+
+	TWeakObjectPtr<ABoard> Board;
+	GameState Mirror;                                   // units only; id == slot, free slots are dead placeholders
+	FUnitSlotAllocator Slots;
+	TArray<TWeakObjectPtr<APawnBase>> MirrorPawns;      // slot -> pawn (APawnBase::AISnapshotSlot is the reverse)
+	bool bDirty = true;
+
+	int32 Rebuilds = 0;
+	int64 Updates = 0;
+};